@@ -40,7 +40,7 @@ using namespace Wt;
 const char* AssigViewCtrl::s_mimeAssignments = "application/worktree/assignments";
 
 AssigViewCtrl::AssigViewCtrl(QWidget *parent) :
-    QObject(parent)
+    QObject(parent),d_deferred(false)
 {
 }
 
@@ -92,7 +92,7 @@ AssigViewCtrl *AssigViewCtrl::create(QWidget *parent, Udb::Transaction *txn)
              ctrl, SLOT(onLinkTo(QList<Udb::Obj>,QModelIndex,int)) );
     connect( title, SIGNAL(signalClicked()), ctrl, SLOT(onTitleClick()) );
 
-    txn->getDb()->addObserver( ctrl, SLOT( onDbUpdate( Udb::UpdateInfo ) ) );
+    UpdateDispatcher::inst( txn )->subscribe( ctrl, SLOT( onDbUpdates( Wt::UpdateBatch ) ), ObjChange::Erased );
 
     return ctrl;
 }
@@ -214,6 +214,7 @@ QList<Udb::Obj> AssigViewCtrl::readItems(const QMimeData *data)
 
 void AssigViewCtrl::showAssig(const Udb::Obj & o)
 {
+    populate();
     QModelIndex i = d_mdl->getIndex( o );
     if( i.isValid() )
     {
@@ -370,12 +371,26 @@ void AssigViewCtrl::setObj(const Udb::Obj & o)
         return;
     if( !WtTypeDefs::isRasciAssignable( o.getType() ) )
         return;
+    if( d_deferred )
+    {
+        d_pending = o;
+        return;
+    }
 
     d_title->setObj( o );
     d_mdl->setObject( o );
     d_tree->resizeColumnToContents(0);
 }
 
+void AssigViewCtrl::populate()
+{
+    if( !d_deferred )
+        return;
+    d_deferred = false;
+    setObj( d_pending );
+    d_pending = Udb::Obj();
+}
+
 void AssigViewCtrl::onDblClick(const QModelIndex & i)
 {
     Udb::Obj o = d_mdl->getObject( i, true );
@@ -398,18 +413,17 @@ void AssigViewCtrl::onSelectionChanged()
     }
 }
 
-void AssigViewCtrl::onDbUpdate(Udb::UpdateInfo info)
+void AssigViewCtrl::onDbUpdates(const Wt::UpdateBatch & batch)
 {
-    switch( info.d_kind )
-	{
-    case Udb::UpdateInfo::ObjectErased:
-        if( info.d_id == d_title->getObj().getOid() )
+    foreach( const ObjChange& c, batch )
+    {
+        if( c.d_id == d_title->getObj().getOid() )
         {
             d_pin->setChecked( false );
             d_title->setObj( Udb::Obj() );
             d_mdl->setObject( Udb::Obj() );
+            break;
         }
-        break;
     }
 }
 
@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <Udb/Obj.h>
+#include "UpdateDispatcher.h"
 #include <Gui2/AutoMenu.h>
 
 class QTreeView;
@@ -44,6 +45,8 @@ namespace Wt
         QWidget* getWidget() const;
 
         void setObj( const Udb::Obj& root );
+        // deferred: setObj merkt sich das Objekt nur, populate() zeigt es an
+        void setDeferred( bool on ) { d_deferred = on; }
         static AssigViewCtrl* create(QWidget* parent, Udb::Transaction *txn );
         void addCommands( Gui2::AutoMenu* );
         static void writeItems(QMimeData *data, const QList<Udb::Obj>& );
@@ -52,6 +55,7 @@ namespace Wt
     signals:
         void signalSelect( const Udb::Obj&, bool open );
     public slots:
+        void populate();
         void onAddRasciAssig();
         void onSetRasciAssig();
         void onDelete();
@@ -64,13 +68,15 @@ namespace Wt
         void onSelectionChanged();
         void onTitleClick();
         void onLinkTo( const QList<Udb::Obj> &what, const QModelIndex & toParent, int beforeRow );
-        void onDbUpdate(Udb::UpdateInfo info);
+        void onDbUpdates( const Wt::UpdateBatch& );
     private:
         int selectRasciRole( int = 0 );
         AssigViewMdl* d_mdl;
         ObjectTitleFrame* d_title;
         QTreeView* d_tree;
         CheckLabel* d_pin;
+        Udb::Obj d_pending;
+        bool d_deferred;
     };
 }
 
@@ -68,7 +68,7 @@ void AssigViewMdl::refill()
 			s->d_assig = assig;
 			s->d_principal = subject;
 			d_slots.insert( to, s );
-		}// TODO: else sollte assig gleich geoelscht werden!
+		}// else: wird vom GarbageCollector entfernt
 	}while( idx.nextKey() );
 	reset();
 	// TODO getTree()->resizeColumnToContents(0);
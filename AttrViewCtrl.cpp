@@ -92,7 +92,7 @@ Wt::AttrViewCtrl *Wt::AttrViewCtrl::create(QWidget *parent, Udb::Transaction *tx
     ctrl->d_title->adjustFont();
 	pane->updateGeometry();
 
-    txn->getDb()->addObserver( ctrl, SLOT( onDbUpdate( Udb::UpdateInfo ) ) );
+    UpdateDispatcher::inst( txn )->subscribe( ctrl, SLOT( onDbUpdates( Wt::UpdateBatch ) ), ObjChange::Erased );
 
     return ctrl;
 }
@@ -120,14 +120,15 @@ void AttrViewCtrl::onAnchorActivated(QByteArray data, bool url)
     }
 }
 
-void AttrViewCtrl::onDbUpdate(Udb::UpdateInfo info)
+void AttrViewCtrl::onDbUpdates(const Wt::UpdateBatch & batch)
 {
-    switch( info.d_kind )
-	{
-    case Udb::UpdateInfo::ObjectErased:
-        if( info.d_id == d_title->getObj().getOid() )
+    foreach( const ObjChange& c, batch )
+    {
+        if( c.d_id == d_title->getObj().getOid() )
+        {
             setObj( Udb::Obj() );
-        break;
+            break;
+        }
     }
 }
 
@@ -23,7 +23,7 @@
 #include <QObject>
 #include <Udb/Obj.h>
 #include <Oln2/OutlineMdl.h>
-#include <Udb/UpdateInfo.h>
+#include "UpdateDispatcher.h"
 namespace Oln
 {
     class OutlineTree;
@@ -45,7 +45,7 @@ namespace Wt
         void signalFollowObject( const Udb::Obj& );
     protected slots:
         void onAnchorActivated(QByteArray data,bool url);
-        void onDbUpdate( Udb::UpdateInfo info );
+        void onDbUpdates( const Wt::UpdateBatch& );
     private:
         ObjectTitleFrame* d_title;
         ObjectDetailPropsMdl* d_props;
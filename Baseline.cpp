@@ -0,0 +1,446 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "Baseline.h"
+#include "WtTypeDefs.h"
+#include "WorkTreeApp.h"
+#include <Udb/Transaction.h>
+#include <QtAlgorithms>
+#include <QtDebug>
+#include <string.h>
+using namespace Wt;
+
+// Format: version:uint8 flags:uint8 count:varint payload
+// payload (falls FlagCompressed mit qCompress): Spalten nacheinander, je count Einträge
+//   oids: varint Delta zur Vorgänger-OID
+//   es, ef, ls, lf: 0 für null, sonst zigzag( jd - vorheriges jd derselben Spalte ) + 1
+//   dur, pv, ev, ac: varint
+//   flags: byte
+static const quint8 s_version = 1;
+enum { FlagCompressed = 0x01 };
+
+static inline void _writeVarint( QByteArray& out, quint64 v )
+{
+	while( v >= 0x80 )
+	{
+		out.append( char( ( v & 0x7f ) | 0x80 ) );
+		v >>= 7;
+	}
+	out.append( char( v ) );
+}
+
+static inline bool _readVarint( const char*& p, const char* end, quint64& v )
+{
+	v = 0;
+	int shift = 0;
+	while( p < end && shift < 64 )
+	{
+		const quint8 b = quint8( *p++ );
+		v |= quint64( b & 0x7f ) << shift;
+		if( ( b & 0x80 ) == 0 )
+			return true;
+		shift += 7;
+	}
+	return false;
+}
+
+static inline quint64 _zigzag( qint64 v ) { return ( quint64( v ) << 1 ) ^ quint64( v >> 63 ); }
+static inline qint64 _unzigzag( quint64 v ) { return qint64( v >> 1 ) ^ -qint64( v & 1 ); }
+
+static void _writeDates( QByteArray& out, const QVector<qint32>& col )
+{
+	qint32 prev = 0;
+	for( int i = 0; i < col.size(); i++ )
+	{
+		if( col[i] == 0 )
+			out.append( char(0) );
+		else
+		{
+			_writeVarint( out, _zigzag( col[i] - prev ) + 1 );
+			prev = col[i];
+		}
+	}
+}
+
+static bool _readDates( const char*& p, const char* end, QVector<qint32>& col, int count )
+{
+	col.resize( count );
+	qint32 prev = 0;
+	quint64 v;
+	for( int i = 0; i < count; i++ )
+	{
+		if( !_readVarint( p, end, v ) )
+			return false;
+		if( v == 0 )
+			col[i] = 0;
+		else
+		{
+			prev += qint32( _unzigzag( v - 1 ) );
+			col[i] = prev;
+		}
+	}
+	return true;
+}
+
+template<class T>
+static void _writeInts( QByteArray& out, const QVector<T>& col )
+{
+	for( int i = 0; i < col.size(); i++ )
+		_writeVarint( out, col[i] );
+}
+
+template<class T>
+static bool _readInts( const char*& p, const char* end, QVector<T>& col, int count )
+{
+	col.resize( count );
+	quint64 v;
+	for( int i = 0; i < count; i++ )
+	{
+		if( !_readVarint( p, end, v ) )
+			return false;
+		col[i] = T( v );
+	}
+	return true;
+}
+
+static inline qint32 _toJd( const Stream::DataCell& v )
+{
+	const QDate d = v.getDate();
+	return ( d.isValid() ) ? d.toJulianDay() : 0;
+}
+
+void SchedSnapshot::clear()
+{
+	d_oids.clear();
+	d_es.clear();
+	d_ef.clear();
+	d_ls.clear();
+	d_lf.clear();
+	d_dur.clear();
+	d_pv.clear();
+	d_ev.clear();
+	d_ac.clear();
+	d_flags.clear();
+}
+
+void SchedSnapshot::reserve(int n)
+{
+	d_oids.reserve( n );
+	d_es.reserve( n );
+	d_ef.reserve( n );
+	d_ls.reserve( n );
+	d_lf.reserve( n );
+	d_dur.reserve( n );
+	d_pv.reserve( n );
+	d_ev.reserve( n );
+	d_ac.reserve( n );
+	d_flags.reserve( n );
+}
+
+int SchedSnapshot::find(Udb::OID oid) const
+{
+	QVector<Udb::OID>::const_iterator i = qBinaryFind( d_oids.begin(), d_oids.end(), oid );
+	if( i == d_oids.end() )
+		return -1;
+	else
+		return i - d_oids.begin();
+}
+
+static void _collect( const Udb::Obj& parent, QList<Udb::Obj>& res )
+{
+	Udb::Obj sub = parent.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		const quint32 type = sub.getType();
+		if( WtTypeDefs::isSchedObj( type ) )
+			res.append( sub );
+		if( WtTypeDefs::isImpType( type ) )
+			_collect( sub, res );
+	}while( sub.next() );
+}
+
+static bool _lessOid( const Udb::Obj& lhs, const Udb::Obj& rhs )
+{
+	return lhs.getOid() < rhs.getOid();
+}
+
+SchedSnapshot SchedSnapshot::fetch(Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	QList<Udb::Obj> objs;
+	Udb::Obj imp = txn->getObject( QUuid( WorkTreeApp::s_imp ) );
+	if( !imp.isNull() )
+		_collect( imp, objs );
+	qSort( objs.begin(), objs.end(), _lessOid );
+
+	SchedSnapshot res;
+	res.reserve( objs.size() );
+	foreach( const Udb::Obj& o, objs )
+	{
+		res.d_oids.append( o.getOid() );
+		res.d_es.append( _toJd( o.getValue( AttrEarlyStart ) ) );
+		res.d_ef.append( _toJd( o.getValue( AttrEarlyFinish ) ) );
+		res.d_ls.append( _toJd( o.getValue( AttrLateStart ) ) );
+		res.d_lf.append( _toJd( o.getValue( AttrLateFinish ) ) );
+		res.d_dur.append( o.getValue( AttrDuration ).getUInt16() );
+		res.d_pv.append( o.getValue( AttrPlannedValue ).getUInt32() );
+		res.d_ev.append( o.getValue( AttrEarnedValue ).getUInt32() );
+		res.d_ac.append( o.getValue( AttrActualCost ).getUInt32() );
+		quint8 f = 0;
+		if( o.getValue( AttrCriticalPath ).getBool() )
+			f |= FlagCritical;
+		if( o.getType() == TypeMilestone )
+			f |= FlagMilestone;
+		res.d_flags.append( f );
+	}
+	return res;
+}
+
+QByteArray SchedSnapshot::encode(bool compress) const
+{
+	QByteArray payload;
+	payload.reserve( size() * 16 );
+	Udb::OID prev = 0;
+	for( int i = 0; i < d_oids.size(); i++ )
+	{
+		_writeVarint( payload, d_oids[i] - prev );
+		prev = d_oids[i];
+	}
+	_writeDates( payload, d_es );
+	_writeDates( payload, d_ef );
+	_writeDates( payload, d_ls );
+	_writeDates( payload, d_lf );
+	_writeInts( payload, d_dur );
+	_writeInts( payload, d_pv );
+	_writeInts( payload, d_ev );
+	_writeInts( payload, d_ac );
+	payload.append( reinterpret_cast<const char*>( d_flags.constData() ), d_flags.size() );
+
+	QByteArray res;
+	res.append( char( s_version ) );
+	res.append( char( ( compress ) ? FlagCompressed : 0 ) );
+	_writeVarint( res, size() );
+	if( compress )
+		res.append( qCompress( payload ) );
+	else
+		res.append( payload );
+	return res;
+}
+
+bool SchedSnapshot::decode(const QByteArray & data)
+{
+	clear();
+	if( data.size() < 3 || quint8( data[0] ) != s_version )
+		return false;
+	const quint8 flags = quint8( data[1] );
+	const char* p = data.constData() + 2;
+	const char* end = data.constData() + data.size();
+	quint64 count;
+	if( !_readVarint( p, end, count ) )
+		return false;
+	QByteArray payload;
+	if( flags & FlagCompressed )
+		payload = qUncompress( reinterpret_cast<const uchar*>( p ), end - p );
+	else
+		payload = QByteArray::fromRawData( p, end - p );
+	p = payload.constData();
+	end = payload.constData() + payload.size();
+
+	// Jede Spalte belegt mindestens ein Byte pro Eintrag (9 Varint-Spalten und die Flags);
+	// ein verfälschter Count darf nicht zu einer riesigen Allokation führen
+	if( count > quint64( payload.size() ) / 10 )
+		return false;
+	const int n = int( count );
+	d_oids.resize( n );
+	Udb::OID prev = 0;
+	quint64 v;
+	for( int i = 0; i < n; i++ )
+	{
+		if( !_readVarint( p, end, v ) )
+			return false;
+		prev += v;
+		d_oids[i] = prev;
+	}
+	if( !_readDates( p, end, d_es, n ) || !_readDates( p, end, d_ef, n ) ||
+			!_readDates( p, end, d_ls, n ) || !_readDates( p, end, d_lf, n ) )
+		return false;
+	if( !_readInts( p, end, d_dur, n ) || !_readInts( p, end, d_pv, n ) ||
+			!_readInts( p, end, d_ev, n ) || !_readInts( p, end, d_ac, n ) )
+		return false;
+	if( end - p < n )
+		return false;
+	d_flags.resize( n );
+	::memcpy( d_flags.data(), p, n );
+	return true;
+}
+
+// Die folgenden Schleifen arbeiten auf zusammenhängenden Arrays ohne Verzweigung im Körper,
+// damit der Compiler sie vektorisieren kann.
+static void _diffDates( const qint32* a, const qint32* b, qint32* out, int n )
+{
+	for( int i = 0; i < n; i++ )
+		out[i] = ( a[i] != 0 && b[i] != 0 ) ? a[i] - b[i] : 0;
+}
+
+template<class S, class D>
+static void _diff( const S* a, const S* b, D* out, int n )
+{
+	for( int i = 0; i < n; i++ )
+		out[i] = D( a[i] ) - D( b[i] );
+}
+
+template<class T>
+static void _gather( const QVector<T>& src, const QVector<int>& idx, QVector<T>& out )
+{
+	out.resize( idx.size() );
+	T* o = out.data();
+	const T* s = src.constData();
+	for( int i = 0; i < idx.size(); i++ )
+		o[i] = ( idx[i] < 0 ) ? T(0) : s[ idx[i] ];
+}
+
+ScheduleVariance ScheduleVariance::compute(const SchedSnapshot &cur, const SchedSnapshot &base)
+{
+	// Merge-Join über die sortierten OIDs
+	QVector<int> ci, bi;
+	ci.reserve( qMax( cur.size(), base.size() ) );
+	bi.reserve( qMax( cur.size(), base.size() ) );
+	ScheduleVariance res;
+	res.d_oids.reserve( ci.capacity() );
+	int i = 0, j = 0;
+	while( i < cur.size() || j < base.size() )
+	{
+		if( j >= base.size() || ( i < cur.size() && cur.d_oids[i] < base.d_oids[j] ) )
+		{
+			res.d_oids.append( cur.d_oids[i] );
+			ci.append( i++ );
+			bi.append( -1 );
+		}else if( i >= cur.size() || base.d_oids[j] < cur.d_oids[i] )
+		{
+			res.d_oids.append( base.d_oids[j] );
+			ci.append( -1 );
+			bi.append( j++ );
+		}else
+		{
+			res.d_oids.append( cur.d_oids[i] );
+			ci.append( i++ );
+			bi.append( j++ );
+		}
+	}
+	const int n = res.d_oids.size();
+	res.d_startVar.resize( n );
+	res.d_finishVar.resize( n );
+	res.d_durVar.resize( n );
+	res.d_pvVar.resize( n );
+	res.d_evVar.resize( n );
+	res.d_acVar.resize( n );
+	res.d_state.resize( n );
+
+	QVector<qint32> a, b;
+	_gather( cur.d_es, ci, a );
+	_gather( base.d_es, bi, b );
+	_diffDates( a.constData(), b.constData(), res.d_startVar.data(), n );
+	_gather( cur.d_ef, ci, a );
+	_gather( base.d_ef, bi, b );
+	_diffDates( a.constData(), b.constData(), res.d_finishVar.data(), n );
+
+	QVector<quint16> ad, bd;
+	_gather( cur.d_dur, ci, ad );
+	_gather( base.d_dur, bi, bd );
+	_diff( ad.constData(), bd.constData(), res.d_durVar.data(), n );
+
+	QVector<quint32> au, bu;
+	_gather( cur.d_pv, ci, au );
+	_gather( base.d_pv, bi, bu );
+	_diff( au.constData(), bu.constData(), res.d_pvVar.data(), n );
+	_gather( cur.d_ev, ci, au );
+	_gather( base.d_ev, bi, bu );
+	_diff( au.constData(), bu.constData(), res.d_evVar.data(), n );
+	_gather( cur.d_ac, ci, au );
+	_gather( base.d_ac, bi, bu );
+	_diff( au.constData(), bu.constData(), res.d_acVar.data(), n );
+
+	QVector<quint8> af, bf;
+	_gather( cur.d_flags, ci, af );
+	_gather( base.d_flags, bi, bf );
+	for( int k = 0; k < n; k++ )
+	{
+		if( bi[k] < 0 )
+			res.d_state[k] = Added;
+		else if( ci[k] < 0 )
+			res.d_state[k] = Removed;
+		else if( res.d_startVar[k] != 0 || res.d_finishVar[k] != 0 || res.d_durVar[k] != 0 ||
+				 res.d_pvVar[k] != 0 || res.d_evVar[k] != 0 || res.d_acVar[k] != 0 || af[k] != bf[k] )
+			res.d_state[k] = Changed;
+		else
+			res.d_state[k] = Unchanged;
+	}
+	return res;
+}
+
+Udb::Obj Baseline::create(Udb::Transaction * txn, const QString &name, bool compress)
+{
+	Q_ASSERT( txn != 0 );
+	const SchedSnapshot snap = SchedSnapshot::fetch( txn );
+	Udb::Obj bl = WtTypeDefs::getBaselines( txn ).createAggregate( TypeBaseline );
+	bl.setTimeStamp( AttrCreatedOn );
+	bl.setString( AttrText, name );
+	bl.setValue( AttrBaselineData, Stream::DataCell().setLob( snap.encode( compress ) ) );
+	bl.setValue( AttrBaselineCount, Stream::DataCell().setUInt32( snap.size() ) );
+	const QDate dataDate = WtTypeDefs::getProject( txn ).getValue( AttrDataDate ).getDate();
+	if( dataDate.isValid() )
+		bl.setValue( AttrBaselineDate, Stream::DataCell().setDate( dataDate ) );
+	return bl;
+}
+
+SchedSnapshot Baseline::read(const Udb::Obj &baseline)
+{
+	SchedSnapshot res;
+	if( baseline.isNull() || baseline.getType() != TypeBaseline )
+		return res;
+	if( !res.decode( baseline.getValue( AttrBaselineData ).getArr() ) )
+	{
+		qWarning() << "Baseline::read: invalid baseline data in" << baseline.getOid();
+		res.clear();
+	}
+	return res;
+}
+
+ScheduleVariance Baseline::variance(const Udb::Obj &baseline)
+{
+	Q_ASSERT( !baseline.isNull() );
+	return ScheduleVariance::compute( SchedSnapshot::fetch( baseline.getTxn() ), read( baseline ) );
+}
+
+QList<Udb::Obj> Baseline::findAll(Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	QList<Udb::Obj> res;
+	// Nur lesen; der Container entsteht erst mit der ersten Baseline
+	Udb::Obj bls = txn->getObject( WorkTreeApp::s_baselines );
+	if( bls.isNull() )
+		return res;
+	Udb::Obj sub = bls.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		if( sub.getType() == TypeBaseline )
+			res.append( sub );
+	}while( sub.next() );
+	return res;
+}
@@ -0,0 +1,77 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <Udb/Obj.h>
+#include <QVector>
+
+namespace Wt
+{
+	// Spaltenorientierte Momentaufnahme der Terminattribute aller Tasks und Meilensteine.
+	// Alle Spalten haben dieselbe Länge; Zeile i gehört zu d_oids[i], d_oids ist aufsteigend sortiert.
+	struct SchedSnapshot
+	{
+		enum Flag { FlagCritical = 0x01, FlagMilestone = 0x02 };
+
+		QVector<Udb::OID> d_oids;
+		QVector<qint32> d_es, d_ef, d_ls, d_lf; // Julian Day, 0 falls nicht gesetzt
+		QVector<quint16> d_dur; // Workdays
+		QVector<quint32> d_pv, d_ev, d_ac;
+		QVector<quint8> d_flags;
+
+		int size() const { return d_oids.size(); }
+		void clear();
+		void reserve( int );
+		int find( Udb::OID ) const; // binäre Suche, -1 falls nicht vorhanden
+
+		// Liest alle SchedObj unterhalb des IMP
+		static SchedSnapshot fetch( Udb::Transaction* );
+
+		// Delta/Varint-kodiert, optional zusätzlich mit qCompress
+		QByteArray encode( bool compress = true ) const;
+		bool decode( const QByteArray& );
+	};
+
+	// Spaltenorientiertes Resultat eines Vergleichs zweier Snapshots; Abweichung = current - base
+	struct ScheduleVariance
+	{
+		enum State { Unchanged, Changed, Added, Removed };
+
+		QVector<Udb::OID> d_oids;
+		QVector<qint32> d_startVar, d_finishVar, d_durVar; // Tage bzw. Workdays
+		QVector<qint64> d_pvVar, d_evVar, d_acVar;
+		QVector<quint8> d_state;
+
+		int size() const { return d_oids.size(); }
+		static ScheduleVariance compute( const SchedSnapshot& current, const SchedSnapshot& base );
+	};
+
+	struct Baseline
+	{
+		// Erzeugt ein TypeBaseline-Objekt unter WtTypeDefs::getBaselines; kein commit
+		static Udb::Obj create( Udb::Transaction*, const QString& name, bool compress = true );
+		static SchedSnapshot read( const Udb::Obj& baseline );
+		static ScheduleVariance variance( const Udb::Obj& baseline );
+		static QList<Udb::Obj> findAll( Udb::Transaction* );
+	};
+}
+
+#endif // BASELINE_H
@@ -0,0 +1,363 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "BatchRunner.h"
+#include "WorkTreeApp.h"
+#include "WtTypeDefs.h"
+#include "WtLuaBinding.h"
+#include "Indexer.h"
+#include "ObjectHelper.h"
+#include "PdmItemObj.h"
+#include "Scenario.h"
+#include "StatusTrend.h"
+#include "MspdiImporter.h"
+#include "ScheduleExporter.h"
+#include "CachePolicy.h"
+#include "GarbageCollector.h"
+#include <Udb/Database.h>
+#include <Udb/Transaction.h>
+#include <Udb/DatabaseException.h>
+#include <Script/Engine2.h>
+#include <QTextStream>
+#include <QSettings>
+#include <QFile>
+#include <QTime>
+#include <stdio.h>
+using namespace Wt;
+
+BatchRunner::BatchRunner(QObject *p):QObject(p),d_txn(0)
+{
+	d_out = new QTextStream( stderr );
+}
+
+BatchRunner::~BatchRunner()
+{
+	delete d_out;
+}
+
+bool BatchRunner::isBatch(const QStringList & args)
+{
+	return args.contains( QLatin1String( "-batch" ) ) || args.contains( QLatin1String( "-headless" ) );
+}
+
+QString BatchRunner::getUsage()
+{
+	return tr("usage: WorkTree -batch <repository%1> { <command> }\n"
+			  "commands are executed in the given order; the first failing command ends the run:\n"
+			  "  -import <file.xml>  import an MS Project XML file into the IMP\n"
+			  "  -collapse-svts      replace SVT tasks between two links by a link with lag\n"
+			  "  -gc                 remove orphan diagram items, dead assignments and dangling references\n"
+			  "  -script <file.lua>  run a Lua script; the repository is available as in the GUI\n"
+			  "  -index              index the pending updates of the full-text index\n"
+			  "  -reindex            rebuild the full-text index\n"
+			  "  -diagrams           recreate all existing PDM diagrams without layout\n"
+			  "  -layout-diagrams    recreate and layout all existing PDM diagrams (needs Graphviz)\n"
+			  "  -schedule           forward and backward pass; reports finish and critical path only\n"
+			  "  -trend              append the current schedule to the status trend file\n"
+			  "  -export <file>      export the IMP as MS Project XML or CSV (*.csv)\n"
+			  "exit codes: 0 success, 1 usage, 2 open, 3 import, 4 script, 5 index, "
+			  "6 diagram, 7 schedule, 8 export, 9 trend, 10 internal error\n" ).arg( WorkTreeApp::s_extension );
+}
+
+void BatchRunner::error(const QString & msg)
+{
+	*d_out << tr("error: ") << msg << endl;
+}
+
+void BatchRunner::info(const QString & msg)
+{
+	*d_out << msg << endl;
+}
+
+int BatchRunner::run(const QStringList & args)
+{
+	QString path;
+	QStringList cmds; // Kommandos inkl. Parameter in der gegebenen Reihenfolge
+	for( int i = 1; i < args.size(); i++ ) // arg 0 enthält Anwendungspfad
+	{
+		const QString& arg = args[i];
+		if( arg == QLatin1String( "-batch" ) || arg == QLatin1String( "-headless" ) )
+		{
+			if( i + 1 < args.size() && !args[i+1].startsWith( '-' ) )
+				path = args[++i];
+		}else if( arg == QLatin1String( "-import" ) || arg == QLatin1String( "-script" ) ||
+				  arg == QLatin1String( "-export" ) )
+		{
+			if( i + 1 >= args.size() )
+			{
+				error( tr("%1 requires a file name").arg( arg ) );
+				info( getUsage() );
+				return ErrUsage;
+			}
+			cmds << arg << args[++i];
+		}else if( arg.startsWith( '-' ) )
+			cmds << arg;
+		else if( path.isEmpty() )
+			path = arg;
+		else
+		{
+			error( tr("unexpected argument '%1'").arg( arg ) );
+			info( getUsage() );
+			return ErrUsage;
+		}
+	}
+	if( path.isEmpty() )
+	{
+		error( tr("no repository given") );
+		info( getUsage() );
+		return ErrUsage;
+	}
+	if( !path.toLower().endsWith( QLatin1String( WorkTreeApp::s_extension ) ) )
+		path += QLatin1String( WorkTreeApp::s_extension );
+	if( !open( path ) )
+		return ErrOpen;
+
+	QTime t;
+	for( int i = 0; i < cmds.size(); i++ )
+	{
+		const QString& cmd = cmds[i];
+		t.start();
+		int res = Success;
+		if( cmd == QLatin1String( "-import" ) )
+			res = importMspdi( cmds[++i] ) ? Success : ErrImport;
+		else if( cmd == QLatin1String( "-script" ) )
+			res = runScript( cmds[++i] ) ? Success : ErrScript;
+		else if( cmd == QLatin1String( "-export" ) )
+			res = exportSchedule( cmds[++i] ) ? Success : ErrExport;
+		else if( cmd == QLatin1String( "-collapse-svts" ) )
+			collapseSvts();
+		else if( cmd == QLatin1String( "-gc" ) )
+			collectGarbage();
+		else if( cmd == QLatin1String( "-index" ) )
+			res = reindex( false ) ? Success : ErrIndex;
+		else if( cmd == QLatin1String( "-reindex" ) )
+			res = reindex( true ) ? Success : ErrIndex;
+		else if( cmd == QLatin1String( "-diagrams" ) )
+			res = recreateDiagrams( false ) ? Success : ErrDiagram;
+		else if( cmd == QLatin1String( "-layout-diagrams" ) )
+			res = recreateDiagrams( true ) ? Success : ErrDiagram;
+		else if( cmd == QLatin1String( "-schedule" ) )
+			res = schedule() ? Success : ErrSchedule;
+		else if( cmd == QLatin1String( "-trend" ) )
+			res = recordTrend() ? Success : ErrTrend;
+		else
+		{
+			error( tr("unknown command '%1'").arg( cmd ) );
+			info( getUsage() );
+			return ErrUsage;
+		}
+		if( res != Success )
+		{
+			d_txn->rollback();
+			return res;
+		}
+		info( tr("%1 done in %2 ms").arg( cmd ).arg( t.elapsed() ) );
+	}
+	return Success;
+}
+
+bool BatchRunner::open(const QString & path)
+{
+	try
+	{
+		Udb::Database* db = new Udb::Database( this );
+		db->open( path );
+		CachePolicy::inst( db );
+		d_txn = new Udb::Transaction( db, this );
+		WtTypeDefs::init( *db );
+		d_txn->commit();
+	}catch( Udb::DatabaseException& e )
+	{
+		error( tr("cannot open repository %1: [%2] %3").arg( path ).
+			   arg( e.getCodeString() ).arg( e.getMsg() ) );
+		return false;
+	}
+	WorkTreeApp::initLua();
+	Wt::LuaBinding::setRepository( Lua::Engine2::getInst()->getCtx(), d_txn );
+	info( tr("opened %1").arg( path ) );
+	return true;
+}
+
+bool BatchRunner::importMspdi(const QString & path)
+{
+	MspdiImporter imp;
+	if( !imp.importFile( path, d_txn ) )
+	{
+		foreach( const QString& msg, imp.getErrors() )
+			error( msg );
+		return false;
+	}
+	info( tr("imported %1 tasks, %2 milestones, %3 links (%4 not resolved) and %5 calendars").
+		  arg( imp.getCounts().tasks ).arg( imp.getCounts().milestones ).
+		  arg( imp.getCounts().links ).arg( imp.getCounts().deadLinks ).
+		  arg( imp.getCounts().calendars ) );
+	return true;
+}
+
+bool BatchRunner::runScript(const QString & path)
+{
+	QFile f( path );
+	if( !f.open( QIODevice::ReadOnly ) )
+	{
+		error( tr("cannot read script %1").arg( path ) );
+		return false;
+	}
+	if( !Lua::Engine2::getInst()->executeCmd( f.readAll(), path.toLatin1() ) )
+	{
+		error( QString::fromLatin1( Lua::Engine2::getInst()->getLastError() ) );
+		return false;
+	}
+	// Im GUI bleiben nicht committete Änderungen offen; hier gingen sie beim Beenden verloren
+	d_txn->commit();
+	return true;
+}
+
+bool BatchRunner::reindex(bool full)
+{
+	Indexer idx( d_txn, this );
+	const bool res = ( full || !idx.exists() ) ? idx.indexRepository( 0 ) : idx.indexIncrements( 0 );
+	if( !res )
+		error( tr("indexing failed: %1").arg( idx.getError() ) );
+	return res;
+}
+
+static bool _hasItems( const Udb::Obj& diagram )
+{
+	Udb::Obj sub = diagram.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		if( sub.getType() == TypePdmItem )
+			return true;
+	}while( sub.next() );
+	return false;
+}
+
+int BatchRunner::recreateDiagrams(Udb::Obj o, bool layout)
+{
+	// Nur bereits bestehende Diagramme werden neu erzeugt; jeder Task ist potentiell ein
+	// Diagramm, was aber nur für die gefüllten Sinn macht.
+	int res = 0;
+	if( o.getType() == TypePdmDiagram || ( WtTypeDefs::isPdmDiagram( o.getType() ) && _hasItems( o ) ) )
+	{
+		if( !PdmItemObj::createDiagram( o, true, layout, false, 1, true, true, 0 ) )
+			return -1;
+		d_txn->commit();
+		res++;
+	}
+	Udb::Obj sub = o.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		if( WtTypeDefs::isPdmDiagram( sub.getType() ) || WtTypeDefs::isImpType( sub.getType() ) )
+		{
+			const int n = recreateDiagrams( sub, layout );
+			if( n < 0 )
+				return n;
+			res += n;
+		}
+	}while( sub.next() );
+	return res;
+}
+
+bool BatchRunner::recreateDiagrams(bool layout)
+{
+	if( layout )
+	{
+		// PdmLayouter::prepareEngine fragt interaktiv nach dem Pfad; hier nur die Einstellung
+		QSettings set( WorkTreeApp::s_appName, WorkTreeApp::s_appName );
+		PdmItemObj::s_layouter.addLibraryPath( set.value( "GraphvizBinPath" ).toString() );
+		if( !PdmItemObj::s_layouter.loadLibs() )
+		{
+			error( tr("cannot find the Graphviz library; add its bin directory to the PATH") );
+			return false;
+		}
+	}
+	CachePolicy::Bulk bulk( d_txn->getDb() );
+	const int n = recreateDiagrams( d_txn->getOrCreateObject( QUuid( WorkTreeApp::s_imp ), TypeIMP ), layout );
+	if( n < 0 )
+	{
+		error( tr("recreating diagrams failed") );
+		return false;
+	}
+	info( tr("recreated %1 diagrams").arg( n ) );
+	return true;
+}
+
+bool BatchRunner::schedule()
+{
+	Scenario s( ScheduleNet::create( d_txn ) );
+	s.run();
+	if( s.getResult().d_cyclic > 0 )
+	{
+		error( tr("%1 tasks are part of a cycle and cannot be scheduled").arg( s.getResult().d_cyclic ) );
+		return false;
+	}
+	// Nur Bericht: die Termine im Repository stammen aus dem Import und berücksichtigen
+	// Task-Kalender, der Scenario-Scheduler rechnet nur mit dem Default-Kalender; promote
+	// würde sie deshalb verfälschen.
+	const SchedSnapshot snap = s.toSnapshot();
+	qint32 finish = 0;
+	for( int i = 0; i < snap.size(); i++ )
+		finish = qMax( finish, snap.d_ef[i] );
+	int critical = 0;
+	for( int i = 0; i < s.getResult().d_es.size(); i++ )
+		if( s.getResult().getFloat( i ) <= 0 )
+			critical++;
+	info( tr("scheduled %1 tasks and milestones, %2 critical, project finish %3 (not written)").
+		  arg( snap.size() ).arg( critical ).
+		  arg( ( finish ) ? QDate::fromJulianDay( finish ).toString( Qt::ISODate ) : QString("-") ) );
+	return true;
+}
+
+bool BatchRunner::recordTrend()
+{
+	StatusTrend trend( d_txn->getDb()->getFilePath() );
+	if( !trend.append( d_txn ) )
+	{
+		error( trend.getError() );
+		return false;
+	}
+	return true;
+}
+
+bool BatchRunner::exportSchedule(const QString & path)
+{
+	ScheduleExporter exp;
+	if( !exp.exportFile( d_txn->getOrCreateObject( QUuid( WorkTreeApp::s_imp ), TypeIMP ), path ) )
+	{
+		error( exp.getError() );
+		return false;
+	}
+	info( tr("exported %1 objects to %2").arg( exp.getCount() ).arg( path ) );
+	return true;
+}
+
+void BatchRunner::collapseSvts()
+{
+	const int count = ObjectHelper::collapseSvtChains( d_txn );
+	d_txn->commit();
+	info( tr("%1 SVT tasks converted to lags").arg( count ) );
+}
+
+void BatchRunner::collectGarbage()
+{
+	GarbageCollector* gc = GarbageCollector::inst( d_txn );
+	gc->sweepAll();
+	info( gc->toString() );
+}
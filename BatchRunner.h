@@ -0,0 +1,73 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include <QObject>
+#include <QStringList>
+#include <Udb/Obj.h>
+
+class QTextStream;
+
+namespace Udb
+{
+	class Transaction;
+}
+
+namespace Wt
+{
+	// Headless-Modus: öffnet ein Repository ohne MainWindow und führt die Kommandos der
+	// Kommandozeile der Reihe nach aus; das Ergebnis ist der Exit-Code des Prozesses.
+	// Aufruf: WorkTree -batch <repository.wtdb> { <command> }
+	class BatchRunner : public QObject
+	{
+		Q_OBJECT
+	public:
+		enum ExitCode { Success = 0, ErrUsage = 1, ErrOpen = 2, ErrImport = 3, ErrScript = 4,
+						ErrIndex = 5, ErrDiagram = 6, ErrSchedule = 7, ErrExport = 8, ErrTrend = 9,
+						ErrInternal = 10 }; // ErrInternal: unerwartete Exception, siehe runBatch in main.cpp
+
+		explicit BatchRunner( QObject* p = 0 );
+		~BatchRunner();
+		static bool isBatch( const QStringList& args ); // enthält -batch oder -headless
+		static QString getUsage();
+		int run( const QStringList& args ); // args inkl. Anwendungspfad an Position 0
+	protected:
+		bool open( const QString& path );
+		bool importMspdi( const QString& path );
+		bool runScript( const QString& path );
+		bool reindex( bool full );
+		bool recreateDiagrams( bool layout );
+		bool schedule();
+		bool recordTrend();
+		bool exportSchedule( const QString& path );
+		void collapseSvts();
+		void collectGarbage();
+		void error( const QString& );
+		void info( const QString& );
+	private:
+		int recreateDiagrams( Udb::Obj, bool layout );
+		Udb::Transaction* d_txn;
+		QTextStream* d_out;
+	};
+}
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,110 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "CachePolicy.h"
+#include "WorkTreeApp.h"
+#include <Udb/Database.h>
+#include <QSettings>
+#include <QStringList>
+using namespace Wt;
+
+CachePolicy::CachePolicy(Udb::Database * db):QObject(db),d_bulkLevel(0)
+{
+	adjust();
+}
+
+CachePolicy *CachePolicy::inst(Udb::Database * db)
+{
+	Q_ASSERT( db != 0 );
+	CachePolicy* p = db->findChild<CachePolicy*>();
+	if( p == 0 )
+		p = new CachePolicy( db );
+	return p;
+}
+
+Udb::Database *CachePolicy::getDb() const
+{
+	return static_cast<Udb::Database*>( parent() );
+}
+
+void CachePolicy::adjust()
+{
+	// Auch im Batch-Modus ohne WorkTreeApp lesbar
+	QSettings set( WorkTreeApp::s_appName, WorkTreeApp::s_appName );
+	d_stats.d_budgetMb = set.value( "Cache/BudgetMB", int(DefaultBudgetMB) ).toInt();
+	if( d_stats.d_budgetMb <= 0 )
+		d_stats.d_budgetMb = DefaultBudgetMB;
+	// OIDs werden fortlaufend vergeben; getMaxOid ist deshalb eine obere Schranke der Objektanzahl
+	d_stats.d_objects = getDb()->getMaxOid();
+	const qint64 budget = qint64( d_stats.d_budgetMb ) * 1024 * 1024 / BytesPerObject;
+	const qint64 cap = qMax( qint64( MinSize ), budget );
+	const qint64 objects = d_stats.d_objects;
+
+	// Ausserhalb von Bulk-Operationen genügt der Arbeitsbereich, der in den Views sichtbar ist
+	d_stats.d_base = int( qBound( qint64( MinSize ), objects / 4, cap / 4 ) );
+	// Für vollständige Traversierungen möglichst das ganze Repository plus Reserve für neue Objekte
+	d_stats.d_bulk = int( qBound( qint64( d_stats.d_base ), objects + objects / 10, cap ) );
+	apply( ( d_bulkLevel > 0 ) ? d_stats.d_bulk : d_stats.d_base );
+}
+
+void CachePolicy::beginBulk()
+{
+	if( d_bulkLevel++ == 0 )
+	{
+		d_stats.d_bulkPhases++;
+		apply( d_stats.d_bulk );
+	}
+}
+
+void CachePolicy::endBulk()
+{
+	Q_ASSERT( d_bulkLevel > 0 );
+	if( --d_bulkLevel == 0 )
+		adjust(); // Die Bulk-Operation hat evtl. viele Objekte erzeugt
+}
+
+void CachePolicy::apply(int size)
+{
+	if( size == d_stats.d_current )
+		return;
+	getDb()->setCacheSize( size );
+	d_stats.d_current = size;
+	d_stats.d_peak = qMax( d_stats.d_peak, size );
+	d_stats.d_resizes++;
+}
+
+QString CachePolicy::toString() const
+{
+	QStringList lines;
+	lines << tr("Object cache: %1 objects (base %2, bulk %3, peak %4)").arg( d_stats.d_current ).
+			 arg( d_stats.d_base ).arg( d_stats.d_bulk ).arg( d_stats.d_peak );
+	lines << tr("Repository: ~%1 objects, budget %2 MB").arg( d_stats.d_objects ).arg( d_stats.d_budgetMb );
+	lines << tr("Bulk phases: %1, resizes: %2").arg( d_stats.d_bulkPhases ).arg( d_stats.d_resizes );
+	return lines.join( QChar('\n') );
+}
+
+CachePolicy::Bulk::Bulk(Udb::Database * db):d_policy( CachePolicy::inst( db ) )
+{
+	d_policy->beginBulk();
+}
+
+CachePolicy::Bulk::~Bulk()
+{
+	d_policy->endBulk();
+}
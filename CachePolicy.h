@@ -0,0 +1,81 @@
+#ifndef CACHEPOLICY_H
+#define CACHEPOLICY_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+
+namespace Udb
+{
+	class Database;
+}
+
+namespace Wt
+{
+	// Bestimmt die Grösse des Objekt-Caches einer Database aus der Anzahl Objekte im Repository
+	// und dem Speicherbudget (QSettings "Cache/BudgetMB"). Während Bulk-Operationen (Indexierung,
+	// Diagramme neu erzeugen, Analysen) wird der Cache vergrössert und danach wieder verkleinert.
+	// Udb::Database führt selber keine Hit/Miss-Zähler; erfasst wird nur, was hier bekannt ist.
+	class CachePolicy : public QObject
+	{
+		Q_OBJECT
+	public:
+		enum { DefaultBudgetMB = 256, BytesPerObject = 512, MinSize = 10000 };
+		struct Stats
+		{
+			quint64 d_objects; // Schätzung aus getMaxOid
+			int d_budgetMb;
+			int d_base; // Grösse ausserhalb von Bulk-Operationen
+			int d_bulk; // Grösse während Bulk-Operationen
+			int d_current;
+			int d_peak;
+			int d_bulkPhases;
+			int d_resizes;
+			Stats():d_objects(0),d_budgetMb(0),d_base(0),d_bulk(0),d_current(0),
+				d_peak(0),d_bulkPhases(0),d_resizes(0){}
+		};
+
+		// Hält den Cache vergrössert solange die Instanz lebt; verschachtelbar
+		class Bulk
+		{
+		public:
+			Bulk( Udb::Database* );
+			~Bulk();
+		private:
+			CachePolicy* d_policy;
+		};
+
+		static CachePolicy* inst( Udb::Database* ); // eine Instanz pro Database, wendet Basisgrösse an
+		void adjust(); // Grössen neu berechnen, z.B. nach einem Import
+		void beginBulk();
+		void endBulk();
+		const Stats& getStats() const { return d_stats; }
+		QString toString() const;
+	protected:
+		CachePolicy( Udb::Database* );
+		Udb::Database* getDb() const;
+		void apply( int size );
+	private:
+		Stats d_stats;
+		int d_bulkLevel;
+	};
+}
+
+#endif // CACHEPOLICY_H
@@ -0,0 +1,343 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "GarbageCollector.h"
+#include "WorkerPool.h"
+#include "CachePolicy.h"
+#include "Indexer.h"
+#include "PdmItemObj.h"
+#include "WtTypeDefs.h"
+#include <Udb/Transaction.h>
+#include <Udb/Database.h>
+#include <Udb/Idx.h>
+#include <Oln2/OutlineItem.h>
+#include <QStringList>
+#include <QPointer>
+using namespace Wt;
+
+namespace Wt
+{
+	class _SweepTask : public WorkerTask
+	{
+	public:
+		QPointer<GarbageCollector> d_gc;
+		GarbageCollector::Findings d_found;
+		Udb::OID d_from;
+		Udb::OID d_to;
+		bool d_pendings;
+		_SweepTask( GarbageCollector* gc, Udb::OID from, Udb::OID to, bool pendings ):
+			d_gc(gc),d_from(from),d_to(to),d_pendings(pendings){}
+	protected:
+		void compute( Udb::Transaction* snap )
+		{
+			if( d_pendings )
+				GarbageCollector::scanPendings( snap, d_found );
+			GarbageCollector::scan( snap, d_from, d_to, d_found );
+		}
+		bool restart()
+		{
+			d_found = GarbageCollector::Findings();
+			return true;
+		}
+		bool apply( Udb::Transaction* txn )
+		{
+			// GarbageCollector::apply prüft jeden Fund gegen den aktuellen Stand
+			if( d_gc.isNull() )
+				return false;
+			d_gc->d_stats.d_scanned += d_to - d_from;
+			return GarbageCollector::apply( txn, d_found, d_gc->d_stats );
+		}
+	};
+}
+
+static bool _hasItemOn( const Udb::Obj& diagram, Udb::OID orig )
+{
+	Udb::Idx idx( diagram.getTxn(), IndexDefs::IdxOrigObject );
+	if( idx.seek( Stream::DataCell().setOid( orig ) ) ) do
+	{
+		if( diagram.getObject( idx.getOid() ).getParent().equals( diagram ) )
+			return true;
+	}while( idx.nextKey() );
+	return false;
+}
+
+static bool _isOrphanItem( const Udb::Obj& item )
+{
+	// Dieselben Regeln wie in PdmItemMdl::fetchItemFromDb
+	const Udb::Obj diagram = item.getParent();
+	if( PdmItemObj( item ).isCondensed() )
+		return diagram.isNull( true ) || !_hasItemOn( diagram, item.getValue( AttrCondPred ).getOid() ) ||
+				!_hasItemOn( diagram, item.getValue( AttrCondSucc ).getOid() );
+	const Udb::Obj orig = item.getValueAsObj( AttrOrigObject );
+	if( diagram.isNull( true ) || orig.isNull( true ) )
+		return true;
+	if( orig.getType() == TypeLink )
+		return !_hasItemOn( diagram, orig.getValue( AttrPred ).getOid() ) ||
+				!_hasItemOn( diagram, orig.getValue( AttrSucc ).getOid() );
+	return false;
+}
+
+static bool _isDeadAssig( const Udb::Obj& o )
+{
+	switch( o.getType() )
+	{
+	case TypeRasciAssig:
+		return o.getValueAsObj( AttrAssigPrincipal ).isNull( true ) ||
+				o.getValueAsObj( AttrAssigObject ).isNull( true );
+	case TypeUnitAssig:
+		return o.getValueAsObj( AttrItemLink ).isNull( true ); // Member
+	default:
+		return false;
+	}
+}
+
+static inline bool _isDangling( const Udb::Obj& o, quint32 atom )
+{
+	return o.getValue( atom ).isOid() && o.getValueAsObj( atom ).isNull( true );
+}
+
+static inline bool _isDeadAlias( const Udb::Obj& o )
+{
+	// Ein Alias zeigt nur den Body des Ziels an; ohne Ziel ist das Item leer
+	return o.getType() == Oln::OutlineItem::TID && _isDangling( o, Oln::OutlineItem::AttrAlias );
+}
+
+static inline bool _hasSchedRefs( quint32 type )
+{
+	// Nur hier sind AttrWbsRef bzw. AttrItemLink bloße Verweise, die man ohne Folgen löschen kann
+	return type == TypeTask || type == TypeMilestone || type == TypeLink;
+}
+
+GarbageCollector::GarbageCollector(Udb::Transaction * txn):QObject( txn ),d_next(1),d_running(false),d_busy(false),
+	d_continuous(false)
+{
+	d_timer.setSingleShot( true );
+	connect( &d_timer, SIGNAL(timeout()), this, SLOT(onNextSlice()) );
+}
+
+GarbageCollector *GarbageCollector::inst(Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	GarbageCollector* gc = txn->findChild<GarbageCollector*>();
+	if( gc == 0 )
+		gc = new GarbageCollector( txn );
+	return gc;
+}
+
+Udb::Transaction *GarbageCollector::getTxn() const
+{
+	return static_cast<Udb::Transaction*>( parent() );
+}
+
+void GarbageCollector::start(bool continuous)
+{
+	d_continuous = d_continuous || continuous;
+	if( d_running )
+		return;
+	d_running = true;
+	d_next = 1;
+	d_timer.start( SliceDelay );
+}
+
+void GarbageCollector::stop()
+{
+	d_running = false;
+	d_timer.stop();
+}
+
+void GarbageCollector::onNextSlice()
+{
+	if( !d_running || d_busy )
+		return;
+	const Udb::OID max = getTxn()->getDb()->getMaxOid();
+	if( d_next > max )
+	{
+		d_stats.d_passes++;
+		d_next = 1;
+		if( d_continuous )
+			d_timer.start( PassDelay );
+		else
+			d_running = false;
+		return;
+	}
+	const Udb::OID to = qMin( d_next + Udb::OID( SliceSize ), max + 1 );
+	_SweepTask* t = new _SweepTask( this, d_next, to, d_next == 1 );
+	d_next = to;
+	d_busy = true;
+	connect( t, SIGNAL(finished(bool)), this, SLOT(onSliceDone(bool)) );
+	WorkerPool::inst( getTxn() )->start( t );
+}
+
+void GarbageCollector::onSliceDone(bool ok)
+{
+	d_busy = false;
+	if( !ok )
+	{
+		WorkerTask* t = static_cast<WorkerTask*>( sender() );
+		if( !t->isCanceled() )
+		{
+			d_stats.d_failed++;
+			d_stats.d_lastError = t->getError();
+		}
+	}
+	if( d_running )
+		d_timer.start( SliceDelay );
+}
+
+void GarbageCollector::sweepAll()
+{
+	Udb::Transaction* txn = getTxn();
+	CachePolicy::Bulk bulk( txn->getDb() );
+	Findings f;
+	scanPendings( txn, f );
+	apply( txn, f, d_stats );
+	txn->commit();
+	const Udb::OID max = txn->getDb()->getMaxOid();
+	for( Udb::OID from = 1; from <= max; from += SliceSize )
+	{
+		const Udb::OID to = qMin( from + Udb::OID( SliceSize ), max + 1 );
+		Findings f;
+		scan( txn, from, to, f );
+		apply( txn, f, d_stats );
+		txn->commit();
+		d_stats.d_scanned += to - from;
+	}
+	d_stats.d_passes++;
+}
+
+void GarbageCollector::scan(Udb::Transaction * txn, Udb::OID from, Udb::OID to, Findings & f)
+{
+	for( Udb::OID oid = from; oid < to; oid++ )
+	{
+		const Udb::Obj o = txn->getObject( oid );
+		if( o.isNull( true ) )
+			continue;
+		const quint32 type = o.getType();
+		if( type == TypePdmItem )
+		{
+			if( _isOrphanItem( o ) )
+				f.d_erase.append( oid );
+			continue;
+		}
+		if( _isDeadAssig( o ) || _isDeadAlias( o ) )
+		{
+			f.d_erase.append( oid );
+			continue;
+		}
+		if( !_hasSchedRefs( type ) )
+			continue;
+		if( _isDangling( o, AttrItemLink ) )
+			f.d_refs.append( qMakePair( oid, quint32( AttrItemLink ) ) );
+		if( _isDangling( o, AttrWbsRef ) )
+			f.d_refs.append( qMakePair( oid, quint32( AttrWbsRef ) ) );
+	}
+}
+
+void GarbageCollector::scanPendings(Udb::Transaction * txn, Findings & f)
+{
+	const Udb::Obj pending = txn->getObject( QUuid( Indexer::s_pendingUuid ) );
+	if( pending.isNull() )
+		return;
+	Udb::Mit i = pending.findCells( Udb::Obj::KeyList() );
+	if( !i.isNull() ) do
+	{
+		const Udb::Mit::KeyList k = i.getKey();
+		if( Indexer::isPendingBlock( k ) )
+			continue; // kompakte Blöcke enthalten nur OIDs; tote werden vom Indexer gelöscht
+		else if( k.size() != 1 || !k[0].isOid() )
+			f.d_badKeys.append( k ); // wie in Indexer::indexIncrements
+		else if( i.getValue().getBool() && txn->getObject( k[0].getOid() ).isNull( true ) )
+			f.d_deadPendings.append( k[0].getOid() ); // nur noch aus dem Index löschen
+	}while( i.nextKey() );
+}
+
+bool GarbageCollector::apply(Udb::Transaction * txn, const Findings & f, Stats & s)
+{
+	// Die Worker-Verbindung kann älter sein als der committete Stand; darum jeden Fund nochmals prüfen
+	const int before = s.d_items + s.d_assigs + s.d_aliases + s.d_refs + s.d_pendings;
+	foreach( Udb::OID oid, f.d_erase )
+	{
+		Udb::Obj o = txn->getObject( oid );
+		if( o.isNull( true ) )
+			continue;
+		if( o.getType() == TypePdmItem )
+		{
+			if( _isOrphanItem( o ) )
+			{
+				o.erase();
+				s.d_items++;
+			}
+		}else if( _isDeadAssig( o ) )
+		{
+			o.erase();
+			s.d_assigs++;
+		}else if( _isDeadAlias( o ) )
+		{
+			o.erase();
+			s.d_aliases++;
+		}
+	}
+	for( int i = 0; i < f.d_refs.size(); i++ )
+	{
+		Udb::Obj o = txn->getObject( f.d_refs[i].first );
+		if( !o.isNull( true ) && _hasSchedRefs( o.getType() ) && _isDangling( o, f.d_refs[i].second ) )
+		{
+			o.clearValue( f.d_refs[i].second );
+			s.d_refs++;
+		}
+	}
+	if( f.d_badKeys.isEmpty() && f.d_deadPendings.isEmpty() )
+		return s.d_items + s.d_assigs + s.d_aliases + s.d_refs + s.d_pendings != before;
+	Udb::Obj pending = txn->getObject( QUuid( Indexer::s_pendingUuid ) );
+	if( pending.isNull() )
+		return s.d_items + s.d_assigs + s.d_aliases + s.d_refs + s.d_pendings != before;
+	foreach( const Udb::Obj::KeyList& k, f.d_badKeys )
+	{
+		if( !pending.getCell( k ).isNull() )
+		{
+			pending.setCell( k, Stream::DataCell().setNull() );
+			s.d_pendings++;
+		}
+	}
+	Udb::Mit::KeyList k( 1 );
+	foreach( Udb::OID oid, f.d_deadPendings )
+	{
+		k[0].setOid( oid );
+		if( pending.getCell( k ).getBool() && txn->getObject( oid ).isNull( true ) )
+		{
+			pending.setCell( k, Stream::DataCell().setBool( false ) );
+			s.d_pendings++;
+		}
+	}
+	return s.d_items + s.d_assigs + s.d_aliases + s.d_refs + s.d_pendings != before;
+}
+
+QString GarbageCollector::toString() const
+{
+	QStringList lines;
+	lines << tr("Garbage collector: %1, %2 passes, %3 objects scanned").
+			 arg( ( d_running ) ? tr("running") : tr("stopped") ).
+			 arg( d_stats.d_passes ).arg( d_stats.d_scanned );
+	lines << tr("Removed %1 diagram items, %2 assignments, %3 aliases, %4 references, %5 index entries").
+			 arg( d_stats.d_items ).arg( d_stats.d_assigs ).arg( d_stats.d_aliases ).arg( d_stats.d_refs ).
+			 arg( d_stats.d_pendings );
+	if( d_stats.d_failed )
+		lines << tr("%1 ranges failed, last error: %2").arg( d_stats.d_failed ).arg( d_stats.d_lastError );
+	return lines.join( QChar('\n') );
+}
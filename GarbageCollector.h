@@ -0,0 +1,94 @@
+#ifndef GARBAGECOLLECTOR_H
+#define GARBAGECOLLECTOR_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QPair>
+#include <QTimer>
+#include <Udb/Obj.h>
+
+namespace Wt
+{
+	// Räumt das Repository im Hintergrund auf: PdmItems ohne Original oder ohne Endpunkte auf
+	// dem eigenen Diagramm, Assigs ohne Principal bzw. Object, UnitAssigs ohne Member, Alias-Items
+	// des Outlines mit gelöschtem Ziel, Referenzen (AttrWbsRef, AttrItemLink) von Tasks, Meilensteinen
+	// und Links auf gelöschte Objekte und ungültige Pending-Zellen des Indexers.
+	// Gesucht wird in OID-Bereichen auf einer Worker-Verbindung des WorkerPool; die Funde werden
+	// auf der Schreib-Transaktion des Pools nochmals geprüft und pro Bereich bereinigt.
+	class GarbageCollector : public QObject
+	{
+		Q_OBJECT
+	public:
+		enum { SliceSize = 2000, SliceDelay = 250, PassDelay = 10 * 60 * 1000 }; // OIDs, ms, ms
+		struct Stats
+		{
+			quint32 d_scanned;
+			int d_items; // gelöschte PdmItems
+			int d_assigs; // gelöschte Assigs und UnitAssigs
+			int d_aliases; // gelöschte Alias-Items
+			int d_refs; // gelöschte Referenzen
+			int d_pendings; // bereinigte Pending-Zellen
+			int d_passes; // vollständige Durchläufe
+			int d_failed; // fehlgeschlagene Bereiche
+			QString d_lastError;
+			Stats():d_scanned(0),d_items(0),d_assigs(0),d_aliases(0),d_refs(0),d_pendings(0),d_passes(0),d_failed(0){}
+		};
+		struct Findings
+		{
+			QList<Udb::OID> d_erase;
+			QList< QPair<Udb::OID,quint32> > d_refs; // Objekt, Attribut
+			QList<Udb::Obj::KeyList> d_badKeys;
+			QList<Udb::OID> d_deadPendings;
+			bool isEmpty() const { return d_erase.isEmpty() && d_refs.isEmpty() &&
+						d_badKeys.isEmpty() && d_deadPendings.isEmpty(); }
+		};
+
+		static GarbageCollector* inst( Udb::Transaction* ); // eine Instanz pro Haupttransaktion
+		// beginnt einen neuen Durchlauf im Hintergrund; continuous wiederholt ihn alle PassDelay ms
+		void start( bool continuous = false );
+		void stop();
+		bool isRunning() const { return d_running; }
+		void sweepAll(); // synchron auf der Haupttransaktion, z.B. im Batch-Modus
+		const Stats& getStats() const { return d_stats; }
+		QString toString() const;
+
+		static void scan( Udb::Transaction*, Udb::OID from, Udb::OID to, Findings& );
+		static void scanPendings( Udb::Transaction*, Findings& );
+		// prüft jeden Fund erneut und bereinigt ihn; kein commit; true falls etwas geändert wurde
+		static bool apply( Udb::Transaction*, const Findings&, Stats& );
+	protected slots:
+		void onNextSlice();
+		void onSliceDone( bool ok );
+	protected:
+		GarbageCollector( Udb::Transaction* );
+		Udb::Transaction* getTxn() const;
+	private:
+		friend class _SweepTask;
+		Stats d_stats;
+		QTimer d_timer;
+		Udb::OID d_next;
+		bool d_running;
+		bool d_busy;
+		bool d_continuous;
+	};
+}
+
+#endif // GARBAGECOLLECTOR_H
@@ -56,9 +56,26 @@ QTreeView *GenericCtrl::getTree() const
     return dynamic_cast<QTreeView*>( parent() );
 }
 
-void GenericCtrl::setRoot(const Udb::Obj &root)
+void GenericCtrl::setRoot(const Udb::Obj &root, bool deferred )
 {
-    d_mdl->setRoot( root );
+	if( deferred )
+	{
+		d_pending = root;
+		d_mdl->setRoot( Udb::Obj() );
+	}else
+	{
+		d_pending = Udb::Obj();
+		d_mdl->setRoot( root );
+	}
+}
+
+void GenericCtrl::populate()
+{
+	if( d_pending.isNull() )
+		return;
+	const Udb::Obj root = d_pending;
+	d_pending = Udb::Obj();
+	d_mdl->setRoot( root );
 }
 
 Udb::Obj GenericCtrl::getSelectedObject(bool rootOtherwise) const
@@ -68,12 +85,13 @@ Udb::Obj GenericCtrl::getSelectedObject(bool rootOtherwise) const
     if( sr.size() == 1 )
         doc = d_mdl->getObject( sr.first() );
     else if( rootOtherwise )
-        doc = d_mdl->getRoot();
+        doc = ( d_pending.isNull() ) ? d_mdl->getRoot() : d_pending;
     return doc;
 }
 
 void GenericCtrl::showObject(const Udb::Obj & o)
 {
+	populate();
     QModelIndex i = d_mdl->getIndex( o );
     focusOn( o );
 }
@@ -93,6 +111,8 @@ void GenericCtrl::add( quint32 type )
 
 void GenericCtrl::focusOn(const Udb::Obj & o, bool edit )
 {
+	populate();
+    d_mdl->ensureLoaded( o );
     const QModelIndex i = d_mdl->getIndex( o );
     // unntig wegen scrollto: getTree()->setExpanded( i.parent(), true );
     getTree()->selectionModel()->clearSelection();
@@ -154,7 +174,10 @@ void GenericCtrl::onMoveTo(const QList<Udb::Obj> &what, const QModelIndex &toPar
     getTree()->selectionModel()->clearSelection();
     getTree()->setExpanded( toParent, true );
     foreach( Udb::Obj o, winner )
+    {
+        d_mdl->ensureLoaded( o );
         getTree()->selectionModel()->select( d_mdl->getIndex( o ), QItemSelectionModel::SelectCurrent );
+    }
     getTree()->scrollTo( getTree()->currentIndex() );
 }
 
@@ -37,7 +37,9 @@ namespace Wt
     public:
         explicit GenericCtrl(QTreeView *tree, GenericMdl* mdl );
         QTreeView* getTree() const;
-        void setRoot( const Udb::Obj& root );
+        // deferred: das Modell wird erst mit populate() bzw. beim ersten Zugriff gefuellt
+        void setRoot( const Udb::Obj& root, bool deferred = false );
+        bool isPopulated() const { return d_pending.isNull(); }
         Udb::Obj getSelectedObject( bool rootOtherwise = false ) const;
         void showObject( const Udb::Obj& );
     signals:
@@ -52,6 +54,7 @@ namespace Wt
         void onAddNext();
         void onSelectionChanged();
         void onCopy();
+        void populate();
     protected slots:
         void onNameEdited( const QModelIndex & index, const QVariant & value );
         void onMoveTo( const QList<Udb::Obj> &what, const QModelIndex & toParent, int beforeRow );
@@ -64,6 +67,7 @@ namespace Wt
 		GenericMdl* getMdl() const { return d_mdl; }
     private:
         GenericMdl* d_mdl;
+        Udb::Obj d_pending;
     };
 }
 
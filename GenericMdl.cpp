@@ -29,7 +29,7 @@
 using namespace Wt;
 
 GenericMdl::GenericMdl(QObject *parent) :
-    QAbstractItemModel(parent)
+    QAbstractItemModel(parent),d_lazy(false)
 {
 }
 
@@ -40,18 +40,46 @@ void GenericMdl::setRoot(const Udb::Obj &root)
 	foreach( Slot* s, d_root.d_children )
 		delete s;
 	d_root.d_children.clear();
+	d_root.d_fetched = false;
+	d_cache.clear();
 	reset();
 	if( !d_root.d_obj.isNull() )
-		d_root.d_obj.getDb()->removeObserver( this, SLOT( onDbUpdate( Udb::UpdateInfo ) ) );
+		UpdateDispatcher::inst( d_root.d_obj.getTxn() )->unsubscribe( this );
 	d_root.d_obj = root;
+	if( !d_root.d_obj.isNull() )
+	{
+		// Nur die Objekte im Baum und deren direkte Kinder werden beobachtet
+		UpdateDispatcher* disp = UpdateDispatcher::inst( d_root.d_obj.getTxn() );
+		disp->subscribe( this, SLOT( onDbUpdates( Wt::UpdateBatch ) ) );
+		disp->observeChildren( this, d_root.d_obj.getOid() );
+	}
 	fillSubs( &d_root );
 	reset();
-	if( !d_root.d_obj.isNull() )
-		d_root.d_obj.getDb()->addObserver( this, SLOT( onDbUpdate( Udb::UpdateInfo ) ), false );
+}
+
+void GenericMdl::observe( const Udb::Obj& o, bool on )
+{
+	UpdateDispatcher* disp = UpdateDispatcher::inst( d_root.d_obj.getTxn() );
+	disp->observeObject( this, o.getOid(), on );
+	disp->observeChildren( this, o.getOid(), on );
+}
+
+GenericMdl::Slot* GenericMdl::createSlot( Slot* p, const Udb::Obj& o, int row )
+{
+    Slot* s = new Slot();
+    s->d_parent = p;
+    s->d_obj = o;
+    p->d_children.insert( row, s );
+    p->renumber( row );
+    d_cache[ o.getOid() ] = s;
+    observe( o, true );
+    return s;
 }
 
 void GenericMdl::fillSubs( Slot* p )
 {
+	// Ohne Notifikation; nur fuer neue Slots, die noch nicht in einem View sichtbar sind
+	p->d_fetched = true;
 	if( p->d_obj.isNull() )
 		return;
 	Udb::Obj e = p->d_obj.getFirstObj();
@@ -59,16 +87,94 @@ void GenericMdl::fillSubs( Slot* p )
 	{
 		if( isSupportedType( e.getType() ) )
 		{
-            Slot* s = new Slot();
-            s->d_parent = p;
-            p->d_children.append( s );
-            s->d_obj = e;
-            d_cache[ e.getOid() ] = s;
-            fillSubs( s );
+            Slot* s = createSlot( p, e, p->d_children.size() );
+            if( !d_lazy )
+                fillSubs( s );
 		}
 	}while( e.next() );
 }
 
+void GenericMdl::fetch( Slot* p )
+{
+	// Eine Ebene nachladen, wenn der Slot bereits im View sichtbar ist
+	if( p->d_fetched )
+		return;
+	p->d_fetched = true;
+	if( p->d_obj.isNull() )
+		return;
+	QList<Udb::Obj> subs;
+	Udb::Obj e = p->d_obj.getFirstObj();
+	if( !e.isNull() ) do
+	{
+		if( isSupportedType( e.getType() ) )
+			subs.append( e );
+	}while( e.next() );
+	if( subs.isEmpty() )
+		return;
+	beginInsertRows( getIndex( p ), 0, subs.size() - 1 );
+	foreach( const Udb::Obj& o, subs )
+	{
+		Slot* s = new Slot( p );
+		s->d_obj = o;
+		d_cache[ o.getOid() ] = s;
+		observe( o, true );
+	}
+	endInsertRows();
+}
+
+GenericMdl::Slot* GenericMdl::fetchPath( const Udb::Obj& o )
+{
+	if( o.isNull() )
+		return 0;
+	if( o.equals( d_root.d_obj ) )
+		return &d_root;
+	Slot* s = d_cache.value( o.getOid() );
+	if( s != 0 || !d_lazy )
+		return s;
+	Slot* p = fetchPath( o.getParent() );
+	if( p == 0 || p->d_fetched )
+		return 0; // o liegt ausserhalb von d_root oder hat keinen unterstuetzten Typ
+	fetch( p );
+	return d_cache.value( o.getOid() );
+}
+
+GenericMdl::Slot* GenericMdl::getSlot( const QModelIndex& i ) const
+{
+	if( i.isValid() )
+	{
+		Slot* s = static_cast<Slot*>( i.internalPointer() );
+		Q_ASSERT( s != 0 );
+		return s;
+	}else
+		return const_cast<Slot*>( &d_root );
+}
+
+bool GenericMdl::hasChildren( const QModelIndex & parent ) const
+{
+	const Slot* s = getSlot( parent );
+	if( s->d_fetched )
+		return !s->d_children.isEmpty();
+	// Nur bis zum ersten unterstuetzten Kind suchen
+	Udb::Obj e = s->d_obj.getFirstObj();
+	if( !e.isNull() ) do
+	{
+		if( const_cast<GenericMdl*>( this )->isSupportedType( e.getType() ) )
+			return true;
+	}while( e.next() );
+	return false;
+}
+
+bool GenericMdl::canFetchMore( const QModelIndex & parent ) const
+{
+	return !d_root.d_obj.isNull() && !getSlot( parent )->d_fetched;
+}
+
+void GenericMdl::fetchMore( const QModelIndex & parent )
+{
+	if( !d_root.d_obj.isNull() )
+		fetch( getSlot( parent ) );
+}
+
 QModelIndex GenericMdl::parent ( const QModelIndex & index ) const
 {
 	if( index.isValid() )
@@ -80,7 +186,7 @@ QModelIndex GenericMdl::parent ( const QModelIndex & index ) const
 		// else
 		Q_ASSERT( s->d_parent != 0 );
 		Q_ASSERT( s->d_parent->d_parent != 0 );
-		return createIndex( s->d_parent->d_parent->d_children.indexOf( s->d_parent ), 0, s->d_parent );
+		return createIndex( s->d_parent->d_row, 0, s->d_parent );
 	}else
 		return QModelIndex();
 }
@@ -135,7 +241,7 @@ QModelIndex GenericMdl::getIndex( Slot* s ) const
 	if( s == 0 || s->d_parent == 0 )
 		return QModelIndex();
 	else
-		return createIndex( s->d_parent->d_children.indexOf( s ), 0, s );
+		return createIndex( s->d_row, 0, s );
 }
 
 Udb::Obj GenericMdl::getObject( const QModelIndex& i ) const
@@ -149,12 +255,18 @@ Udb::Obj GenericMdl::getObject( const QModelIndex& i ) const
 		return d_root.d_obj;
 }
 
+void GenericMdl::ensureLoaded( const Udb::Obj& o )
+{
+	if( d_lazy && !o.isNull() )
+		fetchPath( o );
+}
+
 QModelIndex GenericMdl::getIndex( const Udb::Obj& o ) const
 {
 	if( o.isNull() )
 		return QModelIndex();
 	Slot* s = d_cache.value( o.getOid() );
-	if( s )
+	if( s && s != &d_root )
 		return getIndex( s );
 	else
 		return QModelIndex();
@@ -174,29 +286,27 @@ QUrl GenericMdl::objToUrl(const Udb::Obj &o)
 	return url;
 }
 
-void GenericMdl::onDbUpdate( Udb::UpdateInfo info )
+void GenericMdl::onDbUpdates( const Wt::UpdateBatch& batch )
 {
 	if( d_root.d_obj.isNull() )
 		return;
-	switch( info.d_kind )
+	foreach( const ObjChange& c, batch )
 	{
-	case Udb::UpdateInfo::Aggregated:
-		addItem( info.d_id, info.d_parent, info.d_before );
-		break;
-	case Udb::UpdateInfo::Deaggregated:
-		removeItem( info.d_id );
-		break;
-	case Udb::UpdateInfo::ValueChanged:
-    case Udb::UpdateInfo::TypeChanged:
-        {
-            Slot* s = d_cache.value( info.d_id );
-            if( s != 0 )
-            {
-                QModelIndex i = getIndex( s );
-                emit dataChanged( i, i );
-            }
-        }
-		break;
+		// Bei einem Move kommt zuerst das Entfernen, dann das Einfuegen am neuen Ort
+		if( c.is( ObjChange::Deaggregated ) )
+			removeItem( c.d_id );
+		if( c.is( ObjChange::Aggregated ) )
+			addItem( c.d_id, c.d_parent, c.d_before );
+		else if( c.is( ObjChange::ValueChanged ) || c.is( ObjChange::TypeChanged ) )
+		{
+			// Pro Objekt und Commit nur noch ein dataChanged
+			Slot* s = d_cache.value( c.d_id );
+			if( s != 0 )
+			{
+				QModelIndex i = getIndex( s );
+				emit dataChanged( i, i );
+			}
+		}
 	}
 }
 
@@ -316,6 +426,19 @@ void GenericMdl::addItem( quint64 oid, quint64 parent, quint64 before )
 		Udb::Obj objToInsert = d_root.d_obj.getObject( oid );
 		if( isSupportedType( objToInsert.getType() ) )
 		{
+            if( !parentSlot->d_fetched )
+            {
+                // Noch nicht geladen; nur wenn es das erste Kind ist nachladen, damit der View
+                // den Parent als expandierbar anzeigt. Sonst erst bei Expand laden.
+                Udb::Obj sub = parentSlot->d_obj.getFirstObj();
+                if( !sub.isNull() ) do
+                {
+                    if( sub.getOid() != oid && isSupportedType( sub.getType() ) )
+                        return;
+                }while( sub.next() );
+                fetch( parentSlot );
+                return;
+            }
             int beforeRow = parentSlot->d_children.size(); // Default: am Ende anfgen
             if( before != 0 )
             {
@@ -327,16 +450,13 @@ void GenericMdl::addItem( quint64 oid, quint64 parent, quint64 before )
                 if( beforeSlot )
                 {
                     Q_ASSERT( beforeSlot->d_parent == parentSlot );
-                    beforeRow = parentSlot->d_children.indexOf( beforeSlot );
+                    beforeRow = beforeSlot->d_row;
                 }
             } // else am Ende einfgen
             beginInsertRows( getIndex( parentSlot ), beforeRow, beforeRow );
-            Slot* s = new Slot();
-            s->d_parent = parentSlot;
-            parentSlot->d_children.insert( beforeRow, s );
-            s->d_obj = objToInsert;
-            d_cache[ oid ] = s;
-            fillSubs( s );
+            Slot* s = createSlot( parentSlot, objToInsert, beforeRow );
+            if( !d_lazy )
+                fillSubs( s );
             endInsertRows();
 		}
 	}
@@ -347,6 +467,7 @@ void GenericMdl::recursiveRemove( Slot* s )
 	if( s == 0 )
 		return;
     d_cache.remove( s->d_obj.getOid() );
+    observe( s->d_obj, false );
 	for( int i = 0; i < s->d_children.size(); i++ )
 		recursiveRemove( s->d_children[i] );
 }
@@ -356,10 +477,11 @@ void GenericMdl::removeItem( quint64 oid )
 	Slot* s = d_cache.value( oid );
 	if( s != 0 )
 	{
-		const int row = s->d_parent->d_children.indexOf( s );
-        Q_ASSERT( row != -1 );
+		const int row = s->d_row;
+        Q_ASSERT( s->d_parent->d_children.value( row ) == s );
 		beginRemoveRows( getIndex( s->d_parent ), row, row );
 		s->d_parent->d_children.removeAt( row );
+		s->d_parent->renumber( row );
         recursiveRemove( s );
 		delete s;
 		endRemoveRows();
@@ -23,6 +23,7 @@
 #include <QtCore/QAbstractItemModel>
 #include <QtCore/QHash>
 #include <Udb/Obj.h>
+#include "UpdateDispatcher.h"
 
 namespace Wt
 {
@@ -32,9 +33,13 @@ namespace Wt
     public:
         explicit GenericMdl(QObject *parent = 0);
         void setRoot( const Udb::Obj& root );
+        // Lazy: Kinder werden erst bei Expand bzw. ensureLoaded geladen; vor setRoot aufrufen
+        void setLazy( bool on ) { d_lazy = on; }
+        bool isLazy() const { return d_lazy; }
         const Udb::Obj& getRoot() const { return d_root.d_obj; }
         Udb::Obj getObject( const QModelIndex& ) const;
-		QModelIndex getIndex( const Udb::Obj& ) const;
+		void ensureLoaded( const Udb::Obj& ); // laedt im Lazy-Modus die Vorfahren nach
+		QModelIndex getIndex( const Udb::Obj& ) const; // ungueltig, falls nicht geladen
 		static QUrl objToUrl(const Udb::Obj & o);
 		static void writeObjectUrls(QMimeData *data, const QList<Udb::Obj> & objs );
 		bool isReadOnly() const;
@@ -45,6 +50,9 @@ namespace Wt
 		QModelIndex index ( int row, int column, const QModelIndex & parent = QModelIndex() ) const;
 		QModelIndex parent ( const QModelIndex & index ) const;
 		int rowCount ( const QModelIndex & parent = QModelIndex() ) const;
+		bool hasChildren ( const QModelIndex & parent = QModelIndex() ) const;
+		bool canFetchMore ( const QModelIndex & parent ) const;
+		void fetchMore ( const QModelIndex & parent );
 		Qt::ItemFlags flags ( const QModelIndex & index ) const;
 		bool setData ( const QModelIndex & index, const QVariant & value, int role = Qt::EditRole );
 		Qt::DropActions supportedDragActions () const;
@@ -56,7 +64,7 @@ namespace Wt
         void signalNameEdited( const QModelIndex & index, const QVariant & value );
         void signalMoveTo( const QList<Udb::Obj>& what, const QModelIndex & to, int row );
     protected slots:
-        void onDbUpdate( Udb::UpdateInfo );
+        void onDbUpdates( const Wt::UpdateBatch& );
     protected:
         void addItem( quint64 oid, quint64 parent, quint64 before );
 		void removeItem( quint64 oid );
@@ -71,15 +79,24 @@ namespace Wt
 			Udb::Obj d_obj;
 			QList<Slot*> d_children;
 			Slot* d_parent;
-			Slot(Slot* p = 0):d_parent(p){ if( p ) p->d_children.append(this); }
+			int d_row; // Index in d_parent->d_children
+			bool d_fetched; // d_children geladen
+			Slot(Slot* p = 0):d_parent(p),d_row(0),d_fetched(false)
+			{ if( p ) { d_row = p->d_children.size(); p->d_children.append(this); } }
 			~Slot() { foreach( Slot* s, d_children ) delete s; }
-			void fillSubs();
+			void renumber( int from ) { for( int i = from; i < d_children.size(); i++ ) d_children[i]->d_row = i; }
 		};
         void fillSubs( Slot* );
+        void fetch( Slot* );
+        Slot* createSlot( Slot* parent, const Udb::Obj&, int row );
+        Slot* fetchPath( const Udb::Obj& );
+        Slot* getSlot( const QModelIndex& ) const;
+        void observe( const Udb::Obj&, bool on );
         void recursiveRemove( Slot* s );
 		QModelIndex getIndex( Slot* ) const;
         QHash<quint32,Slot*> d_cache;
         Slot d_root;
+        bool d_lazy;
     };
 }
 
@@ -31,6 +31,8 @@
 #include <QtGui/QHBoxLayout>
 #include <QtGui/QCheckBox>
 #include <QtGui/QProgressDialog>
+#include <QtGui/QInputDialog>
+#include <QtGui/QMessageBox>
 #include <Udb/Transaction.h>
 #include <Oln2/OutlineStream.h>
 #include <Oln2/OutlineItem.h>
@@ -39,6 +41,8 @@
 #include "WorkTreeApp.h"
 #include "TaskAttrDlg.h"
 #include "PdmItemObj.h"
+#include "NetCondenser.h"
+#include "CachePolicy.h"
 using namespace Wt;
 
 const char* ImpCtrl::s_mimeImp = "application/worktree/imp-data";
@@ -137,6 +141,7 @@ void ImpCtrl::addCommands( Gui2::AutoMenu * pop )
 	pop->addCommand( tr("Edit Name"), this, SLOT( onEditName() ) );
     pop->addCommand( tr("Edit Attributes..."), this, SLOT(onEditAttrs()), tr("CTRL+E"), true );
     pop->addCommand( tr("Recreate Diagrams..."), this, SLOT( onRecreateDiagrams() ) );
+    pop->addCommand( tr("Create Condensed Diagram..."), this, SLOT( onCondensedDiagram() ) );
     pop->addCommand( tr("Delete Items..."), this, SLOT( onDeleteItems() ), tr("CTRL+D"), true );
 }
 
@@ -336,6 +341,7 @@ void ImpCtrl::onRecreateDiagrams()
     progress.setAutoClose(false);
     progress.setValue( 1 );
     QApplication::setOverrideCursor( Qt::WaitCursor );
+	CachePolicy::Bulk bulk( getMdl()->getRoot().getDb() );
     foreach( Udb::Obj doc, docs )
     {
         if( !PdmItemObj::createDiagram( doc, true, layout.isChecked(), recursive.isChecked(),
@@ -346,6 +352,33 @@ void ImpCtrl::onRecreateDiagrams()
     QApplication::restoreOverrideCursor();
 }
 
+void ImpCtrl::onCondensedDiagram()
+{
+    Udb::Obj doc = getSelectedObject();
+    ENABLED_IF( WtTypeDefs::isPdmDiagram( doc.getType() ) );
+
+    bool ok;
+    const int depth = QInputDialog::getInt( getTree(), tr("Create Condensed Diagram - WorkTree"),
+                                            tr("Replace the diagram by a network condensed to task level\n"
+                                               "(0 = only the items directly contained in the diagram):"),
+                                            1, 0, 255, 1, &ok );
+    if( !ok )
+        return;
+    if( !PdmItemObj::s_layouter.prepareEngine( getTree() ) )
+        return;
+    QApplication::setOverrideCursor( Qt::WaitCursor );
+    NetCondenser c;
+    c.condense( doc, depth );
+    PdmItemObj::createCondensedDiagram( doc, c, true, true );
+    doc.getTxn()->commit();
+    QApplication::restoreOverrideCursor();
+    if( c.getUnmappedCount() != 0 )
+        QMessageBox::information( getTree(), tr("Create Condensed Diagram - WorkTree"),
+                                  tr("%1 links attached to summary tasks above level %2 could not be "
+                                     "assigned to a node and were left out.").
+                                  arg( c.getUnmappedCount() ).arg( depth ) );
+}
+
 void ImpCtrl::writeTo(const Udb::Obj &o, Stream::DataWriter &out) const
 {
     switch( o.getType() )
@@ -50,6 +50,7 @@ namespace Wt
         void onSetTaskType();
         void onEditAttrs();
         void onRecreateDiagrams();
+        void onCondensedDiagram();
     protected:
         void writeTo(const Udb::Obj & o, Stream::DataWriter &out) const;
         Udb::Obj readImpElement(Stream::DataReader & in, Udb::Obj &parent );
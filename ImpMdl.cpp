@@ -24,6 +24,7 @@ using namespace Wt;
 ImpMdl::ImpMdl(QObject *parent) :
     GenericMdl(parent)
 {
+    setLazy( true );
 }
 
 bool ImpMdl::isSupportedType(quint32 type)
@@ -18,6 +18,8 @@
 */
 
 #include "Indexer.h"
+#include "CachePolicy.h"
+#include "WorkerPool.h"
 #include <Oln2/OutlineItem.h>
 #include <Udb/Extent.h>
 #include <Udb/Database.h>
@@ -27,6 +29,10 @@
 #include <QApplication>
 #include <QProgressDialog>
 #include <QDir>
+#include <QThread>
+#include <QTimer>
+#include <QPointer>
+#include <QEventLoop>
 #include <private/qindexwriter_p.h>
 #include <private/qanalyzer_p.h>
 #include <private/qindexreader_p.h>
@@ -58,6 +64,59 @@ Udb::Atom Indexer::attrItemIsTitle = Oln::OutlineItem::AttrIsTitle;
 	TCHAR* _twhat;
   };
 
+static const int s_persistInterval = 60000; // ms, so lange bleiben Pendings nur im Speicher
+static const int s_blockSize = 4096; // OIDs pro persistiertem Pending-Block
+static const int s_bulkMin = 1000; // ab so vielen Pendings wie beim vollen Rebuild puffern
+
+// Bei Bulk Loads lohnen sich grosse Puffer; das Mergen der Segmente kostet mehr als der Speicher
+static void _tuneForBulk( QCLuceneIndexWriter& w )
+{
+	w.setMinMergeDocs( 5000 );
+	w.setMaxBufferedDocs( 5000 );
+	w.setMergeFactor( 50 );
+}
+
+static inline void _writeVarint( QByteArray& out, quint64 v )
+{
+	while( v >= 0x80 )
+	{
+		out.append( char( ( v & 0x7f ) | 0x80 ) );
+		v >>= 7;
+	}
+	out.append( char( v ) );
+}
+
+static inline bool _readVarint( const char*& p, const char* end, quint64& v )
+{
+	v = 0;
+	int shift = 0;
+	while( p < end && shift < 64 )
+	{
+		const quint8 b = quint8( *p++ );
+		v |= quint64( b & 0x7f ) << shift;
+		if( ( b & 0x80 ) == 0 )
+			return true;
+		shift += 7;
+	}
+	return false;
+}
+
+static inline void _addPending( QHash<Udb::OID,bool>& res, Udb::OID oid, bool reindex )
+{
+	// Lschen hat Vorrang; ein gelschtes Objekt kommt nicht wieder
+	if( !reindex )
+		res[oid] = false;
+	else if( !res.contains( oid ) )
+		res[oid] = true;
+}
+
+static void _addPendings( QHash<Udb::OID,bool>& res, const QHash<Udb::OID,bool>& other )
+{
+	QHash<Udb::OID,bool>::const_iterator i;
+	for( i = other.begin(); i != other.end(); ++i )
+		_addPending( res, i.key(), i.value() );
+}
+
 static bool toIndex( quint32 t )
 {
 	return true;
@@ -300,13 +359,29 @@ Udb::Obj Indexer::findText( const QString& pattern, const Udb::Obj& cur, bool fo
 
 const char* Indexer::s_pendingUuid = "{2D826784-B089-4e98-BBB0-F5E4F2F1AD78}";
 
-Indexer::Indexer( Udb::Transaction * txn, QObject *p ):QObject(p)
+Indexer::Indexer( Udb::Transaction * txn, QObject *p ):QObject(p),d_running(0),d_segmentsOk(true),
+	d_nextBlock(0),d_blocksKnown(false)
 {
     Q_ASSERT( txn != 0 );
 	QUuid uuid = s_pendingUuid;
 	d_pending = txn->getOrCreateObject( uuid );
 	txn->commit();
 	txn->addObserver( this, SLOT(onDbUpdate( Udb::UpdateInfo ) ), false );
+	d_lastPersist.start();
+}
+
+void Indexer::findNextBlock()
+{
+	// Erst beim ersten persistQueue statt im Konstruktor, damit der Programmstart nicht alle
+	// Pending-Zellen durchgehen muss
+	d_blocksKnown = true;
+	Udb::Mit mit = d_pending.findCells( Udb::Obj::KeyList() );
+	if( !mit.isNull() ) do
+	{
+		const Udb::Mit::KeyList k = mit.getKey();
+		if( isPendingBlock( k ) )
+			d_nextBlock = qMax( d_nextBlock, k[0].getUInt32() + 1 );
+	}while( mit.nextKey() );
 }
 
 QString Indexer::getIndexPath() const
@@ -360,152 +435,406 @@ static void indexItem( const Udb::Obj& obj, QCLuceneIndexWriter& w, QCLuceneAnal
         w.addDocument( ld, a );
 }
 
-static int calcCount2( const Udb::Obj& o )
+bool Indexer::isPendingBlock( const Udb::Obj::KeyList& k )
 {
-	int res = 0;
-    Udb::Mit i = o.findCells( Udb::Obj::KeyList() );
-    if( !i.isNull() ) do
-    {
-		Udb::Mit::KeyList k = i.getKey();
-		if( !k.isEmpty() && k[0].isOid() )
-			res++;
-	}while( i.nextKey() );
-	return res;
+	return k.size() == 1 && k[0].getType() == Stream::DataCell::TypeUInt32;
 }
 
 bool Indexer::hasPendingUpdates() const
 {
+	if( !d_queue.isEmpty() )
+		return true;
     Udb::Mit i = d_pending.findCells( Udb::Obj::KeyList() );
     Udb::Mit::KeyList k = i.getKey();
-    return !k.isEmpty() && k[0].isOid();
+    return !k.isEmpty() && ( k[0].isOid() || isPendingBlock( k ) );
+}
+
+void Indexer::persistQueue()
+{
+	// Sortierte OIDs in Blcken zu hchstens s_blockSize, pro OID varint( Delta << 1 | reindex )
+	if( d_queue.isEmpty() )
+		return;
+	if( !d_blocksKnown )
+		findNextBlock();
+	QList<Udb::OID> oids = d_queue.keys();
+	qSort( oids );
+	Udb::Obj::KeyList k(1);
+	for( int i = 0; i < oids.size(); i += s_blockSize )
+	{
+		QByteArray block;
+		Udb::OID prev = 0;
+		const int end = qMin( i + s_blockSize, oids.size() );
+		for( int j = i; j < end; j++ )
+		{
+			_writeVarint( block, ( ( oids[j] - prev ) << 1 ) | ( d_queue.value( oids[j] ) ? 1 : 0 ) );
+			prev = oids[j];
+		}
+		k[0].setUInt32( d_nextBlock++ );
+		d_pending.setCell( k, Stream::DataCell().setLob( block ) );
+	}
+	d_queue.clear();
+	d_lastPersist.restart();
 }
 
+void Indexer::flushPendings()
+{
+	if( d_queue.isEmpty() )
+		return;
+	persistQueue();
+	d_pending.commit();
+}
+
+void Indexer::collectPendings( Pendings& res, QList<Udb::Obj::KeyList>& cells ) const
+{
+	Udb::Mit mit = d_pending.findCells( Udb::Obj::KeyList() );
+	if( !mit.isNull() ) do
+	{
+		const Udb::Mit::KeyList k = mit.getKey();
+		cells.append( k );
+		if( k.size() == 1 && k[0].isOid() )
+			_addPending( res, k[0].getOid(), mit.getValue().getBool() ); // Format vor den Blcken
+		else if( isPendingBlock( k ) )
+		{
+			const QByteArray block = mit.getValue().getArr();
+			const char* p = block.constData();
+			const char* end = p + block.size();
+			Udb::OID oid = 0;
+			quint64 v;
+			while( p < end && _readVarint( p, end, v ) )
+			{
+				oid += v >> 1;
+				_addPending( res, oid, v & 1 );
+			}
+		}
+	}while( mit.nextKey() );
+}
+
+void Indexer::clearPendings( const QList<Udb::Obj::KeyList>& cells )
+{
+	// Blcke, die persistQueue whrend des Laufs geschrieben hat, haben neue Schlssel und bleiben
+	foreach( const Udb::Obj::KeyList& k, cells )
+		d_pending.setCell( k, Stream::DataCell().setNull() );
+}
+
+static inline bool _hasGui()
+{
+	return QApplication::type() != QApplication::Tty;
+}
+
+struct _WaitCursor
+{
+	_WaitCursor()
+	{
+		if( _hasGui() )
+		{
+			QApplication::setOverrideCursor( Qt::WaitCursor );
+			QApplication::processEvents();
+		}
+	}
+	~_WaitCursor()
+	{
+		if( _hasGui() )
+			QApplication::restoreOverrideCursor();
+	}
+};
+
+// Im Batch-Modus (QApplication ohne GUI) darf kein QProgressDialog erzeugt werden
+class _Progress
+{
+public:
+	_Progress( int max, QWidget* parent, bool immediate ):d_dlg(0),d_value(0)
+	{
+		if( !_hasGui() )
+			return;
+		d_dlg = new QProgressDialog( Indexer::tr("Indexing repository..."), Indexer::tr("Abort"), 0, max, parent );
+		if( immediate )
+			d_dlg->setMinimumDuration( 0 );
+		d_dlg->setWindowTitle( Indexer::tr( "WorkTree Search" ) );
+		d_dlg->setWindowModality(Qt::WindowModal);
+		d_dlg->setAutoClose( true );
+	}
+	~_Progress() { delete d_dlg; }
+	void setValue( int v ) { d_value = v; if( d_dlg ) d_dlg->setValue( v ); }
+	void step() { setValue( d_value + 1 ); }
+	bool wasCanceled() const { return d_dlg != 0 && d_dlg->wasCanceled(); }
+private:
+	QProgressDialog* d_dlg;
+	int d_value;
+};
+
 bool Indexer::indexIncrements( QWidget* parent )
 {
 	d_error.clear();
 	QString path = getIndexPath();
+	QList<Udb::Obj::KeyList> cells;
+	Pendings queued;
 	try
 	{
-		QApplication::setOverrideCursor( Qt::WaitCursor );
+		_WaitCursor cur;
+
+		// Persistierte Blcke und Warteschlange zusammengefasst; jede OID nur einmal.
+		// Die Warteschlange wird bernommen, damit nderungen whrend des Laufs darin bleiben.
+		Pendings pendings;
+		collectPendings( pendings, cells );
+		queued = d_queue;
+		d_queue.clear();
+		_addPendings( pendings, queued );
+		const int count = pendings.size() * 2; // je einmal delete und dann index
 		QApplication::processEvents();
+		_Progress progress( count, parent, false );
 
-		const int count = calcCount2( d_pending ) * 2; // je einmal delete und dann index
-		if( count == -1 )
-		{
-			QApplication::restoreOverrideCursor();
-			return false;
-		}
-		QApplication::processEvents();
-		QProgressDialog progress( tr("Indexing repository..."), tr("Abort"), 0, count, parent );
-		progress.setAutoClose( false );
-		// progress.setMinimumDuration( 0 );
-		progress.setWindowTitle( tr( "WorkTree Search" ) );
-		progress.setWindowModality(Qt::WindowModal);
-		progress.setAutoClose( true );
-
-        QList< QPair<Udb::OID,bool> > toHandle;
-        QList<Udb::Mit::KeyList> toRemove;
+		int done = 0;
+		Pendings::const_iterator i;
         { // Remove outdated documents
             QCLuceneIndexReader r = QCLuceneIndexReader::open( path );
-            Udb::Mit mit = d_pending.findCells( Udb::Obj::KeyList() );
-            if( !mit.isNull() ) do
-            {
-                Udb::Mit::KeyList k = mit.getKey();
-                if( k.size() == 1 && k[0].isOid() )
-                {
-                    const int done = r.deleteDocuments(QCLuceneTerm(QLatin1String("oid"),
-                                                   QString::number( k[0].getOid(), 16 ) ) );
-                    //qDebug() << "FullTextIndexer::indexIncrements: deleting document" << k[0].getOid() << done;
-                    toHandle.append( qMakePair(k[0].getOid(), mit.getValue().getBool() ) );
-                }else
-                {
-                    //qDebug() << "FullTextIndexer::indexIncrements: invalid key" << Udb::UpdateInfo::toString(k);
-                    toRemove.append( k );
-                }
-            }while( mit.nextKey() );
+			for( i = pendings.begin(); i != pendings.end(); ++i )
+			{
+				r.deleteDocuments(QCLuceneTerm(QLatin1String("oid"), QString::number( i.key(), 16 ) ) );
+				progress.setValue( ++done );
+			}
             r.close();
         }
         { // Reindex
             QCLuceneStandardAnalyzer a;
             QCLuceneIndexWriter w( path, a, false ); // true indiziert die ganze DB
-            w.setMinMergeDocs( 1000 );
-            w.setMaxBufferedDocs( 100 );
+			if( pendings.size() >= s_bulkMin )
+				_tuneForBulk( w );
+			else
+			{
+				w.setMinMergeDocs( 1000 );
+				w.setMaxBufferedDocs( 100 );
+			}
 
-            Udb::Mit::KeyList k(1);
-            for( int i = 0; i < toHandle.size(); i++ )
+			for( i = pendings.begin(); i != pendings.end(); ++i )
             {
-                const QPair<Udb::OID,bool>& p = toHandle[i];
-                if( p.second )
+				if( i.value() )
                 {
-                    Udb::Obj o = d_pending.getObject( p.first );
+					Udb::Obj o = d_pending.getObject( i.key() );
                     if( !o.isNull() )
                     {
                         // Text updated
                         indexItem( o, w, a );
                     }
-                    //qDebug() << "FullTextIndexer::indexIncrements: indexing document" << p.first;
                 }
-                k[0].setOid( p.first );
-                d_pending.setCell( k, Stream::DataCell().setNull() );
-                //qDebug() << "FullTextIndexer::indexIncrements: remove pending" << p.first;
-                progress.setValue( progress.value() + 1 );
+				progress.setValue( ++done );
                 if( progress.wasCanceled() )
                 {
+					// Die Pendings bleiben stehen; der nchste Lauf lscht und indiziert nochmals
                     w.close();
-                    QApplication::restoreOverrideCursor();
-                    d_pending.getTxn()->rollback();
+					_addPendings( d_queue, queued );
                     return false;
                 }
             }
-            foreach( const Udb::Mit::KeyList& kl, toRemove )
-                d_pending.setCell( kl, Stream::DataCell().setNull() );
-
         }
 		progress.setValue( count );
-		QApplication::restoreOverrideCursor();
+		clearPendings( cells );
 		d_pending.commit();
 		return true;
 	}catch( CLuceneError& e )
 	{
-		QApplication::restoreOverrideCursor();
 		d_error = QString::fromLatin1( e._awhat );
 		d_pending.getTxn()->rollback();
+		_addPendings( d_queue, queued );
 		return false;
 	}
 }
 
-static void deletePendings( Udb::Obj& o )
+static void _removeIndex( const QString& path )
 {
-    Udb::Mit i = o.findCells( Udb::Obj::KeyList() );
-    if( !i.isNull() ) do
-    {
-        Udb::Mit::KeyList k = i.getKey();
-        if( !k.isEmpty() && k[0].isOid() )
-            o.setCell( k, Stream::DataCell().setNull() );
-    }while( i.nextKey() );
+	QDir dir( path );
+	QStringList files = dir.entryList( QDir::Files );
+	for( int i = 0; i < files.size(); i++ )
+		dir.remove( files[i] );
+}
+
+static void _removeParts( const QStringList& parts )
+{
+	foreach( const QString& p, parts )
+	{
+		_removeIndex( p );
+		QDir().rmdir( p );
+	}
+}
+
+namespace Wt
+{
+	// Indiziert die Objekte im OID-Bereich [d_from,d_to) in ein eigenes Segment-Verzeichnis.
+	// Endet whrend des Laufs ein Commit, wird das Segment neu geschrieben.
+	class _SegmentTask : public WorkerTask
+	{
+	public:
+		QString d_path;
+		Udb::OID d_from, d_to;
+		QAtomicInt* d_done; // gemeinsamer Fortschritt in OIDs, gehrt indexParallel
+		int d_counted; // eigener Anteil an d_done
+		_SegmentTask( const QString& path, Udb::OID from, Udb::OID to, QAtomicInt* done ):
+			d_path(path),d_from(from),d_to(to),d_done(done),d_counted(0){}
+		bool restart()
+		{
+			d_done->fetchAndAddRelaxed( -d_counted );
+			d_counted = 0;
+			return true; // der Writer legt das Segment neu an
+		}
+		void compute( Udb::Transaction* snap )
+		{
+			try
+			{
+				LuceneAnalyzer a; // pro Thread, CLucene Analyzer sind nicht reentrant
+				QCLuceneIndexWriter w( d_path, a, true );
+				_tuneForBulk( w );
+				int step = 0;
+				for( Udb::OID oid = d_from; oid < d_to && !isCanceled(); oid++ )
+				{
+					Udb::Obj obj = snap->getObject( oid );
+					if( !obj.isNull( true ) )
+						indexItem( obj, w, a );
+					if( ++step == 256 )
+					{
+						d_done->fetchAndAddRelaxed( step );
+						d_counted += step;
+						step = 0;
+					}
+				}
+				d_done->fetchAndAddRelaxed( step );
+				d_counted += step;
+				w.close();
+			}catch( CLuceneError& e )
+			{
+				setError( QString::fromLatin1( e._awhat ) );
+			}
+		}
+	};
 }
 
 bool Indexer::indexRepository( QWidget* parent )
+{
+	// Bei vollem Index macht es keinen Sinn, die Pendings zu behalten; aber nur die vor dem Lauf
+	// vorhandenen, denn was whrend des Laufs gendert wird, ist eventuell schon indiziert.
+	QList<Udb::Obj::KeyList> cells;
+	Pendings ignored;
+	collectPendings( ignored, cells );
+	const Pendings queued = d_queue;
+	d_queue.clear();
+	const int n = QThread::idealThreadCount() - 1; // so viele Worker hat der WorkerPool
+	const bool ok = ( n > 1 ) ? indexParallel( parent, n ) : indexSequential( parent );
+	if( ok )
+	{
+		clearPendings( cells );
+		d_pending.commit();
+	}else
+		_addPendings( d_queue, queued );
+	return ok;
+}
+
+bool Indexer::indexParallel( QWidget* parent, int partitions )
+{
+	d_error.clear();
+	const QString path = getIndexPath();
+	const Udb::OID maxOid = d_pending.getDb()->getMaxOid();
+	QStringList parts;
+	QList<QCLuceneIndexReader*> readers;
+	try
+	{
+		_WaitCursor cur;
+		CachePolicy::Bulk bulk( d_pending.getDb() );
+		_Progress progress( maxOid, parent, true );
+
+		// Zusammenhngende OID-Bereiche, damit jeder Worker im Cache seiner Verbindung lokal bleibt
+		QAtomicInt done( 0 );
+		QList< QPointer<WorkerTask> > tasks;
+		WorkerPool* pool = WorkerPool::inst( getTxn() );
+		const Udb::OID chunk = maxOid / partitions + 1;
+		d_running = 0;
+		d_segmentsOk = true;
+		for( int i = 0; i < partitions; i++ )
+		{
+			const Udb::OID from = 1 + i * chunk;
+			if( from > maxOid )
+				break;
+			parts.append( path + QString( ".part%1" ).arg( i ) );
+			_SegmentTask* t = new _SegmentTask( parts.last(), from, qMin( from + chunk, maxOid + 1 ), &done );
+			connect( t, SIGNAL(finished(bool)), this, SLOT(onSegmentFinished(bool)) );
+			tasks.append( t );
+			d_running++;
+			pool->start( t );
+		}
+
+		// finished kommt queued auf dem GUI-Thread; der Timer weckt die Schleife fr den Fortschritt
+		QTimer timer;
+		timer.start( 100 );
+		QEventLoop loop;
+		bool canceled = false;
+		while( d_running > 0 )
+		{
+			loop.processEvents( QEventLoop::WaitForMoreEvents );
+			progress.setValue( int( done ) );
+			if( !canceled && progress.wasCanceled() )
+			{
+				canceled = true;
+				foreach( QPointer<WorkerTask> t, tasks )
+					if( t )
+						t->cancel();
+			}
+		}
+		if( canceled || !d_segmentsOk )
+		{
+			_removeParts( parts );
+			return false;
+		}
+
+		// Merge der Segmente; addIndexes optimiert den Zielindex bereits
+		LuceneAnalyzer a;
+		QCLuceneIndexWriter w( path, a, true );
+		_tuneForBulk( w );
+		foreach( const QString& p, parts )
+			readers.append( new QCLuceneIndexReader( QCLuceneIndexReader::open( p ) ) );
+		w.addIndexes( readers );
+		w.close();
+		foreach( QCLuceneIndexReader* r, readers )
+		{
+			r->close();
+			delete r;
+		}
+		readers.clear();
+		_removeParts( parts );
+		progress.setValue( maxOid );
+		return true;
+	}catch( CLuceneError& e )
+	{
+		d_error = QString::fromLatin1( e._awhat );
+		qDeleteAll( readers ); // z.B. wenn addIndexes scheitert
+		_removeParts( parts );
+		d_pending.getTxn()->rollback();
+		return false;
+	}
+}
+
+void Indexer::onSegmentFinished( bool ok )
+{
+	WorkerTask* t = static_cast<WorkerTask*>( sender() );
+	if( !ok )
+	{
+		d_segmentsOk = false;
+		if( d_error.isEmpty() )
+			d_error = t->getError();
+	}
+	d_running--;
+}
+
+bool Indexer::indexSequential( QWidget* parent )
 {
 	d_error.clear();
 	QString path = getIndexPath();
 	try
 	{
-		QApplication::setOverrideCursor( Qt::WaitCursor );
-		QApplication::processEvents();
+		_WaitCursor cur;
+		CachePolicy::Bulk bulk( d_pending.getDb() );
 		LuceneAnalyzer a;
 		QCLuceneIndexWriter w( path, a, true );
-		w.setMinMergeDocs( 1000 );
-		w.setMaxBufferedDocs( 100 );
+		_tuneForBulk( w );
 
 		QApplication::processEvents();
-		QProgressDialog progress( tr("Indexing repository..."), tr("Abort"), 0, 
-			d_pending.getDb()->getMaxOid(), parent );
-		progress.setAutoClose( false );
-		progress.setMinimumDuration( 0 );
-		progress.setWindowTitle( tr( "WorkTree Search" ) );
-		progress.setWindowModality(Qt::WindowModal);
-		progress.setAutoClose( true );
+		_Progress progress( d_pending.getDb()->getMaxOid(), parent, true );
 
 		Udb::Extent e( d_pending.getTxn() );
 		if( e.first() ) do
@@ -516,23 +845,14 @@ bool Indexer::indexRepository( QWidget* parent )
 			if( progress.wasCanceled() )
 			{
 				w.close();
-				QDir dir( path );
-				QStringList files = dir.entryList( QDir::Files );
-				for( int i = 0; i < files.size(); i++ )
-					dir.remove( files[i] );
-				QApplication::restoreOverrideCursor();
+				_removeIndex( path );
 				return false;
 			}
 		}while( e.next() );
 		progress.setValue( d_pending.getDb()->getMaxOid() );
-		// Bei vollem Index (z.B. bei Rebuild) macht es keinen Sinn, die Pendings zu behalten
-		deletePendings(d_pending);
-		d_pending.commit();
-		QApplication::restoreOverrideCursor();
 		return true;
 	}catch( CLuceneError& e )
 	{
-		QApplication::restoreOverrideCursor();
 		d_error = QString::fromLatin1( e._awhat );
 		d_pending.getTxn()->rollback();
 		return false;
@@ -592,29 +912,21 @@ void Indexer::onDbUpdate( Udb::UpdateInfo info )
 	if( info.d_kind != Udb::UpdateInfo::PreCommit || !exists() )
 		return;
 
-	// mache hier eine richtige Kopie da durch die vorliegende Funktion die Notification List
-	// ergnzt wird.
+	// Nur im Speicher sammeln; ein Objekt wird ber beliebig viele Commits nur einmal vorgemerkt.
+	// mache hier eine richtige Kopie da durch persistQueue die Notification List ergnzt wird.
 	QList<Udb::UpdateInfo> updates = d_pending.getTxn()->getPendingNotifications();
-	Udb::Obj::KeyList k(1);
 	for( int i = 0; i < updates.size(); i++ )
 	{
 		const Udb::UpdateInfo& upd = updates[i];
 		if( upd.d_kind == Udb::UpdateInfo::ValueChanged )
 		{
 			if( upd.d_name == attrText || upd.d_name == attrInternalId || upd.d_name == attrCustomId )
-			{
-				k[0].setOid( upd.d_id );
-				if( d_pending.getCell( k ).isNull() )
-					d_pending.setCell( k, Stream::DataCell().setBool( true ) );
-				// NOTE: kein commit, da in Pre-Commit der Transaction, wo die nderung stattfand
-				//qDebug() << "FullTextIndexer::onDbUpdate:" << upd.toString() << HeTypeDefs::prettyName( upd.d_name );
-			}
+				_addPending( d_queue, upd.d_id, true );
 		}else if( upd.d_kind == Udb::UpdateInfo::ObjectErased )
-		{
-			k[0].setOid( upd.d_id );
-            d_pending.setCell( k, Stream::DataCell().setBool( false ) );
-            // NOTE: kein commit, da in Pre-Commit der Transaction, wo die nderung stattfand
-			//qDebug() << "FullTextIndexer::onDbUpdate:" << upd.toString() << HeTypeDefs::prettyName( upd.d_name );
-		}
+			_addPending( d_queue, upd.d_id, false );
     }
+	// Periodisch als Teil des laufenden Commits persistieren; kein eigener Commit ntig
+	// NOTE: bei einem Absturz gehen hchstens die Pendings seit dem letzten persistQueue verloren
+	if( !d_queue.isEmpty() && d_lastPersist.elapsed() > s_persistInterval )
+		persistQueue();
 }
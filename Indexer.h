@@ -22,6 +22,8 @@
 
 #include <Udb/Obj.h>
 #include <QList>
+#include <QHash>
+#include <QTime>
 #include <Udb/UpdateInfo.h>
 
 class QWidget;
@@ -56,21 +58,39 @@ namespace Wt
 		static Udb::Obj gotoNext( const Udb::Obj& obj );
 		static Udb::Obj gotoPrev( const Udb::Obj& obj );
 		static Udb::Obj gotoLast( const Udb::Obj& obj ); // zuunterst
+		static bool isPendingBlock( const Udb::Obj::KeyList& ); // Zelle mit persistierten Pendings
 
 		Indexer( Udb::Transaction*, QObject* p );
 		bool exists();
 		bool hasPendingUpdates() const;
-		bool indexRepository( QWidget* ); // Blocking
+		bool indexRepository( QWidget* ); // Blocking; parallel falls mehrere Cores
 		bool indexIncrements( QWidget* ); // Blocking
+		void flushPendings(); // persistiert die Warteschlange mit commit; beim Schliessen aufrufen
 		const QString& getError() const { return d_error; }
 		bool query( const QString& query, ResultList& result );
         QString getIndexPath() const;
         Udb::Transaction* getTxn() const { return d_pending.getTxn(); }
 	protected slots:
 		void onDbUpdate( Udb::UpdateInfo );
+		void onSegmentFinished( bool );
 	private:
+		typedef QHash<Udb::OID,bool> Pendings; // true..neu indizieren, false..nur aus dem Index lschen
+		void persistQueue(); // ohne commit
+		void findNextBlock();
+		// liest die persistierten Pendings; cells erhlt alle gelesenen Zellen, auch ungltige
+		void collectPendings( Pendings&, QList<Udb::Obj::KeyList>& cells ) const;
+		// entfernt nur die gelesenen Zellen; was whrend des Laufs dazukam, bleibt stehen
+		void clearPendings( const QList<Udb::Obj::KeyList>& cells );
+		bool indexSequential( QWidget* );
+		bool indexParallel( QWidget*, int partitions );
 		QString d_error;
 		Udb::Obj d_pending;
+		int d_running; // laufende Segment-Tasks von indexParallel
+		bool d_segmentsOk;
+		Pendings d_queue; // nderungen seit dem letzten persistQueue, nur im Speicher
+		QTime d_lastPersist;
+		quint32 d_nextBlock;
+		bool d_blocksKnown; // d_nextBlock ist gltig
 	};
 }
 
@@ -0,0 +1,264 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "LuaProfiler.h"
+#include <Script/Engine2.h>
+#include <QtAlgorithms>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+using namespace Wt;
+
+static char s_key; // Adresse dient als Registry-Schlüssel
+static const int s_sampleFrames = 3;
+
+static qint64 _now()
+{
+	// Mikrosekunden; QTime hat nur Millisekunden und wäre für einzelne Binding-Aufrufe zu grob
+#ifdef _WIN32
+	LARGE_INTEGER f, c;
+	::QueryPerformanceFrequency( &f );
+	::QueryPerformanceCounter( &c );
+	return ( c.QuadPart / f.QuadPart ) * 1000000 + ( c.QuadPart % f.QuadPart ) * 1000000 / f.QuadPart;
+#else
+	timeval tv;
+	::gettimeofday( &tv, 0 );
+	return qint64( tv.tv_sec ) * 1000000 + tv.tv_usec;
+#endif
+}
+
+LuaProfiler::LuaProfiler(lua_State * L, int sampleInterval):d_ctx(L),d_sampleCount(0),d_end(0),d_running(true)
+{
+	Q_ASSERT( L != 0 );
+	d_oldHook = lua_gethook( L );
+	d_oldMask = lua_gethookmask( L );
+	d_oldCount = lua_gethookcount( L );
+	lua_pushlightuserdata( L, &s_key );
+	lua_pushlightuserdata( L, this );
+	lua_rawset( L, LUA_REGISTRYINDEX );
+	d_begin = _now();
+	lua_sethook( L, hook, LUA_MASKCALL | LUA_MASKRET | LUA_MASKCOUNT, qMax( 1, sampleInterval ) );
+}
+
+LuaProfiler::~LuaProfiler()
+{
+	stop();
+}
+
+void LuaProfiler::stop()
+{
+	if( !d_running )
+		return;
+	d_running = false;
+	d_end = _now();
+	lua_sethook( d_ctx, d_oldHook, d_oldMask, d_oldCount );
+	lua_pushlightuserdata( d_ctx, &s_key );
+	lua_pushnil( d_ctx );
+	lua_rawset( d_ctx, LUA_REGISTRYINDEX );
+	d_stack.clear();
+}
+
+static int _depth( lua_State* L )
+{
+	// lua_getstack ist linear in der Tiefe, darum exponentielle und dann binäre Suche
+	lua_Debug ar;
+	int hi = 1;
+	while( lua_getstack( L, hi, &ar ) )
+		hi *= 2;
+	int lo = hi / 2;
+	while( hi - lo > 1 )
+	{
+		const int m = ( lo + hi ) / 2;
+		if( lua_getstack( L, m, &ar ) )
+			lo = m;
+		else
+			hi = m;
+	}
+	return lo + 1;
+}
+
+void LuaProfiler::hook(lua_State * L, lua_Debug * ar)
+{
+	lua_pushlightuserdata( L, &s_key );
+	lua_rawget( L, LUA_REGISTRYINDEX );
+	LuaProfiler* p = (LuaProfiler*)lua_touserdata( L, -1 );
+	lua_pop( L, 1 );
+	if( p == 0 )
+		return;
+	switch( ar->event )
+	{
+	case LUA_HOOKCALL:
+		p->onCall( L, ar );
+		break;
+	case LUA_HOOKRET:
+		p->onReturn( L );
+		break;
+	case LUA_HOOKTAILRET:
+		// Lua 5.1: je ein Ereignis pro durch Tail Call ersetzten Frame; diese Frames hat
+		// onCall des Tail Calls auf derselben Tiefe bereits abgeschlossen
+		break;
+	case LUA_HOOKCOUNT:
+		p->onCount( L, ar );
+		break;
+	}
+}
+
+void LuaProfiler::onCall(lua_State * L, lua_Debug * ar)
+{
+	lua_getinfo( L, "Snf", ar );
+	int e;
+	if( ar->what[0] == 'C' )
+	{
+		const void* f = (const void*)lua_tocfunction( L, -1 );
+		e = d_byFunc.value( f, -1 );
+		if( e == -1 )
+		{
+			e = d_entries.size();
+			d_byFunc.insert( f, e );
+			d_entries.append( Entry() );
+			d_entries[e].d_native = true;
+		}
+		if( d_entries[e].d_name.isEmpty() && ar->name != 0 )
+			d_entries[e].d_name = QByteArray( ar->name ) + " [C]";
+	}else
+	{
+		// Closures desselben Prototyps zusammenfassen
+		const QByteArray name = ( ar->what[0] == 'm' ) ? QByteArray( ar->short_src ) + ":main" :
+			QByteArray( ar->short_src ) + ':' + QByteArray::number( ar->linedefined );
+		e = d_byName.value( name, -1 );
+		if( e == -1 )
+		{
+			e = d_entries.size();
+			d_byName.insert( name, e );
+			d_entries.append( Entry() );
+			d_entries[e].d_name = name;
+			if( ar->name != 0 )
+				d_entries[e].d_name += QByteArray( " " ) + ar->name;
+		}
+	}
+	lua_pop( L, 1 ); // function von "f"
+	d_entries[e].d_calls++;
+	Frame f;
+	f.d_entry = e;
+	f.d_children = 0;
+	f.d_depth = _depth( L );
+	f.d_start = _now();
+	// Frames auf gleicher oder grösserer Tiefe sind per Fehler oder Tail Call verschwunden
+	popFrames( f.d_depth, f.d_start );
+	d_stack.append( f );
+}
+
+void LuaProfiler::popFrames(int depth, qint64 now)
+{
+	while( !d_stack.isEmpty() && d_stack.last().d_depth >= depth )
+	{
+		const Frame f = d_stack.last();
+		d_stack.pop_back();
+		const qint64 elapsed = now - f.d_start;
+		Entry& e = d_entries[f.d_entry];
+		e.d_totalMs += elapsed / 1000.0; // bei Rekursion mehrfach gezählt
+		e.d_selfMs += ( elapsed - f.d_children ) / 1000.0;
+		if( !d_stack.isEmpty() )
+			d_stack.last().d_children += elapsed;
+	}
+}
+
+void LuaProfiler::onReturn(lua_State * L)
+{
+	// Fehlt der Frame, lag der Aufruf vor dem Start des Profilers
+	popFrames( _depth( L ), _now() );
+}
+
+void LuaProfiler::onCount(lua_State * L, lua_Debug * ar)
+{
+	lua_getinfo( L, "Sl", ar );
+	if( ar->currentline < 0 )
+		return; // C-Funktion
+	QByteArray where = QByteArray( ar->short_src ) + ':' + QByteArray::number( ar->currentline );
+	lua_Debug caller;
+	for( int level = 1; level < s_sampleFrames && lua_getstack( L, level, &caller ); level++ )
+	{
+		lua_getinfo( L, "Sl", &caller );
+		if( caller.currentline < 0 )
+			where += " < [C]";
+		else
+			where += " < " + QByteArray( caller.short_src ) + ':' + QByteArray::number( caller.currentline );
+	}
+	d_samples[ where ]++;
+	d_sampleCount++;
+}
+
+static bool _bySelf( const LuaProfiler::Entry& lhs, const LuaProfiler::Entry& rhs )
+{
+	return lhs.d_selfMs > rhs.d_selfMs;
+}
+
+QList<LuaProfiler::Entry> LuaProfiler::getEntries() const
+{
+	QList<Entry> res = d_entries.toList();
+	for( int i = 0; i < res.size(); i++ )
+		if( res[i].d_name.isEmpty() )
+			res[i].d_name = "? [C]";
+	qSort( res.begin(), res.end(), _bySelf );
+	return res;
+}
+
+static bool _byCount( const LuaProfiler::Sample& lhs, const LuaProfiler::Sample& rhs )
+{
+	return lhs.d_count > rhs.d_count;
+}
+
+QList<LuaProfiler::Sample> LuaProfiler::getSamples() const
+{
+	QList<Sample> res;
+	QHash<QByteArray,quint32>::const_iterator i;
+	for( i = d_samples.begin(); i != d_samples.end(); ++i )
+	{
+		Sample s;
+		s.d_where = i.key();
+		s.d_count = i.value();
+		res.append( s );
+	}
+	qSort( res.begin(), res.end(), _byCount );
+	return res;
+}
+
+double LuaProfiler::getElapsedMs() const
+{
+	return ( ( d_running ) ? _now() : d_end ) / 1000.0 - d_begin / 1000.0;
+}
+
+QString LuaProfiler::toString(int top) const
+{
+	QString res = QString( "Lua profile: %1 ms, %2 samples\n" ).arg( getElapsedMs(), 0, 'f', 1 ).
+			arg( d_sampleCount );
+	const QList<Entry> entries = getEntries();
+	res += "self ms\ttotal ms\tcalls\tfunction\n";
+	for( int i = 0; i < entries.size() && i < top; i++ )
+		res += QString( "%1\t%2\t%3\t%4\n" ).arg( entries[i].d_selfMs, 0, 'f', 2 ).
+				arg( entries[i].d_totalMs, 0, 'f', 2 ).arg( entries[i].d_calls ).
+				arg( QString::fromUtf8( entries[i].d_name ) );
+	const QList<Sample> samples = getSamples();
+	res += "samples\tline < callers\n";
+	for( int i = 0; i < samples.size() && i < top; i++ )
+		res += QString( "%1\t%2\n" ).arg( samples[i].d_count ).arg( QString::fromUtf8( samples[i].d_where ) );
+	return res;
+}
@@ -0,0 +1,96 @@
+#ifndef LUAPROFILER_H
+#define LUAPROFILER_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QString>
+
+typedef struct lua_State lua_State;
+struct lua_Debug;
+
+namespace Wt
+{
+	// Opt-in Profiler für eine Script-Ausführung: solange die Instanz lebt, misst ein
+	// Call/Return-Hook Anzahl, Gesamt- und Eigenzeit aller aufgerufenen Funktionen (C-Funktionen
+	// der Bindings wie Lua-Funktionen), und ein Count-Hook zählt alle sampleInterval Instruktionen
+	// die aktuelle Script-Zeile samt den Zeilen der zwei Aufrufer. Frames, die ein Fehler
+	// (pcall, error) ohne Return-Ereignis abräumt, werden anhand der Stacktiefe beim nächsten
+	// Call oder Return abgeschlossen. Ein vorher gesetzter Hook (z.B. Debugger) wird im Destruktor
+	// wiederhergestellt. Die Hooks selber kosten Zeit; die Werte sind relativ zu lesen.
+	class LuaProfiler
+	{
+	public:
+		struct Entry
+		{
+			QByteArray d_name; // "name [C]" oder "source:line"
+			quint32 d_calls;
+			double d_totalMs; // inklusive aufgerufener Funktionen
+			double d_selfMs;
+			bool d_native;
+			Entry():d_calls(0),d_totalMs(0),d_selfMs(0),d_native(false){}
+		};
+		struct Sample
+		{
+			QByteArray d_where; // source:line < aufrufer:line < aufrufer:line
+			quint32 d_count;
+		};
+		LuaProfiler( lua_State*, int sampleInterval = 1000 );
+		~LuaProfiler();
+		void stop(); // Hook entfernen; danach sind die Ergebnisse stabil
+
+		QList<Entry> getEntries() const; // nach Eigenzeit absteigend
+		QList<Sample> getSamples() const; // nach Anzahl absteigend
+		quint32 getSampleCount() const { return d_sampleCount; }
+		double getElapsedMs() const;
+		QString toString( int top = 20 ) const;
+	private:
+		static void hook( lua_State*, lua_Debug* );
+		void onCall( lua_State*, lua_Debug* );
+		void onReturn( lua_State* );
+		void onCount( lua_State*, lua_Debug* );
+		struct Frame
+		{
+			int d_entry; // Index in d_entries
+			qint64 d_start; // Mikrosekunden
+			qint64 d_children;
+			int d_depth; // Anzahl aktiver Lua-Frames inklusive diesem
+		};
+		void popFrames( int depth, qint64 now ); // schliesst alle Frames mit d_depth >= depth
+		lua_State* d_ctx;
+		QHash<const void*,int> d_byFunc; // C-Funktion -> d_entries
+		QHash<QByteArray,int> d_byName; // source:linedefined -> d_entries
+		QVector<Entry> d_entries;
+		QVector<Frame> d_stack;
+		QHash<QByteArray,quint32> d_samples;
+		quint32 d_sampleCount;
+		qint64 d_begin;
+		qint64 d_end;
+		// vorheriger Hook
+		void (*d_oldHook)( lua_State*, lua_Debug* );
+		int d_oldMask;
+		int d_oldCount;
+		bool d_running;
+	};
+}
+
+#endif // LUAPROFILER_H
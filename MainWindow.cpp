@@ -46,9 +46,30 @@
 #include "SearchView.h"
 #include "WbsCtrl.h"
 #include "MspImporter.h"
+#include "MspdiImporter.h"
+#include "ScheduleExporter.h"
 #include "FolderCtrl.h"
 #include "WpViewCtrl.h"
 #include "CalendarEditor.h"
+#include "Baseline.h"
+#include "StatusTrend.h"
+#include "ObjectHelper.h"
+#include "StartupProfile.h"
+#include "CachePolicy.h"
+#include "GarbageCollector.h"
+#include "ScriptRunner.h"
+#include "LuaProfiler.h"
+#include "WorkerPool.h"
+#include "QuickOpenDlg.h"
+#include <QtGui/QInputDialog>
+#include <QtGui/QFileDialog>
+#include <QtGui/QStatusBar>
+#include <QtGui/QDialog>
+#include <QtGui/QTabWidget>
+#include <QtGui/QTreeWidget>
+#include <QtGui/QVBoxLayout>
+#include <QtGui/QLabel>
+#include <QtCore/QTimer>
 #include <QtDebug>
 #include <Script/CodeEditor.h>
 #include <Script/Terminal2.h>
@@ -82,9 +103,11 @@ static inline QDockWidget* createDock( QMainWindow* parent, const QString& title
 	return dock;
 }
 
-MainWindow::MainWindow(Udb::Transaction * txn):d_txn(txn),d_pushBackLock(false),d_selectLock(false),d_fullScreen(false)
+MainWindow::MainWindow(Udb::Transaction * txn):d_txn(txn),d_term(0),d_pushBackLock(false),d_selectLock(false),
+	d_fullScreen(false),d_starting(true),d_painted(false),d_luaReady(false)
 {
     Q_ASSERT( txn != 0 );
+	StartupProfile* prof = StartupProfile::inst();
 
 	d_tab = new Oln::DocTabWidget( this, false );
 	d_tab->setCloserIcon( ":/images/close.png" );
@@ -99,17 +122,29 @@ MainWindow::MainWindow(Udb::Transaction * txn):d_txn(txn),d_pushBackLock(false),
 	setCorner( Qt::TopLeftCorner, Qt::TopDockWidgetArea );
 
     setupAttrView();
+	prof->mark( "setup attribute view" );
     setupTextView();
+	prof->mark( "setup text view" );
     setupImp();
+	prof->mark( "setup IMP" );
     setupOverview();
+	prof->mark( "setup overview" );
     setupLinkView();
+	prof->mark( "setup link view" );
     setupAssigView();
+	prof->mark( "setup assignment view" );
     setupObs();
+	prof->mark( "setup OBS" );
     setupWbs();
+	prof->mark( "setup WBS" );
     setupSearchView();
+	prof->mark( "setup search view" );
     setupFolders();
+	prof->mark( "setup folders" );
     setupWbView();
+	prof->mark( "setup work package view" );
 	setupTerminal();
+	prof->mark( "setup terminal" );
 #ifdef _WIN32
     d_msp = new MspImporter( this );
 #endif
@@ -121,6 +156,7 @@ MainWindow::MainWindow(Udb::Transaction * txn):d_txn(txn),d_pushBackLock(false),
 		d_txn->getDb()->getDbUuid().toString() ); // Da DB-individuelle Docks
 	if( !state.isNull() )
 		restoreState( state.toByteArray() );
+	prof->mark( "restore state" );
 
     if( WorkTreeApp::inst()->getSet()->value( "MainFrame/State/FullScreen" ).toBool() )
     {
@@ -150,6 +186,7 @@ MainWindow::MainWindow(Udb::Transaction * txn):d_txn(txn),d_pushBackLock(false),
     addTopCommands( pop );
     new Gui2::AutoShortcut( tr("F11"), this, this, SLOT(onFullScreen()) );
     new Gui2::AutoShortcut( tr("CTRL+F"), this, this, SLOT(onSearch()) );
+    new Gui2::AutoShortcut( tr("CTRL+P"), this, this, SLOT(onQuickOpen()) );
     new Gui2::AutoShortcut( tr("CTRL+Q"), this, this, SLOT(close()) );
     new Gui2::AutoShortcut( tr("ALT+LEFT"), this,  this, SLOT(onGoBack()) );
     new Gui2::AutoShortcut( tr("ALT+RIGHT"), this,  this, SLOT(onGoForward()) );
@@ -158,6 +195,8 @@ MainWindow::MainWindow(Udb::Transaction * txn):d_txn(txn),d_pushBackLock(false),
     new Gui2::AutoShortcut( tr("ALT+HOME"), this,  this, SLOT(onFollowAlias()) );
 
 	onFollowObject( WtTypeDefs::getRoot(d_txn).getValueAsObj(AttrAutoOpen) );
+	prof->mark( "show window" );
+	// Die sichtbaren Docks werden erst nach dem ersten paintEvent gefüllt
 }
 
 void MainWindow::setCaption()
@@ -186,6 +225,7 @@ void MainWindow::addTopCommands(Gui2::AutoMenu * pop)
     sub->addCommand( tr("Back"),  this, SLOT(onGoBack()), tr("ALT+LEFT") );
     sub->addCommand( tr("Forward"), this, SLOT(onGoForward()), tr("ALT+RIGHT") );
     pop->addCommand( tr("Search..."),  this, SLOT(onSearch()), tr("CTRL+F") );
+    pop->addCommand( tr("Quick Open..."),  this, SLOT(onQuickOpen()), tr("CTRL+P") );
     pop->addSeparator();
     QMenu* sub2 = createPopupMenu();
 	sub2->setTitle( tr("Show Window") );
@@ -197,6 +237,8 @@ void MainWindow::addTopCommands(Gui2::AutoMenu * pop)
 	sub->addCommand( tr("Calendars..."), this, SLOT(onCalendars()) );
     sub->addCommand( tr("Full Screen"), this, SLOT(onFullScreen()), tr("F11") )->setCheckable(true);
 
+    pop->addCommand( tr("Diagnostics..."), this, SLOT(onDiagnostics()) );
+	pop->addCommand( tr("Collect Garbage"), this, SLOT(onCollectGarbage()) );
     pop->addCommand( tr("About WorkTree..."), this, SLOT(onAbout()) );
     pop->addSeparator();
     pop->addAction( tr("Quit"), this, SLOT(close()), tr("CTRL+Q") );
@@ -331,6 +373,10 @@ void MainWindow::openScript(const Udb::Obj &doc)
 
 	Gui2::AutoMenu* pop = new Gui2::AutoMenu( e, true );
 	pop->addCommand( "&Execute",this, SLOT(handleExecute()), tr("CTRL+E"), true );
+	pop->addCommand( "Execute in Background",this, SLOT(handleExecuteInBackground()), tr("CTRL+SHIFT+E"), true );
+	pop->addCommand( "Execute in Background with Write-back",this, SLOT(handleExecuteWithWriteBack()) );
+	pop->addCommand( "Cancel Background Script",this, SLOT(handleCancelScript()) );
+	pop->addCommand( "Profile Execution",this, SLOT(onProfileScripts()) )->setCheckable(true);
 	pop->addSeparator();
 	pop->addCommand( "Undo", e, SLOT(handleEditUndo()), tr("CTRL+Z"), true );
 	pop->addCommand( "Redo", e, SLOT(handleEditRedo()), tr("CTRL+Y"), true );
@@ -380,7 +426,8 @@ void MainWindow::pushBack(const Udb::Obj & o)
         return;
     if( o.isNull( true, true ) )
         return;
-	Wt::LuaBinding::setCurrentObject( o );
+	if( d_luaReady )
+		Wt::LuaBinding::setCurrentObject( o );
 	if( !d_backHisto.isEmpty() && d_backHisto.last() == o.getOid() )
         return; // o ist bereits oberstes Element auf dem Stack.
     d_backHisto.removeAll( o.getOid() );
@@ -400,12 +447,19 @@ void MainWindow::setupImp()
     Udb::Obj root = d_txn->getOrCreateObject( QUuid(WorkTreeApp::s_imp), TypeIMP );
     root.setString( AttrText, WtTypeDefs::prettyName( TypeIMP ) );
 	d_txn->commit();
-    d_imp = ImpCtrl::create( dock, root );
+    d_imp = ImpCtrl::create( dock, Udb::Obj() );
+	d_imp->setRoot( root, true );
+	defer( dock, d_imp, "populate" );
     Gui2::AutoMenu* pop = new Gui2::AutoMenu( d_imp->getTree(), true );
     pop->addCommand( tr("Open Diagram"), this, SLOT(onOpenPdmDiagram()) );
     pop->addSeparator();
     d_imp->addCommands( pop );
     pop->addCommand( tr("Import MS Project..."), this, SLOT(onImportMsp() ) );
+    pop->addCommand( tr("Import MS Project XML..."), this, SLOT(onImportMspdi() ) );
+    pop->addCommand( tr("Export Schedule..."), this, SLOT(onExportSchedule() ) );
+    pop->addCommand( tr("Create Baseline..."), this, SLOT(onCreateBaseline() ) );
+    pop->addCommand( tr("Record Status Cycle"), this, SLOT(onRecordStatusCycle() ) );
+    pop->addCommand( tr("Convert SVTs to Lags..."), this, SLOT(onCollapseSvts() ) );
     addTopCommands( pop );
     connect( d_imp, SIGNAL(signalSelected(Udb::Obj)), this, SLOT(onImpSelected(Udb::Obj)) );
     connect( d_imp, SIGNAL(signalDblClicked(Udb::Obj)), this, SLOT( onImpDblClicked(Udb::Obj)));
@@ -420,7 +474,9 @@ void MainWindow::setupObs()
     Udb::Obj root = d_txn->getOrCreateObject( QUuid(WorkTreeApp::s_obs), TypeOBS );
     root.setString( AttrText, WtTypeDefs::prettyName( TypeOBS ) );
 	d_txn->commit();
-    d_obs = ObsCtrl::create( dock, root );
+    d_obs = ObsCtrl::create( dock, Udb::Obj() );
+	d_obs->setRoot( root, true );
+	defer( dock, d_obs, "populate" );
     Gui2::AutoMenu* pop = new Gui2::AutoMenu( d_obs->getTree(), true );
     d_obs->addCommands( pop );
     addTopCommands( pop );
@@ -436,7 +492,9 @@ void MainWindow::setupWbs()
     Udb::Obj root = d_txn->getOrCreateObject( QUuid(WorkTreeApp::s_wbs), TypeWBS );
     root.setString( AttrText, WtTypeDefs::prettyName( TypeWBS ) );
 	d_txn->commit();
-    d_wbs = WbsCtrl::create( dock, root );
+    d_wbs = WbsCtrl::create( dock, Udb::Obj() );
+	d_wbs->setRoot( root, true );
+	defer( dock, d_wbs, "populate" );
     Gui2::AutoMenu* pop = new Gui2::AutoMenu( d_wbs->getTree(), true );
     d_wbs->addCommands( pop );
     addTopCommands( pop );
@@ -477,6 +535,8 @@ void MainWindow::setupLinkView()
 {
     QDockWidget* dock = createDock( this, tr("Links"), 0, true );
     d_lv = PdmLinkViewCtrl::create( dock, d_txn );
+	d_lv->setDeferred( true );
+	defer( dock, d_lv, "populate" );
     Gui2::AutoMenu* pop = new Gui2::AutoMenu( d_lv->getWidget(), true );
     d_lv->addCommands( pop );
     connect( d_lv, SIGNAL(signalSelect(Udb::Obj,bool)), this, SLOT(onLinkSelected(Udb::Obj,bool)) );
@@ -489,6 +549,8 @@ void MainWindow::setupAssigView()
 {
     QDockWidget* dock = createDock( this, tr("Assignments"), 0, true );
     d_asv = AssigViewCtrl::create( dock, d_txn );
+	d_asv->setDeferred( true );
+	defer( dock, d_asv, "populate" );
     Gui2::AutoMenu* pop = new Gui2::AutoMenu( d_asv->getWidget(), true );
     d_asv->addCommands( pop );
     connect( d_asv, SIGNAL(signalSelect(Udb::Obj,bool)), this, SLOT(onAssigSelected(Udb::Obj,bool)) );
@@ -524,7 +586,9 @@ void MainWindow::setupFolders()
     Udb::Obj root = d_txn->getOrCreateObject( QUuid(WorkTreeApp::s_folders), TypeRootFolder );
     root.setString( AttrText, WtTypeDefs::prettyName( TypeRootFolder ) );
 	d_txn->commit();
-    d_fldr = FolderCtrl::create( dock, root );
+    d_fldr = FolderCtrl::create( dock, Udb::Obj() );
+	d_fldr->setRoot( root, true );
+	defer( dock, d_fldr, "populate" );
     Gui2::AutoMenu* pop = new Gui2::AutoMenu( d_fldr->getTree(), true );
     pop->addCommand( tr("Open Document"), this, SLOT(onOpenDocument()) );
     pop->addSeparator();
@@ -541,6 +605,8 @@ void MainWindow::setupWbView()
     QDockWidget* dock = createDock( this, tr("Work Package"), 0, true );
 
     d_wpv = WpViewCtrl::create( dock, d_txn );
+	d_wpv->setDeferred( true );
+	defer( dock, d_wpv, "populate" );
     Gui2::AutoMenu* pop = new Gui2::AutoMenu( d_wpv->getWidget(), true );
     d_wpv->addCommands( pop );
     addTopCommands( pop );
@@ -551,10 +617,102 @@ void MainWindow::setupWbView()
 
 void MainWindow::setupTerminal()
 {
-	QDockWidget* dock = createDock( this, tr("Lua Terminal"), 0, false );
-	Lua::Terminal2* term = new Lua::Terminal2( dock );
-	dock->setWidget( term );
-	addDockWidget( Qt::BottomDockWidgetArea, dock );
+	d_term = createDock( this, tr("Lua Terminal"), 0, false );
+	addDockWidget( Qt::BottomDockWidgetArea, d_term );
+	defer( d_term, this, "createTerminal" );
+}
+
+void MainWindow::createTerminal()
+{
+	Q_ASSERT( d_term != 0 );
+	if( d_term->widget() != 0 )
+		return;
+	initLua();
+	Lua::Terminal2* term = new Lua::Terminal2( d_term );
+	d_term->setWidget( term );
+}
+
+void MainWindow::initLua()
+{
+	if( d_luaReady )
+		return;
+	d_luaReady = true;
+	if( Lua::Engine2::getInst() == 0 )
+		WorkTreeApp::initLua(); // beim ersten Fenster
+	Wt::LuaBinding::setRepository( Lua::Engine2::getInst()->getCtx(), d_txn );
+	if( !d_backHisto.isEmpty() )
+		Wt::LuaBinding::setCurrentObject( d_txn->getObject( d_backHisto.last() ) );
+	StartupProfile::inst()->mark( "Lua engine" );
+}
+
+void MainWindow::defer(QDockWidget * dock, QObject * receiver, const char * slot)
+{
+	d_deferred[dock] = qMakePair( receiver, QByteArray( slot ) );
+	connect( dock, SIGNAL(visibilityChanged(bool)), this, SLOT(onDockVisibility(bool)) );
+}
+
+void MainWindow::populate(QDockWidget * dock)
+{
+	if( !d_deferred.contains( dock ) )
+		return;
+	const QPair<QObject*,QByteArray> p = d_deferred.take( dock );
+	QApplication::setOverrideCursor( Qt::WaitCursor );
+	QMetaObject::invokeMethod( p.first, p.second.constData() );
+	QApplication::restoreOverrideCursor();
+	StartupProfile::inst()->mark( QString("populate %1").arg( dock->windowTitle() ) );
+}
+
+void MainWindow::onDockVisibility(bool visible)
+{
+	if( !visible || d_starting )
+		return; // während dem Start erledigt onStartupStep die sichtbaren Docks
+	populate( qobject_cast<QDockWidget*>( sender() ) );
+}
+
+void MainWindow::onStartupStep()
+{
+	if( !d_starting )
+		return;
+	QHash<QDockWidget*,QPair<QObject*,QByteArray> >::const_iterator i;
+	for( i = d_deferred.constBegin(); i != d_deferred.constEnd(); ++i )
+	{
+		if( i.key()->isVisible() )
+		{
+			populate( i.key() );
+			// Events dazwischen verarbeiten, damit das Fenster bedienbar bleibt
+			QTimer::singleShot( 0, this, SLOT(onStartupStep()) );
+			return;
+		}
+	}
+	initLua();
+	d_starting = false;
+	StartupProfile::inst()->finish();
+}
+
+void MainWindow::paintEvent(QPaintEvent * event)
+{
+	QMainWindow::paintEvent( event );
+	if( d_painted )
+		return;
+	d_painted = true;
+	StartupProfile::inst()->mark( "first paint" );
+	// Die sichtbaren Docks eines pro Durchlauf füllen, damit das Fenster bedienbar bleibt
+	QTimer::singleShot( 0, this, SLOT(onStartupStep()) );
+}
+
+void MainWindow::onDiagnostics()
+{
+	QMessageBox::information( this, tr("Diagnostics - WorkTree"),
+							  CachePolicy::inst( d_txn->getDb() )->toString() + "\n\n" +
+							  GarbageCollector::inst( d_txn )->toString() + "\n\n" +
+							  StartupProfile::inst()->toString() );
+}
+
+void MainWindow::onCollectGarbage()
+{
+	GarbageCollector* gc = GarbageCollector::inst( d_txn );
+	ENABLED_IF( !gc->isRunning() );
+	gc->start();
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
@@ -563,7 +721,10 @@ void MainWindow::closeEvent(QCloseEvent *event)
 		d_txn->getDb()->getDbUuid().toString(), saveState() );
 	QMainWindow::closeEvent( event );
 	if( event->isAccepted() )
+	{
+		d_sv->flushIndex();
         emit closing();
+	}
 }
 
 void MainWindow::onFullScreen()
@@ -773,6 +934,14 @@ void MainWindow::onSearch()
     d_sv->onNew();
 }
 
+void MainWindow::onQuickOpen()
+{
+    ENABLED_IF( true );
+
+	QuickOpenDlg dlg( this, d_txn );
+	onFollowObject( dlg.select() );
+}
+
 void MainWindow::onFollowObject(const Udb::Obj & o)
 {
     if( o.isNull( true, true ) )
@@ -869,6 +1038,51 @@ void MainWindow::onImportMsp()
 #endif
 }
 
+void MainWindow::onImportMspdi()
+{
+    ENABLED_IF( true );
+
+    const QString path = QFileDialog::getOpenFileName( this, tr("Select MS Project XML File to Import - WorkTree"),
+                                                       QString(), tr("MS Project XML (*.xml)") );
+    if( path.isEmpty() )
+        return;
+    QApplication::setOverrideCursor( Qt::WaitCursor );
+    MspdiImporter imp;
+    const bool res = imp.importFile( path, d_txn );
+    QApplication::restoreOverrideCursor();
+    if( !res )
+        QMessageBox::critical( this, tr("Import MS Project XML - WorkTree" ),
+                               tr("%1 errors have occured. First error:\n%2").
+                               arg( imp.getErrors().size() ).arg( imp.getErrors().first() ) );
+    else
+        QMessageBox::information( this, tr("Import MS Project XML - WorkTree" ),
+                                  tr("Imported %1 tasks, %2 milestones, %3 links (%4 with lag, %5 with lead, "
+                                     "%6 not resolved) and %7 calendars.").
+                                  arg( imp.getCounts().tasks ).arg( imp.getCounts().milestones ).
+                                  arg( imp.getCounts().links ).arg( imp.getCounts().lags ).
+                                  arg( imp.getCounts().leads ).arg( imp.getCounts().deadLinks ).
+                                  arg( imp.getCounts().calendars ) );
+}
+
+void MainWindow::onExportSchedule()
+{
+    ENABLED_IF( true );
+
+    Udb::Obj root = d_imp->getSelectedObject( true );
+    if( !WtTypeDefs::isImpType( root.getType() ) )
+        root = d_txn->getObject( QUuid( WorkTreeApp::s_imp ) );
+    const QString path = QFileDialog::getSaveFileName( this, tr("Export Schedule - WorkTree"), QString(),
+                                                       tr("MS Project XML (*.xml);;CSV (*.csv)") );
+    if( path.isEmpty() )
+        return;
+    QApplication::setOverrideCursor( Qt::WaitCursor );
+    ScheduleExporter exp;
+    const bool res = exp.exportFile( root, path );
+    QApplication::restoreOverrideCursor();
+    if( !res )
+        QMessageBox::critical( this, tr("Export Schedule - WorkTree"), exp.getError() );
+}
+
 void MainWindow::onOpenDocument()
 {
     Udb::Obj doc = d_fldr->getSelectedObject();
@@ -937,6 +1151,54 @@ void MainWindow::onCalendars()
 	dlg.exec();
 }
 
+void MainWindow::onCreateBaseline()
+{
+    ENABLED_IF(true);
+
+    bool ok;
+    const QString name = QInputDialog::getText( this, tr("Create Baseline - WorkTree"),
+                                                tr("Name:"), QLineEdit::Normal,
+                                                QDate::currentDate().toString( Qt::ISODate ), &ok ).trimmed();
+    if( !ok || name.isEmpty() )
+        return;
+    QApplication::setOverrideCursor( Qt::WaitCursor );
+    Udb::Obj bl = Baseline::create( d_txn, name );
+    d_txn->commit();
+    QApplication::restoreOverrideCursor();
+    QMessageBox::information( this, tr("Create Baseline - WorkTree"),
+                              tr("Baseline '%1' created with %2 schedule items.").arg( name ).
+                              arg( bl.getValue( AttrBaselineCount ).getUInt32() ) );
+}
+
+void MainWindow::onRecordStatusCycle()
+{
+    ENABLED_IF(true);
+
+    QApplication::setOverrideCursor( Qt::WaitCursor );
+    StatusTrend trend( d_txn->getDb()->getFilePath() );
+    const bool ok = trend.append( d_txn );
+    QApplication::restoreOverrideCursor();
+    if( !ok )
+        QMessageBox::critical( this, tr("Record Status Cycle - WorkTree"), trend.getError() );
+}
+
+void MainWindow::onCollapseSvts()
+{
+    ENABLED_IF(true);
+
+    if( QMessageBox::question( this, tr("Convert SVTs to Lags - WorkTree"),
+                               tr("Replace all SVT tasks between two links by a single link with lag? "
+                                  "This cannot be undone."),
+                               QMessageBox::Yes | QMessageBox::Cancel, QMessageBox::Cancel ) != QMessageBox::Yes )
+        return;
+    QApplication::setOverrideCursor( Qt::WaitCursor );
+    const int count = ObjectHelper::collapseSvtChains( d_txn );
+    d_txn->commit();
+    QApplication::restoreOverrideCursor();
+    QMessageBox::information( this, tr("Convert SVTs to Lags - WorkTree"),
+                              tr("%1 SVT tasks converted to lags.").arg( count ) );
+}
+
 void MainWindow::saveEditor()
 {
 	Lua::CodeEditor* e = dynamic_cast<Lua::CodeEditor*>( d_tab->currentWidget() );
@@ -950,12 +1212,154 @@ void MainWindow::saveEditor()
 	e->document()->setModified(false);
 }
 
+static void _showProfile( QWidget* parent, const LuaProfiler& prof, const QString& name )
+{
+	QDialog* dlg = new QDialog( parent );
+	dlg->setAttribute( Qt::WA_DeleteOnClose );
+	dlg->setWindowTitle( QObject::tr("Script Profile %1 - WorkTree").arg( name ) );
+	QVBoxLayout* vbox = new QVBoxLayout( dlg );
+	vbox->addWidget( new QLabel( QObject::tr("%1 ms total, %2 line samples; times include hook overhead").
+								 arg( prof.getElapsedMs(), 0, 'f', 1 ).arg( prof.getSampleCount() ), dlg ) );
+	QTabWidget* tab = new QTabWidget( dlg );
+	vbox->addWidget( tab );
+
+	QTreeWidget* funcs = new QTreeWidget( tab );
+	funcs->setRootIsDecorated( false );
+	funcs->setAllColumnsShowFocus( true );
+	funcs->setHeaderLabels( QStringList() << QObject::tr("Function") << QObject::tr("Kind") <<
+							QObject::tr("Calls") << QObject::tr("Self ms") << QObject::tr("Total ms") <<
+							QObject::tr("Avg us") );
+	foreach( const LuaProfiler::Entry& e, prof.getEntries() )
+	{
+		QTreeWidgetItem* i = new QTreeWidgetItem( funcs );
+		i->setText( 0, QString::fromUtf8( e.d_name ) );
+		i->setText( 1, ( e.d_native ) ? QLatin1String("C") : QLatin1String("Lua") );
+		// Zahlen als Daten, damit die Spalten numerisch sortieren
+		i->setData( 2, Qt::DisplayRole, e.d_calls );
+		i->setData( 3, Qt::DisplayRole, qRound( e.d_selfMs * 100.0 ) / 100.0 );
+		i->setData( 4, Qt::DisplayRole, qRound( e.d_totalMs * 100.0 ) / 100.0 );
+		i->setData( 5, Qt::DisplayRole, ( e.d_calls ) ? qRound( e.d_totalMs * 1000.0 / e.d_calls ) : 0 );
+	}
+	funcs->setSortingEnabled( true );
+	funcs->sortByColumn( 3, Qt::DescendingOrder );
+	funcs->resizeColumnToContents( 0 );
+	tab->addTab( funcs, QObject::tr("Functions") );
+
+	QTreeWidget* lines = new QTreeWidget( tab );
+	lines->setRootIsDecorated( false );
+	lines->setAllColumnsShowFocus( true );
+	lines->setHeaderLabels( QStringList() << QObject::tr("Line") << QObject::tr("Samples") << QObject::tr("%") );
+	foreach( const LuaProfiler::Sample& s, prof.getSamples() )
+	{
+		QTreeWidgetItem* i = new QTreeWidgetItem( lines );
+		i->setText( 0, QString::fromUtf8( s.d_where ) );
+		i->setData( 1, Qt::DisplayRole, s.d_count );
+		i->setData( 2, Qt::DisplayRole, ( prof.getSampleCount() ) ?
+						qRound( s.d_count * 1000.0 / prof.getSampleCount() ) / 10.0 : 0.0 );
+	}
+	lines->setSortingEnabled( true );
+	lines->sortByColumn( 1, Qt::DescendingOrder );
+	lines->resizeColumnToContents( 0 );
+	tab->addTab( lines, QObject::tr("Hot Lines") );
+
+	dlg->resize( 700, 500 );
+	dlg->show();
+}
+
 void MainWindow::handleExecute()
 {
 	Lua::CodeEditor* e = dynamic_cast<Lua::CodeEditor*>( d_tab->currentWidget() );
-	ENABLED_IF( !Lua::Engine2::getInst()->isExecuting() && e != 0 );
-	Lua::Engine2::getInst()->executeCmd( e->text().toLatin1(), ( e->getName().isEmpty() ) ?
-											 QByteArray("#Editor") : e->getName().toLatin1() );
+	ENABLED_IF( ( Lua::Engine2::getInst() == 0 || !Lua::Engine2::getInst()->isExecuting() ) && e != 0 );
+	initLua();
+	const QByteArray name = ( e->getName().isEmpty() ) ? QByteArray("#Editor") : e->getName().toLatin1();
+	LuaProfiler* prof = 0;
+	if( WorkTreeApp::inst()->getSet()->value( "LuaEditor/Profile", false ).toBool() )
+		prof = new LuaProfiler( Lua::Engine2::getInst()->getCtx() );
+	Lua::Engine2::getInst()->executeCmd( e->text().toLatin1(), name );
+	if( prof )
+	{
+		prof->stop();
+		_showProfile( this, *prof, name );
+		delete prof;
+	}
+}
+
+void MainWindow::onProfileScripts()
+{
+	const bool on = WorkTreeApp::inst()->getSet()->value( "LuaEditor/Profile", false ).toBool();
+	CHECKED_IF( true, on );
+	WorkTreeApp::inst()->getSet()->setValue( "LuaEditor/Profile", !on );
+}
+
+void MainWindow::handleExecuteInBackground()
+{
+	Lua::CodeEditor* e = dynamic_cast<Lua::CodeEditor*>( d_tab->currentWidget() );
+	ENABLED_IF( d_script.isNull() && e != 0 );
+	executeInBackground( false );
+}
+
+void MainWindow::handleExecuteWithWriteBack()
+{
+	Lua::CodeEditor* e = dynamic_cast<Lua::CodeEditor*>( d_tab->currentWidget() );
+	ENABLED_IF( d_script.isNull() && e != 0 );
+	executeInBackground( true );
+}
+
+void MainWindow::executeInBackground(bool writeBack)
+{
+	Lua::CodeEditor* e = dynamic_cast<Lua::CodeEditor*>( d_tab->currentWidget() );
+	if( e == 0 )
+		return;
+	createTerminal();
+	d_term->show();
+	d_script = new ScriptRunner( e->text().toLatin1(), ( e->getName().isEmpty() ) ?
+									 QByteArray("#Editor") : e->getName().toLatin1(), writeBack );
+	connect( d_script, SIGNAL(output(QString)), this, SLOT(onScriptOutput(QString)) );
+	connect( d_script, SIGNAL(progress(int,QString)), this, SLOT(onScriptProgress(int,QString)) );
+	connect( d_script, SIGNAL(finished(bool)), this, SLOT(onScriptFinished(bool)) );
+	statusBar()->showMessage( tr("Running %1 in background...").arg( d_script->getName().constData() ) );
+	WorkerPool::inst( d_txn )->start( d_script );
+}
+
+void MainWindow::handleCancelScript()
+{
+	ENABLED_IF( !d_script.isNull() );
+	d_script->cancel();
+	statusBar()->showMessage( tr("Canceling %1...").arg( d_script->getName().constData() ) );
+}
+
+void MainWindow::onScriptOutput(const QString & str)
+{
+	Lua::Engine2::getInst()->print( str.toUtf8() );
+}
+
+void MainWindow::onScriptProgress(int percent, const QString & text)
+{
+	if( d_script.isNull() )
+		return;
+	statusBar()->showMessage( tr("%1: %2% %3").arg( d_script->getName().constData() ).
+							  arg( percent ).arg( text ) );
+}
+
+void MainWindow::onScriptFinished(bool ok)
+{
+	ScriptRunner* r = static_cast<ScriptRunner*>( sender() );
+	if( ok )
+	{
+		if( r->isWriteBack() )
+			statusBar()->showMessage( tr("%1 finished, %2 changes written, %3 conflicts skipped").
+									  arg( r->getName().constData() ).arg( r->getWriteCount() ).
+									  arg( r->getConflictCount() ), 5000 );
+		else
+			statusBar()->showMessage( tr("%1 finished").arg( r->getName().constData() ), 5000 );
+	}else
+	{
+		const QString msg = ( r->isCanceled() ) ? tr("%1 canceled").arg( r->getName().constData() ) :
+												  r->getError();
+		Lua::Engine2::getInst()->error( msg.toUtf8() );
+		statusBar()->showMessage( msg, 5000 );
+	}
+	d_script = 0;
 }
 
 void MainWindow::onSetScriptFont()
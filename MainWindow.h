@@ -24,12 +24,17 @@
 #include <Udb/Transaction.h>
 #include <Gui2/AutoMenu.h>
 #include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QPair>
+#include <QtCore/QPointer>
 
 namespace Oln
 {
 	class DocTabWidget;
 }
 
+class QDockWidget;
+
 namespace Wt
 {
     class ImpCtrl;
@@ -45,6 +50,7 @@ namespace Wt
     class MspImporter;
     class FolderCtrl;
     class WpViewCtrl;
+    class ScriptRunner;
 
     class MainWindow : public QMainWindow
     {
@@ -74,10 +80,13 @@ namespace Wt
         void onObsSelected( const Udb::Obj&);
         void onWbsSelected( const Udb::Obj&);
         void onSearch();
+        void onQuickOpen();
         void onFollowObject( const Udb::Obj&);
         void onGoBack();
         void onGoForward();
         void onImportMsp();
+        void onImportMspdi();
+        void onExportSchedule();
         void onOpenDocument();
         void onFldrSelected( const Udb::Obj&);
         void onFldrDblClicked(const Udb::Obj&);
@@ -85,10 +94,26 @@ namespace Wt
         void onFollowOID( quint64 );
         void onWpSelected( const Udb::Obj& );
         void onCalendars();
+        void onCreateBaseline();
+        void onRecordStatusCycle();
+        void onCollapseSvts();
 		void saveEditor();
 		void handleExecute();
+		void handleExecuteInBackground();
+		void onProfileScripts();
+		void handleExecuteWithWriteBack();
+		void handleCancelScript();
+		void onScriptOutput( const QString& );
+		void onScriptProgress( int, const QString& );
+		void onScriptFinished( bool );
 		void onSetScriptFont();
 		void onAutoStart();
+		void onDiagnostics();
+		void onCollectGarbage();
+		void onStartupStep();
+		void onDockVisibility( bool );
+		void createTerminal();
+		void initLua(); // erst nach dem Start oder beim ersten Gebrauch
 	protected:
         void setupImp();
         void setupObs();
@@ -102,17 +127,22 @@ namespace Wt
         void setupFolders();
         void setupWbView();
 		void setupTerminal();
+		// slot wird erst aufgerufen, wenn das Dock erstmals sichtbar oder gebraucht wird
+		void defer( QDockWidget*, QObject* receiver, const char* slot );
+		void populate( QDockWidget* );
         void setCaption();
         void addTopCommands( Gui2::AutoMenu* );
         void openPdmDiagram( const Udb::Obj& diagram, const Udb::Obj& select = Udb::Obj() );
         void showInPdmDiagram( const Udb::Obj& select, bool checkAllOpenDiagrams );
         void openOutline( const Udb::Obj& doc, const Udb::Obj& select = Udb::Obj() );
 		void openScript( const Udb::Obj& doc );
+		void executeInBackground( bool writeBack );
 		PdmCtrl* getCurrentPdmDiagram() const;
         void pushBack( const Udb::Obj& );
         static void toFullScreen( QMainWindow* );
         // Overrides
 		void closeEvent ( QCloseEvent * event );
+		void paintEvent ( QPaintEvent * event );
     private:
         ImpCtrl* d_imp;
         ObsCtrl* d_obs;
@@ -127,6 +157,9 @@ namespace Wt
         WpViewCtrl* d_wpv;
         Udb::Transaction* d_txn;
 		Oln::DocTabWidget* d_tab;
+		QDockWidget* d_term;
+		QPointer<ScriptRunner> d_script; // laufendes Hintergrund-Script
+		QHash<QDockWidget*,QPair<QObject*,QByteArray> > d_deferred;
         QList<Udb::OID> d_backHisto; // d_backHisto.last() ist aktuell angezeigtes Objekt
 		QList<Udb::OID> d_forwardHisto;
 #ifdef _WIN32
@@ -135,6 +168,9 @@ namespace Wt
         bool d_pushBackLock;
         bool d_selectLock;
         bool d_fullScreen;
+		bool d_starting;
+		bool d_painted;
+		bool d_luaReady;
     };
 }
 
@@ -355,37 +355,20 @@ bool MspImporter::importLinksImp(MspImporter::Task * task )
                         toTask->d_obj.getValue( AttrCriticalPath ).getBool() )
                     link.setValue( AttrCriticalPath, Stream::DataCell().setBool(true) );
 
+                // Lags und Leads werden direkt am Link gespeichert statt als SVT
                 const int lag = succ.getLagDays();
                 if( lag > 0 )
-                {
                     d_counts.lags++;
-                    Udb::Obj svt = ObjectHelper::createObject( TypeTask, task->d_obj.getParent() );
-                    svt.setString( AttrText, tr("Lag %1 to %2").
-                                    arg( WtTypeDefs::formatObjectId( task->d_obj ) ).
-                                    arg( WtTypeDefs::formatObjectId( toTask->d_obj ) ) );
-
-                    svt.setValue( AttrTaskType, Stream::DataCell().setUInt8( TaskType_SVT ) );
-                    svt.setValue( AttrEarlyStart, task->d_obj.getValue( AttrEarlyFinish ) );
-                    svt.setValue( AttrEarlyFinish, toTask->d_obj.getValue( AttrEarlyStart ) );
-                    svt.setValue( AttrLateStart, task->d_obj.getValue( AttrLateFinish ) );
-                    svt.setValue( AttrLateFinish, toTask->d_obj.getValue( AttrLateStart ) );
-                    svt.setValue( AttrDuration, Stream::DataCell().setUInt16( lag ) );
-                    svt.setValue( AttrCriticalPath, link.getValue( AttrCriticalPath ) );
-
-                    link.setValueAsObj( AttrPred, task->d_obj );
-                    link.setValueAsObj( AttrSucc, svt );
-                    link = ObjectHelper::createObject( TypeLink, svt );
-                    link.setValueAsObj( AttrPred, svt );
-                    link.setValueAsObj( AttrSucc, toTask->d_obj );
-                    link.setValue( AttrCriticalPath, svt.getValue( AttrCriticalPath ) );
-                }else
+                else if( lag < 0 )
+                    d_counts.leads++;
+                if( lag != 0 )
                 {
-                    // Ignoring leads
-                    if( lag < 0 )
-                        d_counts.leads++;
-                    link.setValueAsObj( AttrPred, task->d_obj );
-                    link.setValueAsObj( AttrSucc, toTask->d_obj );
+                    link.setValue( AttrLag, Stream::DataCell().setInt32( lag ) );
+                    if( succ.isElapsed() )
+                        link.setValue( AttrLagElapsed, Stream::DataCell().setBool( true ) );
                 }
+                link.setValueAsObj( AttrPred, task->d_obj );
+                link.setValueAsObj( AttrSucc, toTask->d_obj );
             }else
             {
                 // Target not found
@@ -443,26 +426,33 @@ int MspImporter::Link::getLagDays() const
     // Elapsed durations are scheduled 24 hours a day, 7 days a week, until fnished.
     // That is, one day is always considered 24 hours long (rather than 8 hours),
     // and one week is always 7 days (rather than 5 days).
-    // TODO
-    if( u.startsWith( "f" ) || u.startsWith( "e" ) )
+    // Bei isElapsed() ist das Resultat deshalb in Kalendertagen, sonst in Workdays.
+    const bool elapsed = isElapsed();
+    if( elapsed )
         u = u.mid( 1 );
     if( u == "t" || u == "d" || u == "dy" ) // Tage
-        return d_lag + 0.5;
+        return qRound( d_lag );
     else if( u == "w" || u == "wk" ) // Wochen
-        return d_lag * 5.0 + 0.5;
+        return qRound( d_lag * ( ( elapsed )? 7.0 : 5.0 ) );
     else if( u == "h" || u == "hr") // Stunden
-        return d_lag / 8.0 + 0.5;
+        return qRound( d_lag / ( ( elapsed )? 24.0 : 8.0 ) );
     else if( u == "m" || u == "min" ) // Minuten
-        return d_lag / ( 8.0 * 60.0 ) + 0.5;
+        return qRound( d_lag / ( ( elapsed )? 24.0 * 60.0 : 8.0 * 60.0 ) );
     else if( u == "mo" || u == "mon" ) // Monat
-        return d_lag * 20.0 + 0.5;
+        return qRound( d_lag * ( ( elapsed )? 30.0 : 20.0 ) );
     else if( u.isEmpty() )
-        return d_lag + 0.5;
+        return qRound( d_lag );
     else
         Q_ASSERT( false );
     return 0;
 }
 
+bool MspImporter::Link::isElapsed() const
+{
+    const QString u = d_unit.toLower().trimmed();
+    return u.startsWith( "f" ) || u.startsWith( "e" );
+}
+
 QString MspImporter::Link::renderId() const
 {
     if( d_file.isEmpty() )
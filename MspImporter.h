@@ -54,7 +54,8 @@ namespace Wt
             void parseId( const QString& );
             QString renderId() const;
             int getLinkType() const;
-            int getLagDays() const;
+            int getLagDays() const; // Workdays bzw. Kalendertage wenn isElapsed()
+            bool isElapsed() const;
         };
         static Link parseLink( const QString& );
 
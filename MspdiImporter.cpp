@@ -0,0 +1,521 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "MspdiImporter.h"
+#include "WtTypeDefs.h"
+#include "WorkTreeApp.h"
+#include "ObjectHelper.h"
+#include "CachePolicy.h"
+#include <Udb/Transaction.h>
+#include <QXmlStreamReader>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QRegExp>
+using namespace Wt;
+
+// Siehe http://schemas.microsoft.com/project/2007/mspdi_pj12.xsd
+
+MspdiImporter::MspdiImporter(QObject *parent) :
+	QObject(parent),d_txn(0),d_bulk(0),d_minutesPerDay(480),d_chunkSize(2000),d_pending(0)
+{
+}
+
+bool MspdiImporter::isElapsedFormat(int f)
+{
+	// 3=m, 4=em, 5=h, 6=eh, 7=d, 8=ed, 9=w, 10=ew, 11=mo, 12=emo, 19=%, 20=e%; +32 für geschätzt
+	if( f >= 35 )
+		f -= 32;
+	return f == 4 || f == 6 || f == 8 || f == 10 || f == 12 || f == 20;
+}
+
+int MspdiImporter::parseDuration(const QString & str, int minutesPerDay, bool elapsed)
+{
+	static QRegExp s_dur( "^(-?)PT(\\d+)H(\\d+)M(\\d+(?:\\.\\d+)?)S$" );
+	if( !s_dur.exactMatch( str.trimmed() ) )
+		return 0;
+	const double minutes = s_dur.cap(2).toInt() * 60.0 + s_dur.cap(3).toInt() + s_dur.cap(4).toDouble() / 60.0;
+	const double perDay = ( elapsed )? 24.0 * 60.0 : qMax( minutesPerDay, 1 );
+	const int days = qRound( minutes / perDay );
+	return ( s_dur.cap(1).isEmpty() )? days : -days;
+}
+
+static inline QDate _date( const QString& str )
+{
+	return QDateTime::fromString( str.trimmed(), Qt::ISODate ).date();
+}
+
+static inline bool _bool( const QString& str )
+{
+	return str.trimmed() == QLatin1String("1");
+}
+
+void MspdiImporter::created()
+{
+	// Grosse Importe werden portionenweise committed, damit die Transaktion klein bleibt
+	if( ++d_pending >= d_chunkSize )
+	{
+		d_bulk->commit();
+		d_pending = 0;
+	}
+}
+
+bool MspdiImporter::importFile(const QString &path, Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	d_txn = txn;
+	d_errors.clear();
+	d_counts = Counts();
+	d_stack.clear();
+	d_tasks.clear();
+	d_cals.clear();
+	d_newCals.clear();
+	d_links.clear();
+	d_calParents.clear();
+	d_minutesPerDay = 480;
+	d_pending = 0;
+
+	QFile f( path );
+	if( !f.open( QIODevice::ReadOnly ) )
+	{
+		d_errors.append( tr("Cannot open file: %1").arg( path ) );
+		return false;
+	}
+	ObjectHelper::BulkCreator bulk( txn, 1024 );
+	d_bulk = &bulk;
+	CachePolicy::Bulk cache( txn->getDb() );
+	Udb::Obj imp = txn->getOrCreateObject( QUuid(WorkTreeApp::s_imp), TypeIMP );
+	d_top = d_bulk->createObject( TypeTask, imp );
+	d_top.setString( AttrText, QFileInfo( path ).completeBaseName() );
+	d_top.setString( imp.getAtom("SourceFile"), QFileInfo( path ).absoluteFilePath() );
+	d_stack.append( d_top );
+
+	QXmlStreamReader xml( &f );
+	if( xml.readNextStartElement() )
+	{
+		if( xml.name() == QLatin1String("Project") )
+			readProject( xml );
+		else
+			xml.raiseError( tr("not an MS Project XML file") );
+	}
+	if( xml.hasError() )
+		d_errors.append( tr("%1 at line %2").arg( xml.errorString() ).arg( xml.lineNumber() ) );
+	if( !d_errors.isEmpty() )
+	{
+		cleanup();
+		d_bulk = 0;
+		return false;
+	}
+	createLinks();
+	d_bulk->commit();
+	d_bulk = 0;
+	d_stack.clear();
+	d_top = Udb::Obj();
+	return true;
+}
+
+void MspdiImporter::cleanup()
+{
+	// Bereits committete Portionen wieder entfernen
+	d_bulk->flush();
+	Udb::Obj cals = WtTypeDefs::getCalendars( d_txn );
+	if( d_newCals.contains( cals.getValue( AttrDefaultCal ).getOid() ) )
+		cals.clearValue( AttrDefaultCal ); // war vor dem Import leer, siehe readProject
+	foreach( Udb::OID oid, d_newCals )
+	{
+		Udb::Obj cal = d_txn->getObject( oid );
+		ObjectHelper::erase( cal );
+	}
+	ObjectHelper::erase( d_top );
+	d_txn->commit();
+	d_stack.clear();
+	d_top = Udb::Obj();
+}
+
+void MspdiImporter::readProject(QXmlStreamReader & xml)
+{
+	int calUid = -1;
+	while( xml.readNextStartElement() )
+	{
+		if( xml.name() == QLatin1String("Name") || xml.name() == QLatin1String("Title") )
+		{
+			const QString name = xml.readElementText().trimmed();
+			if( !name.isEmpty() )
+				d_top.setString( AttrText, name );
+		}else if( xml.name() == QLatin1String("MinutesPerDay") )
+			d_minutesPerDay = xml.readElementText().toInt();
+		else if( xml.name() == QLatin1String("CalendarUID") )
+			calUid = xml.readElementText().toInt();
+		else if( xml.name() == QLatin1String("Calendars") )
+			readCalendars( xml );
+		else if( xml.name() == QLatin1String("Tasks") )
+			readTasks( xml );
+		else
+			xml.skipCurrentElement();
+	}
+	// Default-Kalender nur setzen, wenn noch keiner existiert
+	Udb::Obj cals = WtTypeDefs::getCalendars( d_txn );
+	if( d_cals.contains( calUid ) && cals.getValue( AttrDefaultCal ).isNull() )
+		cals.setValue( AttrDefaultCal, Stream::DataCell().setOid( d_cals.value( calUid ) ) );
+}
+
+void MspdiImporter::readCalendars(QXmlStreamReader & xml)
+{
+	while( xml.readNextStartElement() )
+	{
+		if( xml.name() == QLatin1String("Calendar") )
+			readCalendar( xml );
+		else
+			xml.skipCurrentElement();
+	}
+	foreach( const PendingCal& p, d_calParents )
+	{
+		if( d_cals.contains( p.d_baseUid ) )
+			d_txn->getObject( p.d_cal ).setValue( AttrParentCalendar,
+												  Stream::DataCell().setOid( d_cals.value( p.d_baseUid ) ) );
+	}
+	d_calParents.clear();
+}
+
+struct _CalEntry
+{
+	QDate d_from;
+	QDate d_to;
+	bool d_working;
+	QString d_name;
+	_CalEntry():d_working(false){}
+};
+
+static void _readTimePeriod( QXmlStreamReader& xml, _CalEntry& e )
+{
+	while( xml.readNextStartElement() )
+	{
+		if( xml.name() == QLatin1String("FromDate") )
+			e.d_from = _date( xml.readElementText() );
+		else if( xml.name() == QLatin1String("ToDate") )
+			e.d_to = _date( xml.readElementText() );
+		else
+			xml.skipCurrentElement();
+	}
+}
+
+void MspdiImporter::readCalendar(QXmlStreamReader & xml)
+{
+	int uid = -1;
+	int baseUid = -1;
+	bool isBase = true;
+	QString name;
+	QByteArray nwd( 7, ' ' );
+	QList<_CalEntry> entries;
+	while( xml.readNextStartElement() )
+	{
+		if( xml.name() == QLatin1String("UID") )
+			uid = xml.readElementText().toInt();
+		else if( xml.name() == QLatin1String("Name") )
+			name = xml.readElementText().trimmed();
+		else if( xml.name() == QLatin1String("IsBaseCalendar") )
+			isBase = _bool( xml.readElementText() );
+		else if( xml.name() == QLatin1String("BaseCalendarUID") )
+			baseUid = xml.readElementText().toInt();
+		else if( xml.name() == QLatin1String("WeekDays") )
+		{
+			while( xml.readNextStartElement() )
+			{
+				if( xml.name() != QLatin1String("WeekDay") )
+				{
+					xml.skipCurrentElement();
+					continue;
+				}
+				int dayType = -1;
+				_CalEntry e;
+				bool hasWorking = false;
+				while( xml.readNextStartElement() )
+				{
+					if( xml.name() == QLatin1String("DayType") )
+						dayType = xml.readElementText().toInt();
+					else if( xml.name() == QLatin1String("DayWorking") )
+					{
+						e.d_working = _bool( xml.readElementText() );
+						hasWorking = true;
+					}else if( xml.name() == QLatin1String("TimePeriod") )
+						_readTimePeriod( xml, e );
+					else
+						xml.skipCurrentElement();
+				}
+				if( dayType >= 1 && dayType <= 7 && hasWorking )
+					nwd[ ( dayType + 5 ) % 7 ] = ( e.d_working )? '0' : '1'; // 1=Sonntag
+				else if( dayType == 0 && e.d_from.isValid() )
+					entries.append( e ); // Ausnahmen im Format vor MSP 2007
+			}
+		}else if( xml.name() == QLatin1String("Exceptions") )
+		{
+			while( xml.readNextStartElement() )
+			{
+				if( xml.name() != QLatin1String("Exception") )
+				{
+					xml.skipCurrentElement();
+					continue;
+				}
+				_CalEntry e;
+				while( xml.readNextStartElement() )
+				{
+					if( xml.name() == QLatin1String("TimePeriod") )
+						_readTimePeriod( xml, e );
+					else if( xml.name() == QLatin1String("DayWorking") )
+						e.d_working = _bool( xml.readElementText() );
+					else if( xml.name() == QLatin1String("Name") )
+						e.d_name = xml.readElementText().trimmed();
+					else
+						xml.skipCurrentElement();
+				}
+				if( e.d_from.isValid() )
+					entries.append( e );
+			}
+		}else
+			xml.skipCurrentElement();
+	}
+	if( !isBase || uid == -1 )
+		return; // Ressourcenkalender werden nicht übernommen
+
+	Udb::Obj cal = d_bulk->createObject( TypeCalendar, WtTypeDefs::getCalendars( d_txn ) );
+	cal.setString( AttrText, ( name.isEmpty() )? tr("Calendar %1").arg( uid ) : name );
+	cal.setValue( AttrNonWorkingDays, Stream::DataCell().setAscii( nwd ) );
+	d_cals[uid] = cal.getOid();
+	d_newCals.append( cal.getOid() );
+	d_counts.calendars++;
+	created();
+	if( baseUid != -1 )
+	{
+		PendingCal p;
+		p.d_cal = cal.getOid();
+		p.d_baseUid = baseUid;
+		d_calParents.append( p );
+	}
+	foreach( const _CalEntry& e, entries )
+	{
+		Udb::Obj entry = d_bulk->createObject( TypeCalEntry, cal );
+		if( !e.d_name.isEmpty() )
+			entry.setString( AttrText, e.d_name );
+		entry.setValue( AttrCalDate, Stream::DataCell().setDate( e.d_from ) );
+		const QDate to = ( e.d_to.isValid() && e.d_to >= e.d_from )? e.d_to : e.d_from;
+		entry.setValue( AttrCalDuration, Stream::DataCell().setUInt16( qMin( e.d_from.daysTo( to ) + 1, 0xffff ) ) );
+		entry.setBool( AttrNonWorking, !e.d_working );
+		created();
+	}
+}
+
+void MspdiImporter::readTasks(QXmlStreamReader & xml)
+{
+	while( xml.readNextStartElement() )
+	{
+		if( xml.name() == QLatin1String("Task") )
+			readTask( xml );
+		else
+			xml.skipCurrentElement();
+	}
+}
+
+void MspdiImporter::readTask(QXmlStreamReader & xml)
+{
+	int uid = -1;
+	int level = 1;
+	int calUid = -1;
+	int durFormat = 7;
+	QString name, wbs, dur;
+	bool milestone = false, summary = false, critical = false, skip = false;
+	QDate es, ef, ls, lf;
+	QList<PendingLink> preds;
+	while( xml.readNextStartElement() )
+	{
+		const QStringRef n = xml.name();
+		if( n == QLatin1String("UID") )
+			uid = xml.readElementText().toInt();
+		else if( n == QLatin1String("Name") )
+			name = xml.readElementText().trimmed();
+		else if( n == QLatin1String("WBS") )
+			wbs = xml.readElementText().trimmed();
+		else if( n == QLatin1String("OutlineLevel") )
+			level = xml.readElementText().toInt();
+		else if( n == QLatin1String("Milestone") )
+			milestone = _bool( xml.readElementText() );
+		else if( n == QLatin1String("Summary") )
+			summary = _bool( xml.readElementText() );
+		else if( n == QLatin1String("Critical") )
+			critical = _bool( xml.readElementText() );
+		else if( n == QLatin1String("IsNull") || n == QLatin1String("ExternalTask") )
+			skip = skip || _bool( xml.readElementText() );
+		else if( n == QLatin1String("Duration") )
+			dur = xml.readElementText();
+		else if( n == QLatin1String("DurationFormat") )
+			durFormat = xml.readElementText().toInt();
+		else if( n == QLatin1String("EarlyStart") )
+			es = _date( xml.readElementText() );
+		else if( n == QLatin1String("EarlyFinish") )
+			ef = _date( xml.readElementText() );
+		else if( n == QLatin1String("LateStart") )
+			ls = _date( xml.readElementText() );
+		else if( n == QLatin1String("LateFinish") )
+			lf = _date( xml.readElementText() );
+		else if( n == QLatin1String("CalendarUID") )
+			calUid = xml.readElementText().toInt();
+		else if( n == QLatin1String("PredecessorLink") )
+		{
+			PendingLink l;
+			l.d_succ = 0;
+			l.d_predUid = -1;
+			l.d_type = LinkType_FS;
+			l.d_lag = 0;
+			l.d_elapsed = false;
+			qint64 lag = 0; // Zehntelminuten
+			int lagFormat = 7;
+			bool cross = false;
+			while( xml.readNextStartElement() )
+			{
+				if( xml.name() == QLatin1String("PredecessorUID") )
+					l.d_predUid = xml.readElementText().toInt();
+				else if( xml.name() == QLatin1String("Type") )
+				{
+					switch( xml.readElementText().toInt() )
+					{
+					case 0:
+						l.d_type = LinkType_FF;
+						break;
+					case 2:
+						l.d_type = LinkType_SF;
+						break;
+					case 3:
+						l.d_type = LinkType_SS;
+						break;
+					default:
+						l.d_type = LinkType_FS;
+						break;
+					}
+				}else if( xml.name() == QLatin1String("CrossProject") )
+					cross = _bool( xml.readElementText() );
+				else if( xml.name() == QLatin1String("LinkLag") )
+					lag = xml.readElementText().toLongLong();
+				else if( xml.name() == QLatin1String("LagFormat") )
+					lagFormat = xml.readElementText().toInt();
+				else
+					xml.skipCurrentElement();
+			}
+			if( cross )
+				d_counts.deadLinks++; // Links in andere Dateien werden nicht aufgelöst
+			else
+			{
+				l.d_elapsed = isElapsedFormat( lagFormat );
+				const double perDay = ( l.d_elapsed )? 24.0 * 60.0 : qMax( d_minutesPerDay, 1 );
+				l.d_lag = qRound( lag / 10.0 / perDay );
+				preds.append( l );
+			}
+		}else
+			xml.skipCurrentElement();
+	}
+	if( skip || uid == -1 )
+		return;
+	if( level <= 0 || uid == 0 )
+	{
+		// Project Summary Task
+		if( !name.isEmpty() )
+			d_top.setString( AttrText, name );
+		d_tasks[uid] = d_top.getOid();
+		return;
+	}
+	if( level > d_stack.size() )
+		level = d_stack.size(); // Lücken in der Gliederung an den letzten Task hängen
+	Udb::Obj parent = d_stack[ level - 1 ];
+	if( parent.getType() == TypeMilestone )
+	{
+		// Ein Milestone mit Kindern wird zum Task; retypeObject braucht aktuelle Counter
+		d_bulk->flush();
+		ObjectHelper::retypeObject( parent, TypeTask );
+		d_counts.milestones--;
+		d_counts.tasks++;
+	}
+	const bool ms = milestone && !summary;
+	Udb::Obj o = d_bulk->createObject( ( ms )? TypeMilestone : TypeTask, parent );
+	if( ms )
+		d_counts.milestones++;
+	else
+		d_counts.tasks++;
+	d_stack.resize( level + 1 );
+	d_stack[level] = o;
+	d_tasks[uid] = o.getOid();
+
+	o.setString( AttrText, name );
+	if( !wbs.isEmpty() )
+		o.setString( AttrCustomId, wbs );
+	if( es.isValid() )
+		o.setValue( AttrEarlyStart, Stream::DataCell().setDate( es ) );
+	if( ef.isValid() && !ms )
+		o.setValue( AttrEarlyFinish, Stream::DataCell().setDate( ef ) );
+	if( ls.isValid() )
+		o.setValue( AttrLateStart, Stream::DataCell().setDate( ls ) );
+	if( lf.isValid() && !ms )
+		o.setValue( AttrLateFinish, Stream::DataCell().setDate( lf ) );
+	if( !ms )
+		o.setValue( AttrDuration, Stream::DataCell().setUInt16(
+						qBound( 0, parseDuration( dur, d_minutesPerDay, isElapsedFormat( durFormat ) ), 0xffff ) ) );
+	if( critical )
+		o.setValue( AttrCriticalPath, Stream::DataCell().setBool( true ) );
+	if( calUid != -1 && d_cals.contains( calUid ) )
+		o.setValue( AttrCalendar, Stream::DataCell().setOid( d_cals.value( calUid ) ) );
+	for( int i = 0; i < preds.size(); i++ )
+	{
+		preds[i].d_succ = o.getOid();
+		d_links.append( preds[i] );
+	}
+	created();
+}
+
+void MspdiImporter::createLinks()
+{
+	// Die Vorgänger werden erst am Schluss über die UID aufgelöst, weil sie in der Datei
+	// auch nach dem Nachfolger kommen können
+	foreach( const PendingLink& l, d_links )
+	{
+		const Udb::OID predOid = d_tasks.value( l.d_predUid );
+		if( predOid == 0 )
+		{
+			d_counts.deadLinks++;
+			continue;
+		}
+		Udb::Obj pred = d_txn->getObject( predOid );
+		Udb::Obj succ = d_txn->getObject( l.d_succ );
+		Udb::Obj link = d_bulk->createObject( TypeLink, pred );
+		d_counts.links++;
+		link.setValue( AttrLinkType, Stream::DataCell().setUInt8( l.d_type ) );
+		link.setValueAsObj( AttrPred, pred );
+		link.setValueAsObj( AttrSucc, succ );
+		if( l.d_lag > 0 )
+			d_counts.lags++;
+		else if( l.d_lag < 0 )
+			d_counts.leads++;
+		if( l.d_lag != 0 )
+		{
+			link.setValue( AttrLag, Stream::DataCell().setInt32( l.d_lag ) );
+			if( l.d_elapsed )
+				link.setValue( AttrLagElapsed, Stream::DataCell().setBool( true ) );
+		}
+		if( pred.getValue( AttrCriticalPath ).getBool() && succ.getValue( AttrCriticalPath ).getBool() )
+			link.setValue( AttrCriticalPath, Stream::DataCell().setBool( true ) );
+		created();
+	}
+	d_links.clear();
+}
@@ -0,0 +1,99 @@
+#ifndef MSPDIIMPORTER_H
+#define MSPDIIMPORTER_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <Udb/Obj.h>
+#include "ObjectHelper.h"
+
+class QXmlStreamReader;
+
+namespace Wt
+{
+	// Import von MS Project XML (MSPDI) ohne MS Project; die Datei wird mit einem
+	// Pull-Parser gelesen, Objekte werden direkt angelegt und in Portionen committed.
+	class MspdiImporter : public QObject
+	{
+		Q_OBJECT
+	public:
+		struct Counts
+		{
+			quint32 tasks;
+			quint32 milestones;
+			quint32 links;
+			quint32 leads;
+			quint32 deadLinks;
+			quint32 lags;
+			quint32 calendars;
+			Counts():tasks(0),milestones(0),links(0),leads(0),deadLinks(0),lags(0),calendars(0){}
+		};
+		explicit MspdiImporter(QObject *parent = 0);
+		void setChunkSize( int n ) { d_chunkSize = n; }
+		// Erzeugt einen neuen Top-Level Task im IMP; committed selber. Bei Fehlern wird
+		// das bereits Importierte wieder gelöscht.
+		bool importFile( const QString& path, Udb::Transaction* );
+		const Counts& getCounts() const { return d_counts; }
+		const QStringList& getErrors() const { return d_errors; }
+		static int parseDuration( const QString&, int minutesPerDay, bool elapsed ); // PT8H0M0S -> Tage, -PT... negativ
+		static bool isElapsedFormat( int ); // DurationFormat, LagFormat
+	private:
+		struct PendingLink
+		{
+			Udb::OID d_succ;
+			int d_predUid;
+			quint8 d_type;
+			qint32 d_lag;
+			bool d_elapsed;
+		};
+		struct PendingCal
+		{
+			Udb::OID d_cal;
+			int d_baseUid;
+		};
+		void readProject( QXmlStreamReader& );
+		void readCalendars( QXmlStreamReader& );
+		void readCalendar( QXmlStreamReader& );
+		void readTasks( QXmlStreamReader& );
+		void readTask( QXmlStreamReader& );
+		void createLinks();
+		void created();
+		void cleanup();
+		Udb::Transaction* d_txn;
+		ObjectHelper::BulkCreator* d_bulk; // nur während importFile
+		Udb::Obj d_top;
+		QVector<Udb::Obj> d_stack; // Index ist OutlineLevel
+		QHash<int,Udb::OID> d_tasks; // UID -> OID
+		QHash<int,Udb::OID> d_cals; // UID -> OID
+		QList<Udb::OID> d_newCals;
+		QList<PendingLink> d_links;
+		QList<PendingCal> d_calParents;
+		Counts d_counts;
+		QStringList d_errors;
+		int d_minutesPerDay;
+		int d_chunkSize;
+		int d_pending;
+	};
+}
+
+#endif // MSPDIIMPORTER_H
@@ -0,0 +1,129 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "NetCondenser.h"
+#include "WtTypeDefs.h"
+#include "ObjectHelper.h"
+#include "CachePolicy.h"
+#include "WorkCalendar.h"
+#include <Udb/Transaction.h>
+#include <Udb/Idx.h>
+using namespace Wt;
+
+NetCondenser::NetCondenser():d_scanned(0),d_unmapped(0)
+{
+}
+
+void NetCondenser::mapSubtree(const Udb::Obj &parent, Udb::OID ancestor, int level, quint8 depth)
+{
+	Udb::Obj sub = parent.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		const quint32 type = sub.getType();
+		if( WtTypeDefs::isSchedObj( type ) )
+		{
+			Udb::OID a = ancestor;
+			if( a == 0 )
+			{
+				// Noch oberhalb der gewünschten Ebene; wird selber zum Knoten, wenn die Ebene
+				// erreicht ist oder der Task keine Subtasks hat
+				if( level >= depth || sub.getValue( AttrSubTMSCount ).getUInt32() == 0 )
+				{
+					a = sub.getOid();
+					d_nodes.append( a );
+				}else
+					d_summaries.insert( sub.getOid() );
+			}
+			if( a != 0 )
+				d_ancestor[ sub.getOid() ] = a;
+			if( type == TypeTask )
+				mapSubtree( sub, a, level + 1, depth );
+		}else if( WtTypeDefs::isImpType( type ) && ancestor == 0 )
+			mapSubtree( sub, ancestor, level, depth );
+	}while( sub.next() );
+}
+
+void NetCondenser::condense(const Udb::Obj &root, quint8 depth)
+{
+	CachePolicy::Bulk bulk( root.getDb() );
+	d_ancestor.clear();
+	d_nodes.clear();
+	d_links.clear();
+	d_summaries.clear();
+	d_scanned = 0;
+	d_unmapped = 0;
+	if( root.isNull() )
+		return;
+	mapSubtree( root, 0, 0, depth );
+	const WorkCalendar cal = WorkCalendar::loadDefault( root.getTxn() );
+
+	QHash<QPair<Udb::OID,Udb::OID>,int> pairs; // ( pred, succ ) -> Index in d_links
+	Udb::Idx predIdx( root.getTxn(), IndexDefs::IdxPred );
+	if( predIdx.first() ) do
+	{
+		Udb::Obj link = root.getObject( predIdx.getOid() );
+		if( link.isNull() )
+			continue;
+		d_scanned++;
+		const Udb::OID predObj = link.getValue( AttrPred ).getOid();
+		const Udb::OID succObj = link.getValue( AttrSucc ).getOid();
+		const Udb::OID pred = d_ancestor.value( predObj );
+		const Udb::OID succ = d_ancestor.value( succObj );
+		if( pred == 0 || succ == 0 )
+		{
+			const bool predSum = d_summaries.contains( predObj );
+			const bool succSum = d_summaries.contains( succObj );
+			if( ( predSum || succSum ) && ( pred != 0 || predSum ) && ( succ != 0 || succSum ) )
+				d_unmapped++; // beide Enden unter root, aber mindestens eines ohne Knoten
+			continue;
+		}
+		if( pred == succ )
+			continue; // innerhalb desselben Knotens
+		const quint8 type = link.getValue( AttrLinkType ).getUInt8();
+		const qint32 lag = ObjectHelper::getLagWorkdays( link, cal );
+		const bool crit = link.getValue( AttrCriticalPath ).getBool();
+		const QPair<Udb::OID,Udb::OID> key( pred, succ );
+		QHash<QPair<Udb::OID,Udb::OID>,int>::const_iterator i = pairs.find( key );
+		if( i == pairs.end() )
+		{
+			CondLink l;
+			l.d_pred = pred;
+			l.d_succ = succ;
+			l.d_type = type;
+			l.d_lag = lag;
+			l.d_count = 1;
+			l.d_critical = crit;
+			pairs.insert( key, d_links.size() );
+			d_links.append( l );
+		}else
+		{
+			CondLink& l = d_links[ i.value() ];
+			if( l.d_type != type )
+				l.d_type = LinkType_FS;
+			l.d_lag = qMax( l.d_lag, lag );
+			l.d_count++;
+			l.d_critical = l.d_critical || crit;
+		}
+	}while( predIdx.next() );
+}
+
+Udb::OID NetCondenser::getAncestor(Udb::OID oid) const
+{
+	return d_ancestor.value( oid );
+}
@@ -0,0 +1,67 @@
+#ifndef NETCONDENSER_H
+#define NETCONDENSER_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <Udb/Obj.h>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+namespace Wt
+{
+	// Verdichtet das Terminnetz unterhalb eines Objekts auf eine bestimmte Ebene der
+	// Task-Hierarchie (AttrSubTMSCount): jedes SchedObj wird auf seinen Vorfahren auf dieser
+	// Ebene abgebildet und die Links zwischen den Blättern werden zu Links zwischen den
+	// Vorfahren zusammengefasst. Ein einziger Durchgang über IdxPred mit Hash-Lookups.
+	// Summary-Tasks oberhalb der Ebene haben keinen Knoten (ihre Knoten liegen darunter); Links
+	// an solche Summaries lassen sich keinem Knoten zuordnen und werden nur gezählt.
+	class NetCondenser
+	{
+	public:
+		struct CondLink
+		{
+			Udb::OID d_pred;
+			Udb::OID d_succ;
+			quint8 d_type; // EnumDef_LinkType; bei gemischten Typen LinkType_FS
+			qint32 d_lag; // grösster Lag in Workdays
+			quint32 d_count; // Anzahl zusammengefasster Links
+			bool d_critical; // mindestens ein zusammengefasster Link auf dem kritischen Pfad
+		};
+		NetCondenser();
+		// depth 0: nur die direkt unter root liegenden SchedObj
+		void condense( const Udb::Obj& root, quint8 depth );
+		const QList<Udb::OID>& getNodes() const { return d_nodes; }
+		const QVector<CondLink>& getLinks() const { return d_links; }
+		Udb::OID getAncestor( Udb::OID ) const; // 0 wenn ausserhalb
+		quint32 getLinkCount() const { return d_scanned; } // Anzahl betrachteter Links
+		quint32 getUnmappedCount() const { return d_unmapped; } // weggelassene Links an Summaries
+	private:
+		void mapSubtree( const Udb::Obj& parent, Udb::OID ancestor, int level, quint8 depth );
+		QHash<Udb::OID,Udb::OID> d_ancestor; // SchedObj -> Knoten
+		QSet<Udb::OID> d_summaries; // Summary-Tasks oberhalb der Ebene
+		QList<Udb::OID> d_nodes;
+		QVector<CondLink> d_links;
+		quint32 d_scanned;
+		quint32 d_unmapped;
+	};
+}
+
+#endif // NETCONDENSER_H
@@ -21,8 +21,10 @@
 #include <Udb/Transaction.h>
 #include <Udb/Database.h>
 #include <Udb/Idx.h>
+#include <QDateTime>
 #include "WorkTreeApp.h"
 #include "WtTypeDefs.h"
+#include "WorkCalendar.h"
 using namespace Wt;
 
 Udb::Obj ObjectHelper::createObject(quint32 type, Udb::Obj parent, const Udb::Obj& before )
@@ -54,39 +56,43 @@ quint32 ObjectHelper::getNextId(Udb::Transaction * txn, quint32 type)
     return root.incCounter( type );
 }
 
-QString ObjectHelper::getNextIdString(Udb::Transaction * txn, quint32 type)
+static const char* _idPrefix( quint32 type )
 {
-    QString prefix;
     switch( type )
     {
     case TypeTask:
-        prefix = QLatin1String("T");
-        break;
+        return "T";
     case TypeMilestone:
-        prefix = QLatin1String("M");
-        break;
+        return "M";
     case TypeImpEvent:
-        prefix = QLatin1String("E");
-        break;
+        return "E";
     case TypeAccomplishment:
-        prefix = QLatin1String("A");
-        break;
+        return "A";
     case TypeCriterion:
-        prefix = QLatin1String("C");
-        break;
+        return "C";
     case TypeLink:
-        prefix = QLatin1String("L");
-        break;
+        return "L";
     case TypeDeliverable:
-        prefix = QLatin1String("D");
-        break;
+        return "D";
     case TypeWork:
-        prefix = QLatin1String("W");
-        break;
+        return "W";
+    default:
+        return 0;
     }
-    if( !prefix.isEmpty() )
-        return QString("%1%2").arg( prefix ).
-                     arg( getNextId( txn, type ), 3, 10, QLatin1Char('0' ) );
+}
+
+QString ObjectHelper::getNextIdString(Udb::Transaction * txn, quint32 type)
+{
+    if( _idPrefix( type ) == 0 )
+        return QString();
+    return formatId( type, getNextId( txn, type ) );
+}
+
+QString ObjectHelper::formatId(quint32 type, quint32 id)
+{
+    const char* prefix = _idPrefix( type );
+    if( prefix != 0 )
+        return QString("%1%2").arg( QLatin1String( prefix ) ).arg( id, 3, 10, QLatin1Char('0' ) );
     else
         return QString();
 }
@@ -255,7 +261,19 @@ void ObjectHelper::setMsType(Udb::Obj & ms, int msType )
 
 typedef QPair<Udb::Obj,int> Pred;
 typedef QHash<Udb::OID,Pred> Visited; // current -> ( Predecessor, path length )
-typedef QMultiHash<Udb::OID,Udb::OID> PredSucc;
+typedef QPair<Udb::OID,qint32> SuccLag; // Successor, Lag in Workdays
+typedef QMultiHash<Udb::OID,SuccLag> PredSucc;
+
+qint32 ObjectHelper::getLagWorkdays( const Udb::Obj& link, const WorkCalendar& cal )
+{
+	const qint32 lag = link.getValue( AttrLag ).getInt32();
+	if( lag == 0 || !link.getValue( AttrLagElapsed ).getBool() )
+		return lag;
+	// Ohne terminierten Vorgnger wird ab heute gezhlt
+	QDate from = link.getValueAsObj( AttrPred ).getValue( AttrEarlyFinish ).getDate();
+	from = ( from.isValid() ) ? from.addDays( 1 ) : QDate::currentDate();
+	return cal.workdaysBetween( from, from.addDays( lag ) );
+}
 
 static void _search( const Udb::Obj& cur, int val, const Udb::Obj& goal,
 					 const PredSucc& predSucc, Visited& visited, ObjectHelper::ShortestPathMethod m )
@@ -281,25 +299,27 @@ static void _search( const Udb::Obj& cur, int val, const Udb::Obj& goal,
 		val = 0xffff; // egal, einfach grosse zahl
 		break;
 	}
+	const bool withLag = m != ObjectHelper::SpmNodeCount && m != ObjectHelper::SpmCriticalPath;
 	PredSucc::const_iterator i = predSucc.find( cur.getOid() );
 	while( i != predSucc.end() && i.key() == cur.getOid() )
 	{
-		Udb::Obj next = cur.getObject( i.value() );
+		Udb::Obj next = cur.getObject( i.value().first );
 		if( m == ObjectHelper::SpmCriticalPath && next.getValue( AttrCriticalPath ).getBool() )
 			val = 0;
-		Pred& p = visited[ i.value() ];
+		const int v = ( withLag )? qMax( 0, val + i.value().second ) : val;
+		Pred& p = visited[ i.value().first ];
 		if( p.first.isNull() )
 		{
 			// Not yet visited
 			p.first = cur;
-			p.second = val;
+			p.second = v;
 			if( !next.equals( goal ) && ( m != ObjectHelper::SpmCriticalPath || val == 0 ) )
-				_search( next, val, goal, predSucc, visited, m );
-		}else if( p.second > val )
+				_search( next, v, goal, predSucc, visited, m );
+		}else if( p.second > v )
 		{
 			// already visited, but shorter path found
 			p.first = cur;
-			p.second = val;
+			p.second = v;
 		}else
 		{
 			// already visited
@@ -335,12 +355,14 @@ QList<Udb::Obj> ObjectHelper::findShortestPath(const Udb::Obj &start, const Udb:
 	// Es gibt dafr keinen schlauen bzw. etablierten Algorithmus ausser rudimentre Suche
 	Visited visited;
 	PredSucc predSucc;
+	const WorkCalendar cal = WorkCalendar::loadDefault( start.getTxn() );
 	Udb::Idx predIdx( start.getTxn(), IndexDefs::IdxPred );
 	if( predIdx.first() ) do
 	{
 		Udb::Obj o = start.getObject( predIdx.getOid() );
 		Q_ASSERT( !o.isNull() );
-		predSucc.insert( o.getValue( AttrPred ).getOid(), o.getValue( AttrSucc ).getOid() );
+		predSucc.insert( o.getValue( AttrPred ).getOid(),
+						 SuccLag( o.getValue( AttrSucc ).getOid(), getLagWorkdays( o, cal ) ) );
 	}while( predIdx.next() );
 	_search( start, 0, goal, predSucc, visited, m );
 	if( !visited.contains( goal.getOid() ) )
@@ -388,3 +410,158 @@ QList<Udb::Obj> ObjectHelper::findPredecessors( const Udb::Obj &item)
 	}while( succIdx.nextKey() );
 	return predecessors;
 }
+
+static void _collectSvts( const Udb::Obj& parent, QList<Udb::Obj>& res )
+{
+	Udb::Obj sub = parent.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		if( sub.getType() == TypeTask && sub.getValue( AttrTaskType ).getUInt8() == TaskType_SVT &&
+				sub.getValue( AttrSubTMSCount ).getUInt32() == 0 )
+			res.append( sub );
+		else if( WtTypeDefs::isImpType( sub.getType() ) )
+			_collectSvts( sub, res );
+	}while( sub.next() );
+}
+
+static QList<Udb::Obj> _findLinks( const Udb::Obj& o, const char* index )
+{
+	QList<Udb::Obj> res;
+	Udb::Idx idx( o.getTxn(), index );
+	if( idx.seek( Stream::DataCell().setOid( o.getOid() ) ) ) do
+	{
+		Udb::Obj link = o.getObject( idx.getOid() );
+		if( !link.isNull() )
+			res.append( link );
+	}while( idx.nextKey() );
+	return res;
+}
+
+int ObjectHelper::collapseSvtChains(Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	QList<Udb::Obj> svts;
+	_collectSvts( txn->getObject( QUuid( WorkTreeApp::s_imp ) ), svts );
+	int count = 0;
+	foreach( Udb::Obj svt, svts )
+	{
+		const QList<Udb::Obj> in = _findLinks( svt, IndexDefs::IdxSucc );
+		const QList<Udb::Obj> out = _findLinks( svt, IndexDefs::IdxPred );
+		if( in.size() != 1 || out.size() != 1 )
+			continue;
+		Udb::Obj inLink = in.first();
+		Udb::Obj outLink = out.first();
+		const quint8 inType = inLink.getValue( AttrLinkType ).getUInt8();
+		const quint8 outType = outLink.getValue( AttrLinkType ).getUInt8();
+		// Nur Ketten, die am Start des SVT ankommen und an seinem Ende weitergehen
+		if( ( inType != LinkType_FS && inType != LinkType_SS ) ||
+				( outType != LinkType_FS && outType != LinkType_FF ) ||
+				inLink.getValue( AttrLagElapsed ).getBool() ||
+				outLink.getValue( AttrLagElapsed ).getBool() )
+			continue;
+		Udb::Obj succ = outLink.getValueAsObj( AttrSucc );
+		if( succ.isNull() || succ.equals( inLink.getValueAsObj( AttrPred ) ) )
+			continue;
+		const bool fromFinish = inType == LinkType_FS;
+		const bool toStart = outType == LinkType_FS;
+		quint8 type;
+		if( fromFinish )
+			type = ( toStart )? LinkType_FS : LinkType_FF;
+		else
+			type = ( toStart )? LinkType_SS : LinkType_SF;
+		const qint32 lag = inLink.getValue( AttrLag ).getInt32() +
+				svt.getValue( AttrDuration ).getUInt16() + outLink.getValue( AttrLag ).getInt32();
+
+		inLink.setValueAsObj( AttrSucc, succ );
+		inLink.setValue( AttrLinkType, Stream::DataCell().setUInt8( type ) );
+		if( lag != 0 )
+			inLink.setValue( AttrLag, Stream::DataCell().setInt32( lag ) );
+		else
+			inLink.clearValue( AttrLag );
+		inLink.setValue( AttrCriticalPath, Stream::DataCell().setBool(
+							 inLink.getValue( AttrCriticalPath ).getBool() &&
+							 outLink.getValue( AttrCriticalPath ).getBool() ) );
+		erase( outLink );
+		erase( svt ); // inLink zeigt nicht mehr auf svt und bleibt deshalb erhalten
+		count++;
+	}
+	return count;
+}
+
+ObjectHelper::BulkCreator::BulkCreator(Udb::Transaction * txn, quint32 reserve ):
+	d_txn(txn),d_reserve(qMax(reserve,quint32(1))),d_count(0)
+{
+	Q_ASSERT( txn != 0 );
+	d_now.setDateTime( QDateTime::currentDateTime() );
+}
+
+quint32 ObjectHelper::BulkCreator::nextId(quint32 type)
+{
+	Range& r = d_ranges[type];
+	if( r.d_next == r.d_end )
+	{
+		// Ein Counter-Update reserviert d_reserve IDs; Werte bis und mit Counter sind vergeben
+		Udb::Obj root = WtTypeDefs::getRoot( d_txn );
+		Q_ASSERT( !root.isNull() );
+		const quint32 cur = root.getValue( type ).getUInt32();
+		root.setValue( type, Stream::DataCell().setUInt32( cur + d_reserve ) );
+		r.d_next = cur + 1;
+		r.d_end = cur + d_reserve + 1;
+	}
+	return r.d_next++;
+}
+
+Udb::Obj ObjectHelper::BulkCreator::createObject(quint32 type, Udb::Obj parent, const Udb::Obj &before)
+{
+	// Entspricht ObjectHelper::createObject
+	Q_ASSERT( !parent.isNull() );
+	Udb::Obj o = parent.createAggregate( type, before );
+	if( WtTypeDefs::canHaveText( type ) )
+		o.setString( AttrText, WtTypeDefs::prettyName( type ) );
+	o.setValue( AttrCreatedOn, d_now );
+	if( _idPrefix( type ) != 0 )
+		o.setString( AttrInternalId, formatId( type, nextId( type ) ) );
+	if( type == TypeTask || type == TypeMilestone )
+		d_counts[parent.getOid()].d_subTms++;
+	else if( type == TypeCalEntry )
+		d_counts[parent.getOid()].d_calEntries++;
+	d_count++;
+	return o;
+}
+
+void ObjectHelper::BulkCreator::flush()
+{
+	QHash<Udb::OID,Counts>::const_iterator i;
+	for( i = d_counts.begin(); i != d_counts.end(); ++i )
+	{
+		Udb::Obj parent = d_txn->getObject( i.key() );
+		if( parent.isNull() )
+			continue; // inzwischen gelscht
+		if( i.value().d_subTms )
+			parent.setValue( AttrSubTMSCount, Stream::DataCell().setUInt32(
+								 parent.getValue( AttrSubTMSCount ).getUInt32() + i.value().d_subTms ) );
+		if( i.value().d_calEntries )
+			parent.setValue( AttrCalEntryCount, Stream::DataCell().setUInt32(
+								 parent.getValue( AttrCalEntryCount ).getUInt32() + i.value().d_calEntries ) );
+	}
+	d_counts.clear();
+	// Nicht verbrauchte IDs zurckgeben, sofern seit der Reservation niemand anders eine bezogen hat
+	QHash<quint32,Range>::const_iterator j;
+	Udb::Obj root;
+	for( j = d_ranges.begin(); j != d_ranges.end(); ++j )
+	{
+		if( j.value().d_next == j.value().d_end )
+			continue;
+		if( root.isNull() )
+			root = WtTypeDefs::getRoot( d_txn );
+		if( root.getValue( j.key() ).getUInt32() == j.value().d_end - 1 )
+			root.setValue( j.key(), Stream::DataCell().setUInt32( j.value().d_next - 1 ) );
+	}
+	d_ranges.clear();
+}
+
+void ObjectHelper::BulkCreator::commit()
+{
+	flush();
+	d_txn->commit();
+}
@@ -21,14 +21,18 @@
 */
 
 #include <Udb/Obj.h>
+#include <QHash>
 
 namespace Wt
 {
+	class WorkCalendar;
+
     struct ObjectHelper
     {
         static Udb::Obj createObject( quint32 type, Udb::Obj parent, const Udb::Obj &before = Udb::Obj() );
         static quint32 getNextId( Udb::Transaction *, quint32 type );
         static QString getNextIdString( Udb::Transaction *, quint32 type );
+        static QString formatId( quint32 type, quint32 id ); // leer wenn type keine ID hat
         static void retypeObject( Udb::Obj& o, quint32 type ); // Prft nicht, ob zulssig!
         static void moveTo( Udb::Obj& o, Udb::Obj& newParent, const Udb::Obj& before ); // Prft nicht, ob zulssig!
         static void erase( Udb::Obj& o );
@@ -40,6 +44,49 @@ namespace Wt
 		static QList<Udb::Obj> findShortestPath( const Udb::Obj& start, const Udb::Obj& goal, ShortestPathMethod meth );
 		static QList<Udb::Obj> findSuccessors( const Udb::Obj& item );
 		static QList<Udb::Obj> findPredecessors( const Udb::Obj& item );
+		// Ersetzt SVT-Tasks mit genau einem Vorgnger- und Nachfolger-Link durch einen Link mit Lag;
+		// gibt die Anzahl entfernter SVTs zurck. Kein commit.
+		static int collapseSvtChains( Udb::Transaction* );
+		// Elapsed Lags werden mit dem Kalender ab dem Ende des Vorgngers in Workdays umgerechnet
+		static qint32 getLagWorkdays( const Udb::Obj& link, const WorkCalendar& );
+
+		// createObject fr viele Objekte (Importer, Lua): IDs werden pro Typ blockweise
+		// reserviert und AttrSubTMSCount bzw. AttrCalEntryCount pro Parent erst in flush()
+		// geschrieben, d.h. ein Counter-Update pro Typ bzw. Parent statt eines pro Objekt.
+		// Bis flush() sind die Counter der Parents nicht aktuell. commit() schliesst eine Portion ab;
+		// der UpdateDispatcher liefert sie jedem Subscriber als einen einzigen Batch mit einem
+		// ObjChange pro neuem Objekt und einem pro Parent, statt einer Notifikation pro Counter-Update.
+		class BulkCreator
+		{
+		public:
+			explicit BulkCreator( Udb::Transaction*, quint32 reserve = 256 );
+			// Kein flush im Destruktor: nach rollback oder Exception gehren die ausstehenden
+			// Counter zu Objekten, die es nicht mehr gibt; sie werden verworfen
+			Udb::Obj createObject( quint32 type, Udb::Obj parent, const Udb::Obj &before = Udb::Obj() );
+			void flush(); // vor jedem commit aufrufen
+			void commit(); // flush() und commit der Transaktion
+			int getCount() const { return d_count; }
+		private:
+			struct Range
+			{
+				quint32 d_next;
+				quint32 d_end; // exklusiv
+				Range():d_next(0),d_end(0){}
+			};
+			struct Counts
+			{
+				quint32 d_subTms;
+				quint32 d_calEntries;
+				Counts():d_subTms(0),d_calEntries(0){}
+			};
+			quint32 nextId( quint32 type );
+			Udb::Transaction* d_txn;
+			QHash<quint32,Range> d_ranges;
+			QHash<Udb::OID,Counts> d_counts; // Parent -> ausstehende Inkremente
+			Stream::DataCell d_now;
+			quint32 d_reserve;
+			int d_count;
+		};
 	};
 }
 
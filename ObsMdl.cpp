@@ -24,6 +24,7 @@ using namespace Wt;
 ObsMdl::ObsMdl(QObject *parent) :
     GenericMdl(parent)
 {
+    setLazy( true );
 }
 
 bool ObsMdl::isSupportedType(quint32 type)
@@ -490,6 +490,11 @@ void PdmCtrl::onDeleteItems()
     QList<Udb::Obj> sel = d_mdl->getMultiSelection();
     foreach( Udb::Obj o, sel )
     {
+        if( PdmItemObj( o ).isCondensed() )
+        {
+            o.erase(); // verdichtete Links existieren nur auf dem Diagramm
+            continue;
+        }
         Udb::Obj hidden = o.getValueAsObj( AttrOrigObject );
         ObjectHelper::erase( hidden );
     }
@@ -83,6 +83,39 @@ QGraphicsItem* PdmItemMdl::fetchItemFromDb( const Udb::Obj& obj, bool links, boo
 {
 	PdmItemObj pdmItem = obj;
     Q_ASSERT( pdmItem.getType() == TypePdmItem );
+    if( pdmItem.isCondensed() )
+    {
+        // Verdichteter Link ohne Original, siehe PdmItemObj::createCondensedDiagram
+        if( !links )
+            return 0;
+        PdmNode* start = dynamic_cast<PdmNode*>(
+                             d_cache.value( pdmItem.getValue( AttrCondPred ).getOid() ) );
+        PdmNode* end = dynamic_cast<PdmNode*>(
+                           d_cache.value( pdmItem.getValue( AttrCondSucc ).getOid() ) );
+        if( start == 0 || end == 0 )
+        {
+            d_orphans.append( obj );
+            return 0;
+        }
+        const QString tip = tr("%1 condensed links").arg( pdmItem.getValue( AttrLinkCondensed ).getUInt32() );
+        const bool critical = pdmItem.getValue( AttrCriticalPath ).getBool();
+        QPolygonF nl = pdmItem.getNodeList();
+        for( int j = 0; j < nl.size(); j++ )
+        {
+            PdmNode* n = new PdmNode(0,0,PdmNode::LinkHandle);
+            n->setPos( nl[j] );
+            addItem( n );
+            LineSegment* s = addSegment( start, n );
+            s->setToolTip( tip );
+            s->setCritical( critical );
+            start = n;
+        }
+        LineSegment* lastSegment = addSegment( start, end, pdmItem );
+        lastSegment->setTypeCode( WtTypeDefs::formatLinkCode( pdmItem ) );
+        lastSegment->setToolTip( tip );
+        lastSegment->setCritical( critical );
+        return lastSegment;
+    }
     const Udb::Obj orig = pdmItem.getValueAsObj( AttrOrigObject );
     if( orig.isNull( true ) )
     {
@@ -146,8 +179,7 @@ QGraphicsItem* PdmItemMdl::fetchItemFromDb( const Udb::Obj& obj, bool links, boo
 				start = n;
 			}
 			LineSegment* lastSegment = addSegment( start, end, pdmItem );
-            lastSegment->setTypeCode(
-                        WtTypeDefs::formatLinkType( orig.getValue( AttrLinkType ).getUInt8(), true ) );
+            lastSegment->setTypeCode( WtTypeDefs::formatLinkCode( orig ) );
             lastSegment->setToolTip( WtTypeDefs::formatObjectTitle( orig ) );
             lastSegment->setCritical( orig.getValue( AttrCriticalPath ).getBool() );
             return lastSegment;
@@ -202,7 +234,7 @@ void PdmItemMdl::setDiagram( const Udb::Obj& doc )
 	if( d_doc.equals( doc ) )
 		return;
 	if( !d_doc.isNull() )
-		d_doc.getDb()->removeObserver( this, SLOT( onDbUpdate( Udb::UpdateInfo ) ) );
+		UpdateDispatcher::inst( d_doc.getTxn() )->unsubscribe( this );
 	clear();
 	d_cache.clear();
 	d_doc = doc;
@@ -231,7 +263,15 @@ void PdmItemMdl::setDiagram( const Udb::Obj& doc )
             d_orphans.clear();
             d_doc.commit();
         }
-		d_doc.getDb()->addObserver( this, SLOT( onDbUpdate( Udb::UpdateInfo ) ), false ); // neu synchron
+		// Synchron in commit; Items des Diagramms ber den Parent, Originale ber die dargestellten Attribute
+		UpdateDispatcher* disp = UpdateDispatcher::inst( d_doc.getTxn() );
+		disp->subscribe( this, SLOT( onDbUpdates( Wt::UpdateBatch ) ),
+						 ObjChange::Erased | ObjChange::TypeChanged );
+		disp->observeChildren( this, d_doc.getOid() );
+		const quint32 atoms[] = { AttrText, AttrInternalId, AttrCustomId, AttrLinkType, AttrLag,
+								  AttrLagElapsed, AttrSubTMSCount, AttrTaskType, AttrMsType, AttrCriticalPath };
+		for( int i = 0; i < int( sizeof(atoms) / sizeof(atoms[0]) ); i++ )
+			disp->observeAtom( this, atoms[i] );
 
         fitSceneRect();
         // qDebug() << "#Items" << items().size();
@@ -601,7 +641,8 @@ LineSegment* PdmItemMdl::addSegment( PdmNode* from, PdmNode* to, const Udb::Obj
 	if( !pdmItem.isNull() )
     {
         d_cache[ segment->getItemOid() ] = segment;
-        d_cache[ origID ] = segment;
+        if( origID != 0 ) // verdichtete Links haben kein Original
+            d_cache[ origID ] = segment;
     }
 	return segment;
 }
@@ -781,15 +822,36 @@ void PdmItemMdl::setItemText( QGraphicsItem* i, const QString& str )
 	}
 }
 
-void PdmItemMdl::onDbUpdate( Udb::UpdateInfo info )
+void PdmItemMdl::onDbUpdates( const Wt::UpdateBatch& batch )
 {
 	Q_ASSERT( !d_doc.isNull() );
-	switch( info.d_kind )
+	foreach( const ObjChange& c, batch )
+	{
+		// Reihenfolge wie bei den einzelnen Notifikationen von Udb
+		if( c.is( ObjChange::Deaggregated ) )
+			handleChange( ObjChange::Deaggregated, c, 0 );
+		if( c.is( ObjChange::Erased ) )
+		{
+			handleChange( ObjChange::Erased, c, c.d_type );
+			continue; // Alles weitere betrifft ein nicht mehr existierendes Objekt
+		}
+		if( c.is( ObjChange::TypeChanged ) )
+			handleChange( ObjChange::TypeChanged, c, c.d_type );
+		foreach( quint32 atom, c.d_atoms )
+			handleChange( ObjChange::ValueChanged, c, atom );
+		if( c.is( ObjChange::Aggregated ) )
+			handleChange( ObjChange::Aggregated, c, 0 );
+	}
+}
+
+void PdmItemMdl::handleChange( quint8 kind, const ObjChange& c, quint32 name )
+{
+	switch( kind )
 	{
-	case Udb::UpdateInfo::TypeChanged:
-        if( info.d_name == TypeTask || info.d_name == TypeMilestone )
+	case ObjChange::TypeChanged:
+        if( name == TypeTask || name == TypeMilestone )
         {
-            QGraphicsItem* i = d_cache.value( info.d_id );
+            QGraphicsItem* i = d_cache.value( c.d_id );
             if( i!= 0 )
             {
                 switch( i->type() )
@@ -798,7 +860,7 @@ void PdmItemMdl::onDbUpdate( Udb::UpdateInfo info )
                 case PdmNode::Milestone:
                     {
                         PdmNode* item = static_cast<PdmNode*>( i );
-                        switch( info.d_name )
+                        switch( name )
                         {
                         case TypeTask:
                             item->setType( PdmNode::Task );
@@ -815,83 +877,83 @@ void PdmItemMdl::onDbUpdate( Udb::UpdateInfo info )
             }
         }
 		break;
-	case Udb::UpdateInfo::ValueChanged:
-		if( info.d_name == AttrText || info.d_name == AttrInternalId
-                || info.d_name == AttrCustomId )
+	case ObjChange::ValueChanged:
+		if( name == AttrText || name == AttrInternalId
+                || name == AttrCustomId )
 		{
-            QGraphicsItem* gi = d_cache.value( info.d_id );
+            QGraphicsItem* gi = d_cache.value( c.d_id );
             PdmNode* pi = dynamic_cast<PdmNode*>( gi );
             LineSegment* ls = dynamic_cast<LineSegment*>( gi );
-            if( pi && pi->getOrigOid() == info.d_id )
+            if( pi && pi->getOrigOid() == c.d_id )
             {
-				Udb::Obj o = d_doc.getObject( info.d_id );
+				Udb::Obj o = d_doc.getObject( c.d_id );
                 fetchAttributes( pi, o );
 				pi->update();
-            }else if( ls && ls->getOrigOid() == info.d_id )
+            }else if( ls && ls->getOrigOid() == c.d_id )
             {
-                Udb::Obj o = d_doc.getObject( info.d_id );
+                Udb::Obj o = d_doc.getObject( c.d_id );
                 ls->setToolTip( WtTypeDefs::formatObjectTitle( o ) );
                 ls->update();
             }
-        }else if( info.d_name == AttrLinkType )
+        }else if( name == AttrLinkType || name == AttrLag || name == AttrLagElapsed )
         {
-            LineSegment* ls = dynamic_cast<LineSegment*>( d_cache.value( info.d_id ) );
-            if( ls && ls->getOrigOid() == info.d_id )
+            LineSegment* ls = dynamic_cast<LineSegment*>( d_cache.value( c.d_id ) );
+            if( ls && ( ls->getOrigOid() == c.d_id || ls->getOrigOid() == 0 ) )
             {
-                Udb::Obj o = d_doc.getObject( info.d_id );
-                ls->setTypeCode( WtTypeDefs::formatLinkType( o.getValue( AttrLinkType ).getUInt8(), true ) );
+                Udb::Obj o = d_doc.getObject( c.d_id );
+                ls->setTypeCode( WtTypeDefs::formatLinkCode( o ) );
                 ls->update();
             }
-        }else if( info.d_name == AttrSubTMSCount )
+        }else if( name == AttrSubTMSCount )
         {
-            PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( info.d_id ) );
+            PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( c.d_id ) );
             if( pi )
             {
-                Udb::Obj o = d_doc.getObject( info.d_id );
+                Udb::Obj o = d_doc.getObject( c.d_id );
                 pi->setSubtasks( o.getValue( AttrSubTMSCount ).getUInt32() > 0 );
                 pi->update();
             }
-        }else if( info.d_name == AttrTaskType )
+        }else if( name == AttrTaskType )
         {
-            PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( info.d_id ) );
+            PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( c.d_id ) );
             if( pi && pi->type() == PdmNode::Task )
             {
-                Udb::Obj o = d_doc.getObject( info.d_id );
+                Udb::Obj o = d_doc.getObject( c.d_id );
                 pi->setCode( o.getValue( AttrTaskType ).getUInt8() );
                 pi->update();
             }
-        }else if( info.d_name == AttrMsType )
+        }else if( name == AttrMsType )
         {
-            PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( info.d_id ) );
+            PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( c.d_id ) );
             if( pi && pi->type() == PdmNode::Milestone )
             {
-                Udb::Obj o = d_doc.getObject( info.d_id );
+                Udb::Obj o = d_doc.getObject( c.d_id );
                 pi->setCode( o.getValue( AttrMsType ).getUInt8() );
                 pi->update();
             }
-        }else if( info.d_name == AttrPosX || info.d_name == AttrPosY )
+        }else if( name == AttrPosX || name == AttrPosY )
         {
             // Unntig, da setDiagram nach layout
-//            PdmItem* pi = dynamic_cast<PdmItem*>( d_cache.value( info.d_id ) );
+//            PdmItem* pi = dynamic_cast<PdmItem*>( d_cache.value( c.d_id ) );
 //            if( pi )
 //            {
-//                PdmItemObj o = d_doc.getObject( info.d_id );
+//                PdmItemObj o = d_doc.getObject( c.d_id );
 //                pi->setPos( o.getPos() );
 //                pi->update();
 //            }
-        }else if( info.d_name == AttrPointList )
+        }else if( name == AttrPointList )
         {
             // Unntig, da setDiagram nach layout
-        }else if( info.d_name == AttrCriticalPath )
+        }else if( name == AttrCriticalPath )
         {
-            if( PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( info.d_id ) ) )
+            if( PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( c.d_id ) ) )
             {
-                Udb::Obj o = d_doc.getObject( info.d_id );
+                Udb::Obj o = d_doc.getObject( c.d_id );
                 pi->setCritical( o.getValue( AttrCriticalPath ).getBool() );
                 pi->update();
-            }else if( LineSegment* ls = dynamic_cast<LineSegment*>( d_cache.value( info.d_id ) ) )
+            }else if( LineSegment* ls = dynamic_cast<LineSegment*>( d_cache.value( c.d_id ) ) )
             {
-                Udb::Obj o = d_doc.getObject( info.d_id );
+                Udb::Obj o = d_doc.getObject( c.d_id );
                 const bool isCritical = o.getValue( AttrCriticalPath ).getBool();
                 QList<LineSegment*> list = ls->getChain();
                 foreach( LineSegment* l, list )
@@ -902,9 +964,9 @@ void PdmItemMdl::onDbUpdate( Udb::UpdateInfo info )
             }
         }
         break;
-    case Udb::UpdateInfo::ObjectErased:
+    case ObjChange::Erased:
         {
-            QGraphicsItem* i = d_cache.value( info.d_id );
+            QGraphicsItem* i = d_cache.value( c.d_id );
             if( i!= 0 )
             {
                 // TODO: wird hier Item aus Cache entfernt?
@@ -926,10 +988,10 @@ void PdmItemMdl::onDbUpdate( Udb::UpdateInfo info )
             }
         }
         break;
-    case Udb::UpdateInfo::Aggregated:
-        if( info.d_parent == d_doc.getOid() )
+    case ObjChange::Aggregated:
+        if( c.d_parent == d_doc.getOid() )
         {
-            PdmItemObj pdmItem = d_doc.getObject( info.d_id );
+            PdmItemObj pdmItem = d_doc.getObject( c.d_id );
             if( pdmItem.getType() == TypePdmItem )
             {
                 fetchItemFromDb( pdmItem, true, true );
@@ -937,8 +999,8 @@ void PdmItemMdl::onDbUpdate( Udb::UpdateInfo info )
             }else
             {
                 Q_ASSERT( pdmItem.getType() != TypePdmItem );
-                PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( info.d_id ) );
-                if( pi && pi->getOrigOid() == info.d_id )
+                PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( c.d_id ) );
+                if( pi && pi->getOrigOid() == c.d_id )
                 {
                     pi->setAlias( false );
                     pi->update();
@@ -946,11 +1008,11 @@ void PdmItemMdl::onDbUpdate( Udb::UpdateInfo info )
             }
         }
         break;
-    case Udb::UpdateInfo::Deaggregated:
-        if( info.d_parent == d_doc.getOid() )
+    case ObjChange::Deaggregated:
+        if( c.d_oldParent == d_doc.getOid() )
         {
-            PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( info.d_id ) );
-            if( pi && pi->getOrigOid() == info.d_id )
+            PdmNode* pi = dynamic_cast<PdmNode*>( d_cache.value( c.d_id ) );
+            if( pi && pi->getOrigOid() == c.d_id )
             {
                 pi->setAlias( true );
                 pi->update();
@@ -23,6 +23,7 @@
 #include <QGraphicsScene>
 #include <QHash>
 #include <Udb/Obj.h>
+#include "UpdateDispatcher.h"
 
 class QMimeData;
 
@@ -94,6 +95,7 @@ namespace Wt
 		QPolygonF getNodeList( QGraphicsItem* ) const;
 		QGraphicsItem* fetchItemFromDb( const Udb::Obj&, bool links, bool vertices );
 		void fetchAttributes( PdmNode*, const Udb::Obj& ) const;
+		void handleChange( quint8 kind, const ObjChange&, quint32 name );
 		// overrides
 		void mousePressEvent(QGraphicsSceneMouseEvent *mouseEvent);
 		void mouseMoveEvent(QGraphicsSceneMouseEvent *mouseEvent);
@@ -106,7 +108,7 @@ namespace Wt
         void drawItems(QPainter *painter, int numItems, QGraphicsItem *items[],
                        const QStyleOptionGraphicsItem options[], QWidget *widget);
 	protected slots:
-		void onDbUpdate( Udb::UpdateInfo );
+		void onDbUpdates( const Wt::UpdateBatch& );
 	private:
 		QPointF d_startPos;
 		QPointF d_lastPos;
@@ -28,6 +28,7 @@
 #include "PdmItems.h"
 #include "WtTypeDefs.h"
 #include "ObjectHelper.h"
+#include "NetCondenser.h"
 #include <QtDebug>
 using namespace Wt;
 
@@ -102,6 +103,11 @@ Udb::Obj PdmItemObj::getOrig() const
     return getValueAsObj( AttrOrigObject );
 }
 
+bool PdmItemObj::isCondensed() const
+{
+    return getValue( AttrLinkCondensed ).getUInt32() != 0;
+}
+
 PdmItemObj PdmItemObj::createLink(Udb::Obj diagram, Obj pred, const Obj &succ)
 {
     Q_ASSERT( !diagram.isNull() );
@@ -415,6 +421,8 @@ QList<Udb::Obj> PdmItemObj::writeItems(const QList<Udb::Obj> &items, Stream::Dat
     QList<Udb::Obj> origs;
     foreach( Udb::Obj o, items )
 	{
+        if( PdmItemObj( o ).isCondensed() )
+            continue; // hat kein Original, wird nicht kopiert
         if( o.getValueAsObj(AttrOrigObject).getType() != TypeLink )
         {
             out1.startFrame( Stream::NameTag( "item" ) );
@@ -541,3 +549,48 @@ bool PdmItemObj::createDiagram(Udb::Obj diagram, bool recreate, bool layout,
 	return true;
 }
 
+
+void PdmItemObj::createCondensedDiagram(Udb::Obj diagram, const NetCondenser & c, bool recreate, bool layout)
+{
+	Q_ASSERT( !diagram.isNull() );
+	if( recreate )
+		removeAllItems( diagram );
+	QList<Udb::Obj> objs;
+	foreach( Udb::OID oid, c.getNodes() )
+		objs.append( diagram.getObject( oid ) );
+	addItemsToDiagram( diagram, objs, QPointF(0,0) );
+
+	// Die verdichteten Links sind keine TypeLink, sondern PdmItems ohne Original; damit
+	// erscheinen sie weder in IdxPred/IdxSucc noch in der Pfadsuche oder im Scheduler.
+	QHash<QPair<Udb::OID,Udb::OID>,PdmItemObj> existing;
+	PdmItemObj sub = diagram.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		if( sub.getType() == TypePdmItem && sub.isCondensed() )
+			existing.insert( qMakePair( sub.getValue( AttrCondPred ).getOid(),
+										sub.getValue( AttrCondSucc ).getOid() ), sub );
+	}while( sub.next() );
+	foreach( const NetCondenser::CondLink& l, c.getLinks() )
+	{
+		PdmItemObj item = existing.take( qMakePair( l.d_pred, l.d_succ ) );
+		if( item.isNull() )
+		{
+			item = diagram.createAggregate( TypePdmItem );
+			item.setTimeStamp( AttrCreatedOn );
+			item.setValue( AttrCondPred, Stream::DataCell().setOid( l.d_pred ) );
+			item.setValue( AttrCondSucc, Stream::DataCell().setOid( l.d_succ ) );
+		}
+		item.setValue( AttrLinkType, Stream::DataCell().setUInt8( l.d_type ) );
+		if( l.d_lag != 0 )
+			item.setValue( AttrLag, Stream::DataCell().setInt32( l.d_lag ) );
+		else
+			item.clearValue( AttrLag );
+		item.setValue( AttrLinkCondensed, Stream::DataCell().setUInt32( l.d_count ) );
+		item.setValue( AttrCriticalPath, Stream::DataCell().setBool( l.d_critical ) );
+		item.setTimeStamp( AttrModifiedOn );
+	}
+	foreach( PdmItemObj stale, existing )
+		stale.erase();
+	if( layout )
+		s_layouter.layoutDiagram( diagram, false, false );
+}
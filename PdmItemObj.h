@@ -28,6 +28,8 @@ class QProgressDialog;
 
 namespace Wt
 {
+	class NetCondenser;
+
 	class PdmItemObj : public Udb::Obj
 	{
 	public:
@@ -42,8 +44,12 @@ namespace Wt
         bool hasNodeList() const;
         void setOrig( const Udb::Obj& orig );
         Udb::Obj getOrig() const;
+        bool isCondensed() const; // verdichteter Link ohne Original, siehe createCondensedDiagram
         static bool createDiagram( Udb::Obj diagram, bool recreate, bool layout, bool recursive,
                                    quint8 levels, bool toSucc, bool toPred, QProgressDialog* pg );
+        // Diagramm aus NetCondenser; die verdichteten Links sind reine Diagrammelemente und werden
+        // wiederverwendet, angelegt oder, falls nicht mehr vorhanden, gelscht
+        static void createCondensedDiagram( Udb::Obj diagram, const NetCondenser&, bool recreate, bool layout );
         static PdmItemObj createLink( Udb::Obj diagram, Udb::Obj pred, const Udb::Obj& succ );
         static PdmItemObj createItemObj( Udb::Obj diagram, Udb::Obj other, const QPointF& = QPointF() );
         static void removeAllItems( const Obj &diagram );
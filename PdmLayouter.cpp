@@ -189,7 +189,7 @@ bool PdmLayouter::layoutDiagram(const Udb::Obj & diagram, bool ortho, bool topTo
         if( sub.getType() == TypePdmItem )
         {
             Udb::Obj orig = sub.getValueAsObj( AttrOrigObject );
-            if( orig.getType() != TypeLink )
+            if( orig.getType() != TypeLink && !PdmItemObj( sub ).isCondensed() )
             {
                 Agnode_t* n = d_ctx->agnode( G, QByteArray::number( sub.getOid() ), 1 );
                 Q_ASSERT( n != 0 );
@@ -204,18 +204,25 @@ bool PdmLayouter::layoutDiagram(const Udb::Obj & diagram, bool ortho, bool topTo
         if( sub.getType() == TypePdmItem )
         {
             Udb::Obj link = sub.getValueAsObj( AttrOrigObject );
+            Agnode_t* pred = 0;
+            Agnode_t* succ = 0;
             if( link.getType() == TypeLink )
             {
-                Agnode_t* pred = nodeCache.value( link.getValue( AttrPred ).getOid() );
-                Agnode_t* succ = nodeCache.value( link.getValue( AttrSucc ).getOid() );
-                // Wenn man Nodes lscht, knnen verwaiste PdmItems brigbleiben bis zum nchsten ffnen.
-                if( pred && succ )
-                {
-                    Agedge_t* e = d_ctx->agedge( G, pred, succ, QByteArray::number( sub.getOid() ), 1 );
-                    Q_ASSERT( e != 0 );
-                    edgeList.append( e );
-                    // TEST d_ctx->agset( e, "label", QByteArray::number( sub.getOid() ) );
-                }
+                pred = nodeCache.value( link.getValue( AttrPred ).getOid() );
+                succ = nodeCache.value( link.getValue( AttrSucc ).getOid() );
+            }else if( PdmItemObj( sub ).isCondensed() )
+            {
+                // Verdichteter Link ohne Original, siehe PdmItemObj::createCondensedDiagram
+                pred = nodeCache.value( sub.getValue( AttrCondPred ).getOid() );
+                succ = nodeCache.value( sub.getValue( AttrCondSucc ).getOid() );
+            }
+            // Wenn man Nodes lscht, knnen verwaiste PdmItems brigbleiben bis zum nchsten ffnen.
+            if( pred && succ )
+            {
+                Agedge_t* e = d_ctx->agedge( G, pred, succ, QByteArray::number( sub.getOid() ), 1 );
+                Q_ASSERT( e != 0 );
+                edgeList.append( e );
+                // TEST d_ctx->agset( e, "label", QByteArray::number( sub.getOid() ) );
             }
         }
     }while( sub.next() );
@@ -61,7 +61,7 @@ public:
 };
 
 PdmLinkViewCtrl::PdmLinkViewCtrl(QWidget *parent) :
-    QObject(parent),d_view(0)
+    QObject(parent),d_view(0),d_deferred(false)
 {
 }
 
@@ -90,7 +90,7 @@ Wt::PdmLinkViewCtrl *Wt::PdmLinkViewCtrl::create(QWidget *parent,Udb::Transactio
     connect( ctrl->d_list, SIGNAL(itemDoubleClicked(QListWidgetItem*)), ctrl,SLOT(onDblClick(QListWidgetItem*)));
     connect( ctrl->d_title, SIGNAL(signalClicked()), ctrl, SLOT(onTitleClick()) );
 
-    txn->getDb()->addObserver( ctrl, SLOT( onDbUpdate( Udb::UpdateInfo ) ) );
+    UpdateDispatcher::inst( txn )->subscribe( ctrl, SLOT( onDbUpdates( Wt::UpdateBatch ) ), ObjChange::Erased );
 
     return ctrl;
 }
@@ -99,6 +99,11 @@ void Wt::PdmLinkViewCtrl::setObj(const Udb::Obj & o)
 {
     if( o.getType() == TypeLink )
         return;
+    if( d_deferred )
+    {
+        d_pending = o;
+        return;
+    }
 
     d_title->setObj( o );
     d_list->clear();
@@ -120,6 +125,15 @@ void Wt::PdmLinkViewCtrl::setObj(const Udb::Obj & o)
     markObservedLinks();
 }
 
+void PdmLinkViewCtrl::populate()
+{
+    if( !d_deferred )
+        return;
+    d_deferred = false;
+    setObj( d_pending );
+    d_pending = Udb::Obj();
+}
+
 void PdmLinkViewCtrl::clear()
 {
     d_title->setObj( Udb::Obj() );
@@ -156,6 +170,7 @@ void Wt::PdmLinkViewCtrl::addCommands(Gui2::AutoMenu * pop)
 
 void PdmLinkViewCtrl::showLink(const Udb::Obj & link)
 {
+    populate();
     for( int i = 0; i < d_list->count(); i++ )
     {
         if( d_list->item(i)->data(LinkRole).toULongLong() == link.getOid() )
@@ -173,23 +188,23 @@ void PdmLinkViewCtrl::setObserved(PdmItemView * v)
     markObservedLinks();
 }
 
-void Wt::PdmLinkViewCtrl::onDbUpdate(Udb::UpdateInfo info)
+void Wt::PdmLinkViewCtrl::onDbUpdates(const Wt::UpdateBatch & batch)
 {
-    switch( info.d_kind )
-	{
-    case Udb::UpdateInfo::ObjectErased:
-        if( info.d_id == d_title->getObj().getOid() )
+    foreach( const ObjChange& c, batch )
+    {
+        if( c.d_id == d_title->getObj().getOid() )
+        {
             clear();
-        else if( info.d_name == TypeLink )
+            return;
+        }else if( c.d_type == TypeLink )
         {
             for( int i = 0; i < d_list->count(); i++ )
-                if( d_list->item(i)->data(LinkRole).toULongLong() == info.d_id )
+                if( d_list->item(i)->data(LinkRole).toULongLong() == c.d_id )
                 {
                     delete d_list->item(i);
-                    return;
+                    break;
                 }
         }
-        break;
     }
 }
 
@@ -281,7 +296,7 @@ void PdmLinkViewCtrl::onCopy()
 static inline QString _formatLink( const Udb::Obj& link, const Udb::Obj& peer )
 {
     return QString("%1 %2 / %3").arg( WtTypeDefs::formatObjectId( link ) ).
-            arg( WtTypeDefs::formatLinkType( link.getValue( AttrLinkType ).getUInt8(),true ) ).
+            arg( WtTypeDefs::formatLinkCode( link ) ).
             arg( WtTypeDefs::formatObjectTitle( peer ) );
 }
 
@@ -22,7 +22,7 @@
 
 #include <QObject>
 #include <Udb/Obj.h>
-#include <Udb/UpdateInfo.h>
+#include "UpdateDispatcher.h"
 #include <Gui2/AutoMenu.h>
 
 class QListWidget;
@@ -41,6 +41,8 @@ namespace Wt
 
         static PdmLinkViewCtrl* create(QWidget* parent,Udb::Transaction *txn );
         void setObj( const Udb::Obj& );
+        // deferred: setObj merkt sich das Objekt nur, populate() zeigt es an
+        void setDeferred( bool on ) { d_deferred = on; }
         void clear();
         QWidget* getWidget() const;
         void addCommands( Gui2::AutoMenu* );
@@ -48,8 +50,10 @@ namespace Wt
         void setObserved( PdmItemView* );
     signals:
         void signalSelect( const Udb::Obj&, bool open );
+    public slots:
+        void populate();
     protected slots:
-        void onDbUpdate( Udb::UpdateInfo info );
+        void onDbUpdates( const Wt::UpdateBatch& );
         void onClicked(QListWidgetItem*);
         void onDblClick(QListWidgetItem*);
         void onShowLink();
@@ -65,6 +69,8 @@ namespace Wt
         ObjectTitleFrame* d_title;
         QListWidget* d_list;
         PdmItemView* d_view;
+        Udb::Obj d_pending;
+        bool d_deferred;
     };
 }
 
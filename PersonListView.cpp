@@ -45,8 +45,12 @@
 #include <QGroupBox>
 #include <QLabel>
 #include <QListWidget>
+#include <QTimer>
 using namespace Wt;
 
+static const int s_pageSize = 100; // Slots pro fetchMore
+static const int s_typingDelay = 150; // ms
+
 // Von MasterPlan bernommen; 1:1, CRUD-Funktionen entfernt
 
 class _PersListViewTabBar : public QTabBar
@@ -105,6 +109,12 @@ PersonListView::PersonListView( QWidget* p, Flags showOption, Flags checkOption,
 	d_search = new QLineEdit( this );
 	hbox2->addWidget( d_search );
 	connect( d_search, SIGNAL(returnPressed ()), this, SLOT(onSearch()) );
+	d_delay = new QTimer( this );
+	d_delay->setSingleShot( true );
+	d_delay->setInterval( s_typingDelay );
+	connect( d_delay, SIGNAL(timeout()), this, SLOT(onSearch()) );
+	// Jeder Tastendruck startet den Timer neu; veraltete Suchen finden also gar nicht statt
+	connect( d_search, SIGNAL(textEdited(QString)), d_delay, SLOT(start()) );
 
 	QPushButton* pb = new QPushButton( tr("&Find"), this );
 	pb->setMinimumHeight( 1 );
@@ -269,6 +279,7 @@ void PersonListView::showAll()
 
 void PersonListView::onSearch()
 {
+	d_delay->stop();
 	QString str = d_search->text();
 	if( str == "*" )
 		str = "";
@@ -277,11 +288,17 @@ void PersonListView::onSearch()
 
 }
 
-PersonListMdl::PersonListMdl( QObject* p, Udb::Transaction * txn ):QAbstractItemModel(p),d_txn(txn)
+PersonListMdl::PersonListMdl( QObject* p, Udb::Transaction * txn ):QAbstractItemModel(p),d_txn(txn),d_cursor(0),
+	d_loaded(false)
 {
     Q_ASSERT( txn != 0 );
 }
 
+PersonListMdl::~PersonListMdl()
+{
+	closeCursor();
+}
+
 QModelIndex PersonListMdl::parent ( const QModelIndex & index ) const
 {
 	if( index.isValid() )
@@ -358,25 +375,107 @@ Udb::Obj PersonListMdl::getObject( const QModelIndex& i ) const
         return Udb::Obj();
 }
 
+static QString _fold( const QString& str )
+{
+	// Nherung an IndexMeta::NFKD_CanonicalBase: zerlegen, Akzente weglassen, Kleinbuchstaben
+	const QString d = str.normalized( QString::NormalizationForm_KD );
+	QString res;
+	res.reserve( d.size() );
+	for( int i = 0; i < d.size(); i++ )
+		if( d[i].category() != QChar::Mark_NonSpacing )
+			res.append( d[i].toLower() );
+	return res;
+}
+
+void PersonListMdl::closeCursor()
+{
+	if( d_cursor )
+		delete d_cursor;
+	d_cursor = 0;
+}
+
 void PersonListMdl::refill()
 {
-	// TODO: incremental fetch
+	// Ldt nur die erste Seite; den Rest holt die View mit fetchMore beim Scrollen
+	closeCursor();
     d_root.clear();
-	Udb::Idx idx( d_txn, IndexDefs::IdxPrincipalFirstName );
-	if( idx.seek( Stream::DataCell().setString( d_pattern, false ) ) ) do
+	d_last.clear();
+	d_key = _fold( d_pattern );
+	d_loaded = true;
+	d_cursor = new Udb::Idx( d_txn, IndexDefs::IdxPrincipalFirstName );
+	if( !d_cursor->seek( Stream::DataCell().setString( d_pattern, false ) ) )
+		closeCursor();
+	reset();
+	fetchPage();
+}
+
+void PersonListMdl::fetchPage()
+{
+	// RISK: der Cursor bleibt ber Commits hinweg offen; neue oder umbenannte Principals
+	// erscheinen erst mit dem nchsten refill
+	QList<Udb::Obj> page;
+	while( d_cursor != 0 && page.size() < s_pageSize )
 	{
-		Udb::Obj o = d_txn->getObject( idx.getOid() );
-		if( d_types.contains( o.getType() ) )
+		Udb::Obj o = d_txn->getObject( d_cursor->getOid() );
+		const bool more = d_cursor->nextKey();
+		d_last = _fold( o.getString( AttrPrincipalName ) );
+		if( !d_last.startsWith( d_key ) )
 		{
-			Slot* s = new Slot( &d_root );
-			s->d_obj = o;
+			closeCursor(); // die Keys sind sortiert, der Prfix-Bereich ist zu Ende
+			break;
 		}
-	}while( idx.nextKey() );
-	reset();
+		if( d_types.contains( o.getType() ) )
+			page.append( o );
+		if( !more )
+			closeCursor();
+	}
+	if( page.isEmpty() )
+		return;
+	const int first = d_root.d_children.size();
+	beginInsertRows( QModelIndex(), first, first + page.size() - 1 );
+	foreach( const Udb::Obj& o, page )
+	{
+		Slot* s = new Slot( &d_root );
+		s->d_obj = o;
+	}
+	endInsertRows();
+}
+
+bool PersonListMdl::canFetchMore( const QModelIndex & parent ) const
+{
+	return !parent.isValid() && d_cursor != 0;
+}
+
+void PersonListMdl::fetchMore( const QModelIndex & parent )
+{
+	if( !parent.isValid() )
+		fetchPage();
 }
 
 void PersonListMdl::seek( const QString& str )
 {
+	const QString key = _fold( str );
+	// Verlngerter Prfix: die geladenen Slots sind eine Obermenge der Treffer; filtern gengt,
+	// sofern der Cursor den neuen Bereich noch nicht verlassen hat
+	if( d_loaded && key.size() > d_key.size() && key.startsWith( d_key ) &&
+			( d_cursor == 0 || d_last.startsWith( key ) ) )
+	{
+		d_pattern = str;
+		d_key = key;
+		QList<Slot*> keep;
+		foreach( Slot* s, d_root.d_children )
+		{
+			if( _fold( s->d_obj.getString( AttrPrincipalName ) ).startsWith( key ) )
+				keep.append( s );
+			else
+				delete s;
+		}
+		d_root.d_children = keep;
+		reset();
+		if( d_root.d_children.size() < s_pageSize )
+			fetchPage();
+		return;
+	}
 	d_pattern = str;
 	refill();
 }
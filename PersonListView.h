@@ -31,6 +31,7 @@ class QPushButton;
 class QListWidget;
 class QLabel;
 class QListWidgetItem;
+class QTimer;
 
 namespace Wt
 {
@@ -67,6 +68,7 @@ namespace Wt
 		QLineEdit* d_search;
 		QTreeView* d_list;
 		PersonListMdl* d_mdl;
+		QTimer* d_delay; // sucht erst, wenn das Tippen kurz pausiert
 	};
 	Q_DECLARE_OPERATORS_FOR_FLAGS(PersonListView::Flags)
 
@@ -75,6 +77,7 @@ namespace Wt
 	public:
 		enum Role { OidRole = Qt::UserRole + 1, ToolTipRole };
 		PersonListMdl(QObject*, Udb::Transaction*);
+		~PersonListMdl();
         Udb::Transaction* getTxn() const { return d_txn; }
 		void refill();
 		void seek( const QString& );
@@ -90,7 +93,11 @@ namespace Wt
 		int rowCount ( const QModelIndex & parent = QModelIndex() ) const;
 		Qt::ItemFlags flags ( const QModelIndex & index ) const
 			{ return Qt::ItemFlags( Qt::ItemIsSelectable | Qt::ItemIsEnabled ); }
+		bool canFetchMore ( const QModelIndex & parent ) const;
+		void fetchMore ( const QModelIndex & parent );
 	private:
+		void fetchPage();
+		void closeCursor();
 		struct Slot
 		{
 			Udb::Obj d_obj;
@@ -104,6 +111,12 @@ namespace Wt
 		QString d_pattern;
 		QList<quint32> d_types;
         Udb::Transaction* d_txn;
+		// Offener Cursor im Index, steht auf dem naechsten noch nicht geladenen Key;
+		// 0 wenn das Ende des Praefix-Bereichs erreicht ist
+		Udb::Idx* d_cursor;
+		QString d_key; // d_pattern gefaltet wie im Index
+		QString d_last; // gefalteter Name des zuletzt gelesenen Keys
+		bool d_loaded; // refill lief mindestens einmal
 	};
 
 	class PersonSelectorDlg : public QDialog
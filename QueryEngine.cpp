@@ -0,0 +1,708 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "QueryEngine.h"
+#include "WorkerPool.h"
+#include "WorkTreeApp.h"
+#include "WtTypeDefs.h"
+#include <Udb/Transaction.h>
+#include <Udb/Idx.h>
+#include <QTimer>
+#include <QThread>
+#include <QRegExp>
+#include <QStringList>
+#include <QUuid>
+using namespace Wt;
+
+static const int s_taskMin = 1000; // Kandidaten pro Scan-Task mindestens
+
+enum Kind { KindId, KindType, KindText, KindDate, KindDateTime, KindUInt8, KindUInt16, KindUInt32,
+			KindBool, KindPrincipal, KindWbs, KindCalendar };
+struct _Field
+{
+	const char* d_name;
+	quint32 d_atom;
+	quint8 d_kind;
+};
+static const _Field s_fields[] =
+{
+	{ "id", 0, KindId },
+	{ "type", 0, KindType },
+	{ "text", AttrText, KindText },
+	{ "start", AttrEarlyStart, KindDate },
+	{ "finish", AttrEarlyFinish, KindDate },
+	{ "latestart", AttrLateStart, KindDate },
+	{ "latefinish", AttrLateFinish, KindDate },
+	{ "created", AttrCreatedOn, KindDateTime },
+	{ "modified", AttrModifiedOn, KindDateTime },
+	{ "duration", AttrDuration, KindUInt16 },
+	{ "pv", AttrPlannedValue, KindUInt32 },
+	{ "ev", AttrEarnedValue, KindUInt32 },
+	{ "ac", AttrActualCost, KindUInt32 },
+	{ "tasktype", AttrTaskType, KindUInt8 },
+	{ "critical", AttrCriticalPath, KindBool },
+	{ "principal", AttrAssigPrincipal, KindPrincipal },
+	{ "wbs", AttrWbsRef, KindWbs },
+	{ "calendar", AttrCalendar, KindCalendar },
+	{ 0, 0, 0 }
+};
+struct _TypeName
+{
+	const char* d_name;
+	quint32 d_type;
+};
+static const _TypeName s_types[] =
+{
+	{ "task", TypeTask },
+	{ "milestone", TypeMilestone },
+	{ "event", TypeImpEvent },
+	{ "accomplishment", TypeAccomplishment },
+	{ "criterion", TypeCriterion },
+	{ "link", TypeLink },
+	{ "deliverable", TypeDeliverable },
+	{ "work", TypeWork },
+	{ "orgunit", TypeOrgUnit },
+	{ "role", TypeRole },
+	{ "human", TypeHuman },
+	{ "resource", TypeResource },
+	{ "assig", TypeRasciAssig },
+	{ "calendar", TypeCalendar },
+	{ "calentry", TypeCalEntry },
+	{ "diagram", TypePdmDiagram },
+	{ 0, 0 }
+};
+
+static const _Field* _findField( const QString& name )
+{
+	const QByteArray n = name.toLower().toLatin1();
+	for( int i = 0; s_fields[i].d_name != 0; i++ )
+		if( n == s_fields[i].d_name )
+			return &s_fields[i];
+	return 0;
+}
+
+// Trennt an Whitespace ausserhalb von "..."; die Anführungszeichen bleiben erhalten
+static QStringList _tokenize( const QString& query )
+{
+	QStringList res;
+	QString cur;
+	bool quoted = false;
+	for( int i = 0; i < query.size(); i++ )
+	{
+		const QChar ch = query[i];
+		if( ch == QLatin1Char('"') )
+			quoted = !quoted;
+		if( ch.isSpace() && !quoted )
+		{
+			if( !cur.isEmpty() )
+				res.append( cur );
+			cur.clear();
+		}else
+			cur += ch;
+	}
+	if( !cur.isEmpty() )
+		res.append( cur );
+	return res;
+}
+
+static bool _splitCond( const QString& token, const _Field*& field, QString& op, QString& value )
+{
+	static QRegExp s_cond( "^([A-Za-z]+)(:|!=|>=|<=|=|>|<)(.*)$" );
+	if( !s_cond.exactMatch( token ) )
+		return false;
+	field = _findField( s_cond.cap( 1 ) );
+	if( field == 0 )
+		return false; // z.B. Lucene-Felder wie content: oder ident:
+	op = s_cond.cap( 2 );
+	value = s_cond.cap( 3 );
+	if( value.size() >= 2 && value.startsWith( QLatin1Char('"') ) && value.endsWith( QLatin1Char('"') ) )
+		value = value.mid( 1, value.size() - 2 );
+	return true;
+}
+
+static bool _parseDateRange( const QString& str, qint32& from, qint32& to )
+{
+	static QRegExp s_day( "^(\\d{4})-(\\d{1,2})-(\\d{1,2})$" );
+	static QRegExp s_month( "^(\\d{4})-(\\d{1,2})$" );
+	static QRegExp s_quarter( "^(\\d{4})-[Qq]([1-4])$" );
+	static QRegExp s_year( "^(\\d{4})$" );
+	QDate a, b;
+	if( str.compare( QLatin1String("today"), Qt::CaseInsensitive ) == 0 )
+		a = b = QDate::currentDate();
+	else if( s_day.exactMatch( str ) )
+		a = b = QDate( s_day.cap(1).toInt(), s_day.cap(2).toInt(), s_day.cap(3).toInt() );
+	else if( s_month.exactMatch( str ) )
+	{
+		a = QDate( s_month.cap(1).toInt(), s_month.cap(2).toInt(), 1 );
+		b = a.addMonths( 1 ).addDays( -1 );
+	}else if( s_quarter.exactMatch( str ) )
+	{
+		a = QDate( s_quarter.cap(1).toInt(), ( s_quarter.cap(2).toInt() - 1 ) * 3 + 1, 1 );
+		b = a.addMonths( 3 ).addDays( -1 );
+	}else if( s_year.exactMatch( str ) )
+	{
+		a = QDate( s_year.cap(1).toInt(), 1, 1 );
+		b = QDate( s_year.cap(1).toInt(), 12, 31 );
+	}
+	if( !a.isValid() || !b.isValid() )
+		return false;
+	from = a.toJulianDay();
+	to = b.toJulianDay();
+	return true;
+}
+
+static void _findIdent( Udb::Transaction* txn, const QString& id, QSet<Udb::OID>& res )
+{
+	const Stream::DataCell key = Stream::DataCell().setString( id );
+	Udb::Idx alt( txn, IndexDefs::IdxAltIdent );
+	if( alt.seek( key ) ) do
+	{
+		res.insert( alt.getOid() );
+	}while( alt.nextKey() );
+	Udb::Idx ident( txn, IndexDefs::IdxIdent );
+	if( ident.seek( key ) ) do
+	{
+		res.insert( ident.getOid() );
+	}while( ident.nextKey() );
+}
+
+static void _findName( const Udb::Obj& parent, const QString& name, QSet<Udb::OID>& res )
+{
+	Udb::Obj sub = parent.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		if( sub.getString( AttrText ).compare( name, Qt::CaseInsensitive ) == 0 ||
+				sub.getString( AttrPrincipalName ).compare( name, Qt::CaseInsensitive ) == 0 )
+			res.insert( sub.getOid() );
+		_findName( sub, name, res );
+	}while( sub.next() );
+}
+
+static bool _inRange( qint32 v, const QueryEngine::Cond& c )
+{
+	switch( c.d_op )
+	{
+	case QueryEngine::Eq:
+	case QueryEngine::Contains:
+		return v >= c.d_from && v <= c.d_to;
+	case QueryEngine::NotEq:
+		return v < c.d_from || v > c.d_to;
+	case QueryEngine::Less:
+		return v < c.d_from;
+	case QueryEngine::LessEq:
+		return v <= c.d_to;
+	case QueryEngine::Greater:
+		return v > c.d_to;
+	case QueryEngine::GreaterEq:
+		return v >= c.d_from;
+	}
+	return false;
+}
+
+static bool _compare( double v, const QueryEngine::Cond& c )
+{
+	switch( c.d_op )
+	{
+	case QueryEngine::Eq:
+	case QueryEngine::Contains:
+		return v == c.d_num;
+	case QueryEngine::NotEq:
+		return v != c.d_num;
+	case QueryEngine::Less:
+		return v < c.d_num;
+	case QueryEngine::LessEq:
+		return v <= c.d_num;
+	case QueryEngine::Greater:
+		return v > c.d_num;
+	case QueryEngine::GreaterEq:
+		return v >= c.d_num;
+	}
+	return false;
+}
+
+static bool _matches( const Udb::Obj& o, const QueryEngine::Cond& c )
+{
+	const bool neg = c.d_op == QueryEngine::NotEq;
+	switch( c.d_kind )
+	{
+	case KindId:
+		return c.d_refs.contains( o.getOid() ) != neg;
+	case KindType:
+		return c.d_types.contains( o.getType() ) != neg;
+	case KindText:
+		{
+			const QString str = o.getString( c.d_atom ).toLower();
+			if( c.d_op == QueryEngine::Eq )
+				return str == c.d_text;
+			return str.contains( c.d_text ) != neg;
+		}
+	case KindDate:
+		{
+			const QDate d = o.getValue( c.d_atom ).getDate();
+			return ( d.isValid() ) ? _inRange( d.toJulianDay(), c ) : neg;
+		}
+	case KindDateTime:
+		{
+			const QDate d = o.getValue( c.d_atom ).getDateTime().date();
+			return ( d.isValid() ) ? _inRange( d.toJulianDay(), c ) : neg;
+		}
+	case KindUInt8:
+	case KindUInt16:
+	case KindUInt32:
+		{
+			const Stream::DataCell v = o.getValue( c.d_atom );
+			if( v.isNull() )
+				return neg;
+			if( c.d_kind == KindUInt8 )
+				return _compare( v.getUInt8(), c );
+			if( c.d_kind == KindUInt16 )
+				return _compare( v.getUInt16(), c );
+			return _compare( v.getUInt32(), c );
+		}
+	case KindBool:
+		return ( o.getValue( c.d_atom ).getBool() == ( c.d_num != 0 ) ) != neg;
+	case KindPrincipal:
+		{
+			// RasciAssig sind Aggregate des zugewiesenen Objekts
+			Udb::Obj sub = o.getFirstObj();
+			if( !sub.isNull() ) do
+			{
+				if( sub.getType() == TypeRasciAssig &&
+						c.d_refs.contains( sub.getValue( AttrAssigPrincipal ).getOid() ) )
+					return !neg;
+			}while( sub.next() );
+			return neg;
+		}
+	case KindWbs:
+		return c.d_refs.contains( o.getValue( AttrWbsRef ).getOid() ) != neg;
+	case KindCalendar:
+		if( o.getType() == TypeCalEntry )
+			return c.d_refs.contains( o.getParent().getOid() ) != neg;
+		return c.d_refs.contains( o.getValue( AttrCalendar ).getOid() ) != neg;
+	}
+	return false;
+}
+
+bool QueryEngine::matches(const Udb::Obj & o, const QList<Cond> & conds)
+{
+	for( int i = 0; i < conds.size(); i++ )
+		if( !_matches( o, conds[i] ) )
+			return false;
+	return true;
+}
+
+namespace Wt
+{
+	// Filtert einen Teil der Kandidaten auf einer Worker-Verbindung; mit d_deep werden die
+	// OIDs als Wurzeln von Teilbäumen verstanden
+	class _ScanTask : public WorkerTask
+	{
+	public:
+		QList<QueryEngine::Cond> d_conds;
+		QList<Udb::OID> d_oids;
+		QList<Udb::OID> d_hits;
+		bool d_deep;
+		_ScanTask( const QList<QueryEngine::Cond>& conds, bool deep ):d_conds(conds),d_deep(deep){}
+		void walk( const Udb::Obj& o )
+		{
+			if( QueryEngine::matches( o, d_conds ) )
+				d_hits.append( o.getOid() );
+			Udb::Obj sub = o.getFirstObj();
+			if( !sub.isNull() ) do
+			{
+				walk( sub );
+			}while( sub.next() && !isCanceled() );
+		}
+		bool restart()
+		{
+			// Nur lesend; ein Ergebnis über einen Commit hinweg wird einfach neu gerechnet
+			d_hits.clear();
+			return true;
+		}
+		void compute( Udb::Transaction* snap )
+		{
+			for( int i = 0; i < d_oids.size() && !isCanceled(); i++ )
+			{
+				const Udb::Obj o = snap->getObject( d_oids[i] );
+				if( o.isNull() )
+					continue;
+				if( d_deep )
+					walk( o );
+				else if( QueryEngine::matches( o, d_conds ) )
+					d_hits.append( o.getOid() );
+			}
+		}
+	};
+}
+
+QueryEngine::QueryEngine(Indexer * idx, QObject *parent):QObject(parent),d_idx(idx),d_pending(0),
+	d_scanOk(true)
+{
+	Q_ASSERT( idx != 0 );
+}
+
+QueryEngine::~QueryEngine()
+{
+	foreach( QPointer<QObject> t, d_tasks )
+		if( WorkerTask* task = qobject_cast<WorkerTask*>( t ) )
+			task->cancel();
+}
+
+bool QueryEngine::isStructured(const QString &query)
+{
+	const QStringList tokens = _tokenize( query );
+	foreach( const QString& t, tokens )
+	{
+		const _Field* f;
+		QString op, value;
+		if( _splitCond( t, f, op, value ) )
+			return true;
+	}
+	return false;
+}
+
+bool QueryEngine::parse(const QString &query)
+{
+	d_conds.clear();
+	d_fullText.clear();
+	d_error.clear();
+	QStringList fullText;
+	const QStringList tokens = _tokenize( query );
+	foreach( const QString& t, tokens )
+	{
+		const _Field* f;
+		QString op, value;
+		if( !_splitCond( t, f, op, value ) )
+		{
+			fullText.append( t );
+			continue;
+		}
+		Cond c;
+		c.d_field = f->d_name;
+		c.d_atom = f->d_atom;
+		c.d_kind = f->d_kind;
+		if( op == ":" )
+			c.d_op = Contains;
+		else if( op == "=" )
+			c.d_op = Eq;
+		else if( op == "!=" )
+			c.d_op = NotEq;
+		else if( op == "<" )
+			c.d_op = Less;
+		else if( op == "<=" )
+			c.d_op = LessEq;
+		else if( op == ">" )
+			c.d_op = Greater;
+		else
+			c.d_op = GreaterEq;
+		const bool ordered = c.d_op != Contains && c.d_op != Eq && c.d_op != NotEq;
+		switch( c.d_kind )
+		{
+		case KindDate:
+		case KindDateTime:
+			if( !_parseDateRange( value, c.d_from, c.d_to ) )
+			{
+				d_error = tr("invalid date '%1' for %2").arg( value ).arg( c.d_field );
+				return false;
+			}
+			break;
+		case KindUInt8:
+		case KindUInt16:
+		case KindUInt32:
+			{
+				bool ok;
+				c.d_num = value.toDouble( &ok );
+				if( !ok )
+				{
+					d_error = tr("invalid number '%1' for %2").arg( value ).arg( c.d_field );
+					return false;
+				}
+			}
+			break;
+		case KindBool:
+			c.d_num = ( value == "yes" || value == "true" || value == "1" ) ? 1 : 0;
+			if( ordered )
+			{
+				d_error = tr("%1 only supports ':' and '!='").arg( c.d_field );
+				return false;
+			}
+			break;
+		case KindType:
+			foreach( const QString& name, value.toLower().split( QLatin1Char(','), QString::SkipEmptyParts ) )
+			{
+				int i = 0;
+				while( s_types[i].d_name != 0 && name != s_types[i].d_name )
+					i++;
+				if( s_types[i].d_name == 0 )
+				{
+					d_error = tr("unknown type '%1'").arg( name );
+					return false;
+				}
+				c.d_types.insert( s_types[i].d_type );
+			}
+			// fall through
+		default:
+			if( ordered )
+			{
+				d_error = tr("%1 only supports ':', '=' and '!='").arg( c.d_field );
+				return false;
+			}
+			c.d_text = value.toLower();
+			if( !resolve( c, value ) )
+				return false;
+			break;
+		}
+		d_conds.append( c );
+	}
+	d_fullText = fullText.join( QLatin1String(" ") );
+
+	// Indexierbar sind positive Referenz-Bedingungen; calendar nur wenn nach CalEntry gesucht wird
+	bool calEntriesOnly = false;
+	foreach( const Cond& c, d_conds )
+		if( c.d_kind == KindType && c.d_op != NotEq && c.d_types.size() == 1 && c.d_types.contains( TypeCalEntry ) )
+			calEntriesOnly = true;
+	for( int i = 0; i < d_conds.size(); i++ )
+	{
+		Cond& c = d_conds[i];
+		if( c.d_op == NotEq )
+			continue;
+		c.d_indexed = c.d_kind == KindId || c.d_kind == KindPrincipal || c.d_kind == KindWbs ||
+				( c.d_kind == KindCalendar && calEntriesOnly );
+	}
+	if( d_conds.isEmpty() )
+	{
+		d_error = tr("query has no structured condition");
+		return false;
+	}
+	return true;
+}
+
+bool QueryEngine::resolve(QueryEngine::Cond & c, const QString& value)
+{
+	Udb::Transaction* txn = d_idx->getTxn();
+	if( c.d_kind != KindId && c.d_kind != KindPrincipal && c.d_kind != KindWbs && c.d_kind != KindCalendar )
+		return true;
+	// Zuerst als ID, dann als Name im passenden Baum
+	_findIdent( txn, value, c.d_refs );
+	if( c.d_refs.isEmpty() )
+		_findIdent( txn, value.toUpper(), c.d_refs ); // IDs werden meist gross geschrieben
+	if( c.d_refs.isEmpty() && c.d_kind != KindId )
+	{
+		Udb::Obj root;
+		if( c.d_kind == KindPrincipal )
+			root = txn->getObject( QUuid( WorkTreeApp::s_obs ) );
+		else if( c.d_kind == KindWbs )
+			root = txn->getObject( QUuid( WorkTreeApp::s_wbs ) );
+		else
+			root = WtTypeDefs::getCalendars( txn );
+		if( !root.isNull() )
+			_findName( root, value, c.d_refs );
+	}
+	if( c.d_refs.isEmpty() && c.d_op != NotEq )
+	{
+		d_error = tr("no object found for %1 '%2'").arg( c.d_field ).arg( value );
+		return false;
+	}
+	return true;
+}
+
+static QSet<Udb::OID> _candidates( Udb::Transaction* txn, const QueryEngine::Cond& c, const char*& index )
+{
+	QSet<Udb::OID> res;
+	if( c.d_kind == KindId )
+	{
+		index = "IdxIdent";
+		return c.d_refs;
+	}
+	if( c.d_kind == KindPrincipal )
+		index = IndexDefs::IdxAssigPrincipal;
+	else if( c.d_kind == KindWbs )
+		index = IndexDefs::IdxWbsRef;
+	else
+		index = IndexDefs::IdxCalDate;
+	Udb::Idx idx( txn, index );
+	foreach( Udb::OID ref, c.d_refs )
+	{
+		if( idx.seek( Stream::DataCell().setOid( ref ) ) ) do
+		{
+			if( c.d_kind == KindPrincipal )
+			{
+				const Udb::Obj assig = txn->getObject( idx.getOid() );
+				const Udb::OID oid = assig.getValue( AttrAssigObject ).getOid();
+				if( oid != 0 )
+					res.insert( oid );
+			}else
+				res.insert( idx.getOid() );
+		}while( idx.nextKey() );
+	}
+	return res;
+}
+
+bool QueryEngine::start()
+{
+	d_error.clear();
+	d_result.clear();
+	d_textHits.clear();
+	d_hits.clear();
+	Udb::Transaction* txn = d_idx->getTxn();
+	QStringList plan;
+	QSet<Udb::OID> cands;
+	bool haveSet = false;
+	if( hasFullText() )
+	{
+		Indexer::ResultList hits;
+		if( !d_idx->query( d_fullText, hits ) )
+		{
+			d_error = d_idx->getError();
+			return false;
+		}
+		foreach( const Indexer::Hit& h, hits )
+		{
+			const Udb::OID oid = h.d_object.getOid();
+			if( !d_textHits.contains( oid ) || d_textHits.value( oid ).d_score < h.d_score )
+				d_textHits.insert( oid, h );
+		}
+		cands = d_textHits.keys().toSet();
+		haveSet = true;
+		plan.append( QString( "Lucene(%1)" ).arg( cands.size() ) );
+	}
+	QList<Cond> residual;
+	foreach( const Cond& c, d_conds )
+	{
+		if( !c.d_indexed )
+		{
+			residual.append( c );
+			continue;
+		}
+		const char* index = "";
+		const QSet<Udb::OID> s = _candidates( txn, c, index );
+		plan.append( QString( "%1(%2)" ).arg( index ).arg( s.size() ) );
+		if( haveSet )
+			cands.intersect( s );
+		else
+			cands = s;
+		haveSet = true;
+	}
+
+	if( haveSet )
+	{
+		const QList<Udb::OID> list = cands.toList();
+		if( residual.isEmpty() )
+		{
+			d_hits = list;
+			QTimer::singleShot( 0, this, SLOT(onComplete()) ); // finished immer asynchron
+		}else
+		{
+			const int n = scan( list, false );
+			plan.append( QString( "filter(%1 in %2 tasks)" ).arg( list.size() ).arg( n ) );
+		}
+	}else
+	{
+		QList<Udb::OID> roots;
+		QList<Udb::Obj> tops;
+		tops << txn->getObject( QUuid( WorkTreeApp::s_imp ) ) << txn->getObject( QUuid( WorkTreeApp::s_wbs ) ) <<
+				txn->getObject( QUuid( WorkTreeApp::s_obs ) ) << WtTypeDefs::getCalendars( txn );
+		foreach( const Udb::Obj& top, tops )
+		{
+			Udb::Obj sub = top.getFirstObj();
+			if( !sub.isNull() ) do
+			{
+				roots.append( sub.getOid() );
+			}while( sub.next() );
+		}
+		const int n = scan( roots, true );
+		plan.append( QString( "scan(%1 subtrees in %2 tasks)" ).arg( roots.size() ).arg( n ) );
+	}
+	d_plan = plan.join( QLatin1String(" & ") );
+	return true;
+}
+
+int QueryEngine::scan(const QList<Udb::OID> &oids, bool deep)
+{
+	d_scanOk = true;
+	if( oids.isEmpty() )
+	{
+		QTimer::singleShot( 0, this, SLOT(onComplete()) );
+		return 0;
+	}
+	QList<Cond> residual;
+	foreach( const Cond& c, d_conds )
+		if( !c.d_indexed )
+			residual.append( c );
+	const int ideal = qMax( 1, QThread::idealThreadCount() );
+	const int n = ( deep ) ? qMin( ideal, oids.size() ) : qBound( 1, oids.size() / s_taskMin, ideal );
+	QList<_ScanTask*> tasks;
+	for( int i = 0; i < n; i++ )
+		tasks.append( new _ScanTask( residual, deep ) );
+	for( int i = 0; i < oids.size(); i++ )
+		tasks[ i % n ]->d_oids.append( oids[i] );
+
+	WorkerPool* pool = WorkerPool::inst( d_idx->getTxn() );
+	d_pending = n;
+	foreach( _ScanTask* t, tasks )
+	{
+		connect( t, SIGNAL(finished(bool)), this, SLOT(onScanFinished(bool)) );
+		d_tasks.append( t );
+		pool->start( t );
+	}
+	return n;
+}
+
+void QueryEngine::onScanFinished(bool ok)
+{
+	_ScanTask* t = static_cast<_ScanTask*>( sender() );
+	if( ok )
+		d_hits += t->d_hits;
+	else
+	{
+		d_scanOk = false;
+		d_error = ( t->getError().isEmpty() ) ? tr("scan canceled") : t->getError();
+	}
+	if( --d_pending == 0 )
+		onComplete();
+}
+
+void QueryEngine::onComplete()
+{
+	d_tasks.clear();
+	if( !d_scanOk )
+	{
+		d_hits.clear();
+		emit finished( false );
+		return;
+	}
+	Udb::Transaction* txn = d_idx->getTxn();
+	foreach( Udb::OID oid, d_hits )
+	{
+		if( d_textHits.contains( oid ) )
+		{
+			d_result.append( d_textHits.value( oid ) );
+			continue;
+		}
+		Indexer::Hit h;
+		h.d_object = txn->getObject( oid );
+		if( h.d_object.isNull() )
+			continue;
+		h.d_isTitle = false;
+		h.d_isAlias = false;
+		h.d_score = 0.0;
+		d_result.append( h );
+	}
+	emit finished( true );
+}
@@ -0,0 +1,95 @@
+#ifndef QUERYENGINE_H
+#define QUERYENGINE_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QSet>
+#include <QPointer>
+#include "Indexer.h"
+
+namespace Wt
+{
+	// Strukturierte Suche für die SearchView. Eine Query besteht aus Bedingungen der Form
+	// feld:wert, feld=wert, feld!=wert, feld>wert, feld>=wert, feld<wert, feld<=wert
+	// (Werte mit Leerzeichen in "..."), alle übrigen Begriffe gehen als Volltext an Lucene.
+	// Beispiel: type:task critical:yes duration>20 finish:2024-Q3 principal:"Team X"
+	// Datumswerte: YYYY-MM-DD, YYYY-MM, YYYY-Qn, YYYY oder today; Bereiche gelten für ':'.
+	// Planung: id, principal, wbs und (bei type:calentry) calendar werden über IdxAltIdent/
+	// IdxIdent, IdxAssigPrincipal, IdxWbsRef bzw. IdxCalDate aufgelöst und zusammen mit den
+	// Lucene-Treffern geschnitten; die restlichen Bedingungen filtern die Kandidaten, ohne
+	// indizierte Bedingung werden IMP, WBS, OBS und Kalender durchsucht. Gefiltert wird immer
+	// auf den Worker-Verbindungen des WorkerPool, also unabhängig von der Anzahl Kandidaten
+	// gegen den committeten Stand. start kehrt sofort zurück, finished kommt mit dem Resultat.
+	class QueryEngine : public QObject
+	{
+		Q_OBJECT
+	public:
+		enum Op { Eq, Contains, NotEq, Less, LessEq, Greater, GreaterEq };
+		struct Cond
+		{
+			QString d_field;
+			quint32 d_atom;
+			quint8 d_kind;
+			quint8 d_op;
+			QString d_text; // Text-Bedingungen, lower case
+			double d_num;
+			qint32 d_from, d_to; // Julian Days, inklusive
+			QSet<quint32> d_types;
+			QSet<Udb::OID> d_refs; // aufgelöste Objekte von id, principal, wbs, calendar
+			bool d_indexed;
+			Cond():d_atom(0),d_kind(0),d_op(Eq),d_num(0),d_from(0),d_to(0),d_indexed(false){}
+		};
+
+		QueryEngine( Indexer*, QObject* parent = 0 );
+		~QueryEngine(); // bricht laufende Scans ab
+		// true wenn die Query mindestens eine strukturierte Bedingung enthält
+		static bool isStructured( const QString& query );
+		bool parse( const QString& query );
+		bool start(); // false bei Fehler, sonst folgt finished
+		const Indexer::ResultList& getResult() const { return d_result; }
+		bool hasFullText() const { return !d_fullText.isEmpty(); }
+		const QString& getError() const { return d_error; }
+		const QString& getPlan() const { return d_plan; } // wie die letzte Query ausgeführt wurde
+
+		static bool matches( const Udb::Obj&, const QList<Cond>& );
+	signals:
+		void finished( bool ok );
+	protected slots:
+		void onScanFinished( bool );
+		void onComplete();
+	private:
+		bool resolve( Cond&, const QString& value );
+		int scan( const QList<Udb::OID>& oids, bool deep ); // Anzahl gestarteter Tasks
+		Indexer* d_idx;
+		QList<Cond> d_conds;
+		QString d_fullText;
+		QString d_error;
+		QString d_plan;
+		QHash<Udb::OID,Indexer::Hit> d_textHits;
+		QList<Udb::OID> d_hits;
+		Indexer::ResultList d_result;
+		QList< QPointer<QObject> > d_tasks; // laufende Scan-Tasks
+		int d_pending;
+		bool d_scanOk;
+	};
+}
+
+#endif // QUERYENGINE_H
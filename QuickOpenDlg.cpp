@@ -0,0 +1,110 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "QuickOpenDlg.h"
+#include "QuickOpenIndex.h"
+#include <Oln2/OutlineUdbMdl.h>
+#include <Udb/Transaction.h>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QKeyEvent>
+#include <QApplication>
+using namespace Wt;
+
+static const int s_maxHits = 50;
+
+QuickOpenDlg::QuickOpenDlg(QWidget * p, Udb::Transaction * txn):QDialog( p )
+{
+	Q_ASSERT( txn != 0 );
+	setWindowTitle( tr("Quick Open - WorkTree") );
+	d_idx = QuickOpenIndex::inst( txn );
+
+	QVBoxLayout* vbox = new QVBoxLayout( this );
+	vbox->setMargin( 4 );
+	vbox->setSpacing( 2 );
+	d_edit = new QLineEdit( this );
+	d_edit->installEventFilter( this );
+	vbox->addWidget( d_edit );
+	d_list = new QListWidget( this );
+	d_list->setAlternatingRowColors( true );
+	vbox->addWidget( d_list );
+	d_status = new QLabel( this );
+	vbox->addWidget( d_status );
+	resize( 480, 360 );
+
+	connect( d_edit, SIGNAL( textChanged( QString ) ), this, SLOT( onTextChanged( QString ) ) );
+	connect( d_edit, SIGNAL( returnPressed() ), this, SLOT( accept() ) );
+	connect( d_list, SIGNAL( itemActivated( QListWidgetItem* ) ), this, SLOT( accept() ) );
+}
+
+Udb::Obj QuickOpenDlg::select()
+{
+	onTextChanged( QString() ); // baut den Index beim ersten Aufruf
+	d_edit->setFocus();
+	if( exec() != QDialog::Accepted || d_list->currentItem() == 0 )
+		return Udb::Obj();
+	const Udb::OID oid = d_list->currentItem()->data( Qt::UserRole ).toULongLong();
+	return d_idx->getTxn()->getObject( oid );
+}
+
+bool QuickOpenDlg::eventFilter(QObject * o, QEvent * e)
+{
+	// Die Eingabe behält den Fokus; Auf/Ab/Page bewegen die Auswahl in der Liste
+	if( o == d_edit && e->type() == QEvent::KeyPress )
+	{
+		QKeyEvent* ke = static_cast<QKeyEvent*>( e );
+		switch( ke->key() )
+		{
+		case Qt::Key_Up:
+		case Qt::Key_Down:
+		case Qt::Key_PageUp:
+		case Qt::Key_PageDown:
+			QApplication::sendEvent( d_list, e );
+			return true;
+		default:
+			break;
+		}
+	}
+	return QDialog::eventFilter( o, e );
+}
+
+void QuickOpenDlg::onTextChanged(const QString & str)
+{
+	d_list->clear();
+	const QList<QuickOpenIndex::Match> res = d_idx->find( str, s_maxHits );
+	for( int i = 0; i < res.size(); i++ )
+	{
+		QListWidgetItem* item = new QListWidgetItem( d_list );
+		if( res[i].d_id.isEmpty() )
+			item->setText( res[i].d_title );
+		else
+			item->setText( QString( "%1  %2" ).arg( res[i].d_id ).arg( res[i].d_title ) );
+		item->setIcon( Oln::OutlineUdbMdl::getPixmap( res[i].d_type ) );
+		item->setData( Qt::UserRole, res[i].d_oid );
+	}
+	if( d_list->count() > 0 )
+		d_list->setCurrentRow( 0 );
+	if( str.isEmpty() )
+		d_status->setText( tr("%1 objects indexed in %2 ms").arg( d_idx->getCount() ).arg( d_idx->getBuildMs() ) );
+	else
+		d_status->setText( tr("%1 matches in %2 ms").arg( res.size() ).arg( d_idx->getLastQueryMs() ) );
+}
@@ -0,0 +1,54 @@
+#ifndef QUICKOPENDLG_H
+#define QUICKOPENDLG_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QDialog>
+#include <Udb/Obj.h>
+
+class QLineEdit;
+class QListWidget;
+class QLabel;
+
+namespace Wt
+{
+	class QuickOpenIndex;
+
+	// Palette zum Springen auf ein Objekt über ID oder Titel; die Trefferliste wird bei jedem
+	// Tastendruck aus dem QuickOpenIndex neu gefüllt.
+	class QuickOpenDlg : public QDialog
+	{
+		Q_OBJECT
+	public:
+		QuickOpenDlg( QWidget*, Udb::Transaction* );
+		Udb::Obj select(); // Null, falls abgebrochen
+	protected:
+		bool eventFilter( QObject*, QEvent* );
+	protected slots:
+		void onTextChanged( const QString& );
+	private:
+		QuickOpenIndex* d_idx;
+		QLineEdit* d_edit;
+		QListWidget* d_list;
+		QLabel* d_status;
+	};
+}
+
+#endif // QUICKOPENDLG_H
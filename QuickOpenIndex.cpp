@@ -0,0 +1,324 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "QuickOpenIndex.h"
+#include "WorkTreeApp.h"
+#include "WtTypeDefs.h"
+#include <Udb/Transaction.h>
+#include <QTime>
+#include <algorithm>
+using namespace Wt;
+
+static const int s_compactMin = 1024; // so viele tote Einträge werden toleriert
+
+static QString _normalize( const QString& str )
+{
+	return str.simplified().toLower();
+}
+
+// Trigramme als drei UTF-16 Zeichen in einem quint64; sortiert und ohne Duplikate
+static void _trigrams( const QString& str, QVector<quint64>& res )
+{
+	res.clear();
+	const QChar* s = str.constData();
+	for( int i = 0; i + 2 < str.size(); i++ )
+		res.append( ( quint64( s[i].unicode() ) << 32 ) | ( quint64( s[i+1].unicode() ) << 16 ) |
+					quint64( s[i+2].unicode() ) );
+	std::sort( res.begin(), res.end() );
+	res.erase( std::unique( res.begin(), res.end() ), res.end() );
+}
+
+QuickOpenIndex::QuickOpenIndex(Udb::Transaction * txn):QObject( txn ),d_dead(0),d_buildMs(0),
+	d_queryMs(0),d_built(false)
+{
+	UpdateDispatcher* disp = UpdateDispatcher::inst( txn );
+	disp->subscribe( this, SLOT( onDbUpdates( Wt::UpdateBatch ) ),
+					 ObjChange::Erased | ObjChange::Aggregated | ObjChange::Deaggregated | ObjChange::TypeChanged );
+	disp->observeAtom( this, AttrText );
+	disp->observeAtom( this, AttrInternalId );
+	disp->observeAtom( this, AttrCustomId );
+}
+
+QuickOpenIndex *QuickOpenIndex::inst(Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	QuickOpenIndex* i = txn->findChild<QuickOpenIndex*>();
+	if( i == 0 )
+		i = new QuickOpenIndex( txn );
+	return i;
+}
+
+Udb::Transaction *QuickOpenIndex::getTxn() const
+{
+	return static_cast<Udb::Transaction*>( parent() );
+}
+
+bool QuickOpenIndex::isIndexed(quint32 type)
+{
+	return WtTypeDefs::isImpType( type ) || WtTypeDefs::isObsType( type ) || WtTypeDefs::isWbsType( type );
+}
+
+bool QuickOpenIndex::isRoot(const Udb::Obj & o)
+{
+	const QUuid id = o.getUuid();
+	return id == QUuid( WorkTreeApp::s_imp ) || id == QUuid( WorkTreeApp::s_obs ) ||
+			id == QUuid( WorkTreeApp::s_wbs );
+}
+
+void QuickOpenIndex::build()
+{
+	QTime t;
+	t.start();
+	d_entries.clear();
+	d_slots.clear();
+	d_postings.clear();
+	d_dirty.clear();
+	d_dead = 0;
+	Udb::Transaction* txn = getTxn();
+	buildImp( txn->getObject( QUuid( WorkTreeApp::s_imp ) ) );
+	buildImp( txn->getObject( QUuid( WorkTreeApp::s_obs ) ) );
+	buildImp( txn->getObject( QUuid( WorkTreeApp::s_wbs ) ) );
+	d_counts.fill( 0, d_entries.size() );
+	d_built = true;
+	d_buildMs = t.elapsed();
+}
+
+void QuickOpenIndex::buildImp(const Udb::Obj & parent)
+{
+	Udb::Obj sub = parent.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		if( isIndexed( sub.getType() ) )
+		{
+			add( sub );
+			buildImp( sub );
+		}
+	}while( sub.next() );
+}
+
+void QuickOpenIndex::add(const Udb::Obj & o)
+{
+	Entry e;
+	e.d_oid = o.getOid();
+	e.d_type = o.getType();
+	e.d_id = WtTypeDefs::formatObjectId( o );
+	e.d_title = o.getString( AttrText ).simplified();
+	e.d_key = QLatin1Char(' ') + _normalize( e.d_id + QLatin1Char(' ') + e.d_title ); // Wortanfänge als Trigramm
+	e.d_alive = true;
+	const int slot = d_entries.size();
+	d_entries.append( e );
+	d_slots[e.d_oid] = slot;
+	QVector<quint64> tris;
+	_trigrams( e.d_key, tris );
+	for( int i = 0; i < tris.size(); i++ )
+		d_postings[tris[i]].append( slot );
+}
+
+void QuickOpenIndex::remove(Udb::OID oid)
+{
+	// Postings werden nicht angefasst; find() überspringt tote Einträge bis zum nächsten compact()
+	QHash<Udb::OID,int>::iterator i = d_slots.find( oid );
+	if( i == d_slots.end() )
+		return;
+	d_entries[i.value()].d_alive = false;
+	d_entries[i.value()].d_key.clear();
+	d_slots.erase( i );
+	d_dead++;
+}
+
+void QuickOpenIndex::compact()
+{
+	QVector<int> map( d_entries.size(), -1 );
+	QVector<Entry> entries;
+	entries.reserve( d_entries.size() - d_dead );
+	for( int i = 0; i < d_entries.size(); i++ )
+	{
+		if( d_entries[i].d_alive )
+		{
+			map[i] = entries.size();
+			d_slots[d_entries[i].d_oid] = entries.size();
+			entries.append( d_entries[i] );
+		}
+	}
+	QHash<quint64,QVector<int> >::iterator p = d_postings.begin();
+	while( p != d_postings.end() )
+	{
+		QVector<int>& slots = p.value();
+		int n = 0;
+		for( int i = 0; i < slots.size(); i++ )
+			if( map[slots[i]] != -1 )
+				slots[n++] = map[slots[i]];
+		if( n == 0 )
+			p = d_postings.erase( p );
+		else
+		{
+			slots.resize( n );
+			++p;
+		}
+	}
+	d_entries = entries;
+	d_dead = 0;
+}
+
+void QuickOpenIndex::flush()
+{
+	if( !d_built )
+	{
+		build();
+		return;
+	}
+	if( d_dirty.isEmpty() )
+		return;
+	Udb::Transaction* txn = getTxn();
+	foreach( Udb::OID oid, d_dirty )
+	{
+		remove( oid );
+		Udb::Obj o = txn->getObject( oid );
+		if( o.isNull( true ) || !isIndexed( o.getType() ) )
+			continue;
+		// Nur was unter einem der drei Wurzelobjekte hängt; Objekte im Papierkorb oder in
+		// anderen Ordnern gehören nicht dazu. Die Wurzelobjekte haben selber indizierte Typen
+		// (TypeIMP, TypeOBS, TypeWBS), deshalb bei ihnen anhalten.
+		Udb::Obj p = o.getParent();
+		while( !p.isNull() && isIndexed( p.getType() ) && !isRoot( p ) )
+			p = p.getParent();
+		if( !p.isNull() && isRoot( p ) )
+			add( o );
+	}
+	d_dirty.clear();
+	if( d_dead > s_compactMin && d_dead * 4 > d_entries.size() )
+		compact();
+	d_counts.fill( 0, d_entries.size() );
+}
+
+void QuickOpenIndex::onDbUpdates(const UpdateBatch & batch)
+{
+	if( !d_built )
+		return; // build() liest ohnehin den aktuellen Stand
+	foreach( const ObjChange& c, batch )
+	{
+		d_dirty.insert( c.d_id );
+		if( c.is( ObjChange::Aggregated ) || c.is( ObjChange::Deaggregated ) )
+		{
+			// Ein verschobener Teilbaum wird vollständig neu eingelesen
+			Udb::Obj sub = getTxn()->getObject( c.d_id ).getFirstObj();
+			QList<Udb::Obj> stack;
+			if( !sub.isNull() )
+				stack.append( sub );
+			while( !stack.isEmpty() )
+			{
+				Udb::Obj o = stack.takeLast();
+				do
+				{
+					d_dirty.insert( o.getOid() );
+					Udb::Obj first = o.getFirstObj();
+					if( !first.isNull() )
+						stack.append( first );
+				}while( o.next() );
+			}
+		}
+	}
+}
+
+QList<QuickOpenIndex::Match> QuickOpenIndex::find(const QString &pattern, int max)
+{
+	QList<Match> res;
+	flush();
+	QTime t;
+	t.start();
+	const QString q = _normalize( pattern );
+	if( q.isEmpty() || max <= 0 )
+	{
+		d_queryMs = t.elapsed();
+		return res;
+	}
+	QVector<Match> cand;
+	QVector<quint64> tris;
+	_trigrams( q, tris );
+	if( tris.isEmpty() )
+	{
+		// Weniger als drei Zeichen: lineare Suche nach Teilstring, IDs mit Präfix zuerst
+		for( int i = 0; i < d_entries.size(); i++ )
+		{
+			const Entry& e = d_entries[i];
+			if( !e.d_alive )
+				continue;
+			const int pos = e.d_key.indexOf( q );
+			if( pos == -1 )
+				continue;
+			Match m;
+			m.d_oid = e.d_oid;
+			m.d_score = ( pos == 1 ) ? 2.0f : ( e.d_key[pos-1] == QLatin1Char(' ') ) ? 1.0f : 0.5f;
+			m.d_score -= 0.001f * e.d_key.size(); // kürzere zuerst
+			cand.append( m );
+		}
+	}else
+	{
+		// Anzahl gemeinsamer Trigramme pro Eintrag; nur die berührten Zähler werden zurückgesetzt
+		QVector<int> touched;
+		for( int i = 0; i < tris.size(); i++ )
+		{
+			QHash<quint64,QVector<int> >::const_iterator p = d_postings.find( tris[i] );
+			if( p == d_postings.end() )
+				continue;
+			const QVector<int>& slots = p.value();
+			for( int j = 0; j < slots.size(); j++ )
+			{
+				if( d_counts[slots[j]]++ == 0 )
+					touched.append( slots[j] );
+			}
+		}
+		const int minShared = qMax( 1, ( tris.size() + 1 ) / 2 );
+		for( int i = 0; i < touched.size(); i++ )
+		{
+			const int slot = touched[i];
+			const int shared = d_counts[slot];
+			d_counts[slot] = 0;
+			const Entry& e = d_entries[slot];
+			if( shared < minShared || !e.d_alive )
+				continue;
+			Match m;
+			m.d_oid = e.d_oid;
+			m.d_score = float( shared ) / float( tris.size() );
+			const QString id = e.d_id.toLower();
+			if( id == q )
+				m.d_score += 1.0f;
+			else if( !id.isEmpty() && id.startsWith( q ) )
+				m.d_score += 0.5f;
+			else if( e.d_key.contains( q ) )
+				m.d_score += 0.3f;
+			m.d_score -= 0.001f * e.d_key.size();
+			cand.append( m );
+		}
+	}
+	const int n = qMin( max, cand.size() );
+	std::partial_sort( cand.begin(), cand.begin() + n, cand.end() );
+	for( int i = 0; i < n; i++ )
+	{
+		Match m = cand[i];
+		const Entry& e = d_entries[d_slots.value( m.d_oid )];
+		m.d_type = e.d_type;
+		m.d_id = e.d_id;
+		m.d_title = e.d_title;
+		res.append( m );
+	}
+	d_queryMs = t.elapsed();
+	return res;
+}
@@ -0,0 +1,92 @@
+#ifndef QUICKOPENINDEX_H
+#define QUICKOPENINDEX_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <Udb/Obj.h>
+#include "UpdateDispatcher.h"
+
+namespace Wt
+{
+	// In-Memory Trigramm-Index über ID und Titel aller Objekte in IMP, OBS und WBS für Quick Open.
+	// Wird beim ersten find() aufgebaut und danach über den UpdateDispatcher nachgeführt; die
+	// geänderten Objekte werden nur vorgemerkt und vor der nächsten Abfrage eingelesen.
+	// Weil ein Treffer nur einen Teil der Trigramme der Eingabe enthalten muss, werden auch
+	// Tippfehler und Auslassungen gefunden (z.B. "T815" findet "T0815").
+	class QuickOpenIndex : public QObject
+	{
+		Q_OBJECT
+	public:
+		struct Match
+		{
+			Udb::OID d_oid;
+			quint32 d_type;
+			QString d_id;
+			QString d_title;
+			float d_score;
+			Match():d_oid(0),d_type(0),d_score(0){}
+			bool operator<( const Match& rhs ) const { return d_score > rhs.d_score; } // beste zuerst
+		};
+		static QuickOpenIndex* inst( Udb::Transaction* ); // eine Instanz pro Transaktion
+
+		QList<Match> find( const QString& pattern, int max = 50 );
+		int getCount() const { return d_entries.size() - d_dead; }
+		int getBuildMs() const { return d_buildMs; }
+		int getLastQueryMs() const { return d_queryMs; }
+		Udb::Transaction* getTxn() const;
+		static bool isIndexed( quint32 type );
+		static bool isRoot( const Udb::Obj& ); // eines der Wurzelobjekte IMP, OBS oder WBS
+	protected slots:
+		void onDbUpdates( const Wt::UpdateBatch& );
+	private:
+		struct Entry
+		{
+			Udb::OID d_oid;
+			quint32 d_type;
+			QString d_id;
+			QString d_title;
+			QString d_key; // Kleinbuchstaben: " id title"
+			bool d_alive;
+			Entry():d_oid(0),d_type(0),d_alive(false){}
+		};
+		explicit QuickOpenIndex( Udb::Transaction* );
+		void build();
+		void buildImp( const Udb::Obj& parent );
+		void flush();
+		void add( const Udb::Obj& );
+		void remove( Udb::OID );
+		void compact();
+		QVector<Entry> d_entries;
+		QHash<Udb::OID,int> d_slots; // OID -> Index in d_entries
+		QHash<quint64,QVector<int> > d_postings; // Trigramm -> Indizes in d_entries
+		QSet<Udb::OID> d_dirty;
+		QVector<quint16> d_counts; // Arbeitsspeicher von find(), immer mit Nullen
+		int d_dead;
+		int d_buildMs;
+		int d_queryMs;
+		bool d_built;
+	};
+}
+
+#endif // QUICKOPENINDEX_H
@@ -41,7 +41,7 @@ Wt::RefByViewCtrl *Wt::RefByViewCtrl::create(QWidget *parent, Udb::Transaction *
 	vbox->setSpacing( 2 );
 
 	RefByViewCtrl* ctrl = new RefByViewCtrl( pane );
-	txn->getDb()->addObserver( ctrl, SLOT( onDbUpdate( Udb::UpdateInfo ) ) );
+	UpdateDispatcher::inst( txn )->subscribe( ctrl, SLOT( onDbUpdates( Wt::UpdateBatch ) ), ObjChange::Erased );
 
 	QHBoxLayout* hbox = new QHBoxLayout();
 	hbox->setSpacing( 2 );
@@ -110,16 +110,15 @@ void RefByViewCtrl::onShowItem()
 	onFollowObject( d_mdl->getObject( d_mdl->getTree()->currentIndex() ) );
 }
 
-void RefByViewCtrl::onDbUpdate(Udb::UpdateInfo info)
+void RefByViewCtrl::onDbUpdates(const Wt::UpdateBatch & batch)
 {
-	switch( info.d_kind )
+	foreach( const ObjChange& c, batch )
 	{
-	case Udb::UpdateInfo::ObjectErased:
-		if( info.d_id == d_title->getObj().getOid() )
+		if( c.d_id == d_title->getObj().getOid() )
 		{
 			d_pin->setChecked( false );
 			setObj( Udb::Obj() );
+			break;
 		}
-		break;
 	}
 }
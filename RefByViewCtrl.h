@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <Udb/Obj.h>
+#include "UpdateDispatcher.h"
 #include <Gui2/AutoMenu.h>
 #include <Oln2/RefByItemMdl.h>
 
@@ -43,7 +44,7 @@ namespace Wt
 	signals:
 		void signalFollowObject( const Udb::Obj& );
 	protected slots:
-		void onDbUpdate( Udb::UpdateInfo info );
+		void onDbUpdates( const Wt::UpdateBatch& );
 		void onTitleClick();
 		void onFollowObject( const Udb::Obj& );
 		void onShowItem();
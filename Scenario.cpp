@@ -0,0 +1,587 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "Scenario.h"
+#include "WorkTreeApp.h"
+#include "ObjectHelper.h"
+#include "CachePolicy.h"
+#include <Udb/Transaction.h>
+#include <Udb/Idx.h>
+#include <QtConcurrentMap>
+#include <QtAlgorithms>
+using namespace Wt;
+
+static void _collect( const Udb::Obj& parent, QList<Udb::Obj>& res )
+{
+	Udb::Obj sub = parent.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		const quint32 type = sub.getType();
+		if( WtTypeDefs::isSchedObj( type ) )
+			res.append( sub );
+		if( WtTypeDefs::isImpType( type ) )
+			_collect( sub, res );
+	}while( sub.next() );
+}
+
+static bool _lessOid( const Udb::Obj& lhs, const Udb::Obj& rhs )
+{
+	return lhs.getOid() < rhs.getOid();
+}
+
+ScheduleNet *ScheduleNet::create(Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	CachePolicy::Bulk bulk( txn->getDb() );
+	ScheduleNet* net = new ScheduleNet();
+	QList<Udb::Obj> objs;
+	Udb::Obj imp = txn->getObject( QUuid( WorkTreeApp::s_imp ) );
+	if( !imp.isNull() )
+		_collect( imp, objs );
+	qSort( objs.begin(), objs.end(), _lessOid );
+
+	QDate minStart;
+	net->d_oids.reserve( objs.size() );
+	net->d_dur.reserve( objs.size() );
+	net->d_flags.reserve( objs.size() );
+	foreach( const Udb::Obj& o, objs )
+	{
+		net->d_oids.append( o.getOid() );
+		quint8 f = 0;
+		if( o.getType() == TypeMilestone )
+			f |= FlagMilestone;
+		else if( o.getValue( AttrSubTMSCount ).getUInt32() > 0 )
+			f |= FlagSummary;
+		net->d_flags.append( f );
+		net->d_dur.append( ( f & FlagMilestone ) ? 0 : o.getValue( AttrDuration ).getUInt16() );
+		const QDate es = o.getValue( AttrEarlyStart ).getDate();
+		if( es.isValid() && ( !minStart.isValid() || es < minStart ) )
+			minStart = es;
+	}
+
+	Udb::Idx predIdx( txn, IndexDefs::IdxPred );
+	if( predIdx.first() ) do
+	{
+		Udb::Obj o = txn->getObject( predIdx.getOid() );
+		if( o.isNull() )
+			continue;
+		Link l;
+		l.d_pred = net->indexOf( o.getValue( AttrPred ).getOid() );
+		l.d_succ = net->indexOf( o.getValue( AttrSucc ).getOid() );
+		if( l.d_pred == -1 || l.d_succ == -1 )
+			continue;
+		l.d_type = o.getValue( AttrLinkType ).getUInt8();
+		l.d_lag = o.getValue( AttrLag ).getInt32();
+		l.d_elapsed = o.getValue( AttrLagElapsed ).getBool();
+		l.d_oid = o.getOid();
+		net->d_links.append( l );
+	}while( predIdx.next() );
+
+	net->buildAdjacency();
+	net->buildRollup( objs );
+
+	net->d_cal = WorkCalendar::loadDefault( txn );
+	QDate origin = WtTypeDefs::getProject( txn ).getValue( AttrProjStartDate ).getDate();
+	if( !origin.isValid() )
+		origin = minStart;
+	if( !origin.isValid() )
+		origin = QDate::currentDate();
+	net->d_origin = net->d_cal.nextWorkday( origin );
+
+	// Vorläufiger Cache für Elapsed Lags; die Summe der Dauern ist eine obere Schranke
+	// für reine FS-Ketten ohne Lags
+	qint64 len = 520;
+	for( int i = 0; i < net->d_dur.size(); i++ )
+		len += net->d_dur[i];
+	net->fillCache( qMin( len, qint64( 36600 ) ) );
+
+	net->schedule( net->d_dur, net->d_links, QHash<int,qint32>(), net->d_committed );
+
+	// Reserve von rund zwei Jahren für Scenarios
+	net->fillCache( net->d_committed.d_finish + 520 );
+	return net;
+}
+
+void ScheduleNet::fillCache(int len)
+{
+	if( len <= d_jd.size() && !d_jd.isEmpty() )
+		return;
+	d_jd.resize( len );
+	QDate d = d_origin;
+	for( int i = 0; i < len; i++ )
+	{
+		d_jd[i] = d.toJulianDay();
+		d = d_cal.addWorkdays( d, 1 );
+	}
+}
+
+void ScheduleNet::buildAdjacency()
+{
+	// Counting Sort der Links nach Pred bzw. Succ
+	const int n = d_oids.size();
+	d_outStart.fill( 0, n + 1 );
+	d_inStart.fill( 0, n + 1 );
+	for( int i = 0; i < d_links.size(); i++ )
+	{
+		d_outStart[ d_links[i].d_pred + 1 ]++;
+		d_inStart[ d_links[i].d_succ + 1 ]++;
+	}
+	for( int i = 0; i < n; i++ )
+	{
+		d_outStart[i + 1] += d_outStart[i];
+		d_inStart[i + 1] += d_inStart[i];
+	}
+	d_out.resize( d_links.size() );
+	d_in.resize( d_links.size() );
+	QVector<int> outPos = d_outStart;
+	QVector<int> inPos = d_inStart;
+	for( int i = 0; i < d_links.size(); i++ )
+	{
+		d_out[ outPos[ d_links[i].d_pred ]++ ] = i;
+		d_in[ inPos[ d_links[i].d_succ ]++ ] = i;
+	}
+}
+
+void ScheduleNet::buildRollup(const QList<Udb::Obj> & objs)
+{
+	// objs ist parallel zu d_oids
+	const int n = d_oids.size();
+	d_parent.fill( -1, n );
+	for( int i = 0; i < n; i++ )
+	{
+		Udb::Obj p = objs[i].getParent();
+		while( !p.isNull() && WtTypeDefs::isImpType( p.getType() ) )
+		{
+			const int j = indexOf( p.getOid() );
+			if( j != -1 && ( d_flags[j] & FlagSummary ) )
+			{
+				d_parent[i] = j;
+				break;
+			}
+			p = p.getParent();
+		}
+	}
+	// Nach Tiefe sortieren, damit Summaries ihre Werte haben, bevor sie weitergereicht werden
+	QVector<int> depth( n, 0 );
+	int maxDepth = 0;
+	for( int i = 0; i < n; i++ )
+	{
+		for( int j = d_parent[i]; j != -1; j = d_parent[j] )
+			depth[i]++;
+		maxDepth = qMax( maxDepth, depth[i] );
+	}
+	d_rollup.clear();
+	for( int d = maxDepth; d > 0; d-- )
+		for( int i = 0; i < n; i++ )
+			if( depth[i] == d )
+				d_rollup.append( i );
+}
+
+void ScheduleNet::rollup(Result & res) const
+{
+	// Summaries übernehmen den frühesten Start und das späteste Ende ihrer Kinder; Links
+	// auf Summaries wirken weiterhin mit deren eigener Dauer im Forward und Backward Pass
+	QVector<bool> touched( res.d_es.size(), false );
+	for( int k = 0; k < d_rollup.size(); k++ )
+	{
+		const int i = d_rollup[k];
+		const int p = d_parent[i];
+		if( !touched[p] )
+		{
+			res.d_es[p] = res.d_es[i];
+			res.d_ef[p] = res.d_ef[i];
+			res.d_ls[p] = res.d_ls[i];
+			res.d_lf[p] = res.d_lf[i];
+			touched[p] = true;
+		}else
+		{
+			res.d_es[p] = qMin( res.d_es[p], res.d_es[i] );
+			res.d_ef[p] = qMax( res.d_ef[p], res.d_ef[i] );
+			res.d_ls[p] = qMin( res.d_ls[p], res.d_ls[i] );
+			res.d_lf[p] = qMax( res.d_lf[p], res.d_lf[i] );
+		}
+	}
+}
+
+int ScheduleNet::indexOf(Udb::OID oid) const
+{
+	QVector<Udb::OID>::const_iterator i = qBinaryFind( d_oids.begin(), d_oids.end(), oid );
+	if( i == d_oids.end() )
+		return -1;
+	else
+		return i - d_oids.begin();
+}
+
+QDate ScheduleNet::dateOf(qint32 workday) const
+{
+	if( workday >= 0 && workday < d_jd.size() )
+		return QDate::fromJulianDay( d_jd[workday] );
+	else
+		return d_cal.addWorkdays( d_origin, workday );
+}
+
+qint32 ScheduleNet::workdayOf(const QDate & d) const
+{
+	if( !d_jd.isEmpty() && d.toJulianDay() >= d_jd.first() && d.toJulianDay() <= d_jd.last() )
+		return qLowerBound( d_jd.begin(), d_jd.end(), qint32( d.toJulianDay() ) ) - d_jd.begin();
+	else
+		return d_cal.workdaysBetween( d_origin, d );
+}
+
+qint32 ScheduleNet::shift(qint32 workday, const Link & l, bool backward) const
+{
+	const int lag = ( backward )? -l.d_lag : l.d_lag;
+	if( !l.d_elapsed )
+		return workday + lag;
+	// Elapsed Lag in Kalendertagen; fällt das Ergebnis auf einen freien Tag, gilt im Forward Pass
+	// der nächste, im Backward Pass der vorherige Workday. workdayOf liefert den nächsten.
+	const QDate d = dateOf( workday ).addDays( lag );
+	if( backward && !d_cal.isWorkday( d ) )
+		return workdayOf( d ) - 1;
+	else
+		return workdayOf( d );
+}
+
+void ScheduleNet::schedule(const QVector<quint16> &dur, const QVector<Link> &links,
+						   const QHash<int,qint32> &minStart, Result & res) const
+{
+	const int n = dur.size();
+	res.d_es.fill( 0, n );
+	res.d_ef.fill( 0, n );
+	res.d_ls.fill( 0, n );
+	res.d_lf.fill( 0, n );
+	res.d_finish = 0;
+
+	// Adjazenz der Nachfolger in kompakter Form (CSR), linear in Knoten und Links
+	QVector<int> outStart( n + 1, 0 );
+	QVector<int> inDeg( n, 0 );
+	for( int l = 0; l < links.size(); l++ )
+	{
+		outStart[ links[l].d_pred + 1 ]++;
+		inDeg[ links[l].d_succ ]++;
+	}
+	for( int i = 0; i < n; i++ )
+		outStart[i + 1] += outStart[i];
+	QVector<int> out( links.size() );
+	QVector<int> fill = outStart;
+	for( int l = 0; l < links.size(); l++ )
+		out[ fill[ links[l].d_pred ]++ ] = l;
+
+	// Topologische Sortierung nach Kahn
+	QVector<int> order;
+	order.reserve( n );
+	for( int i = 0; i < n; i++ )
+		if( inDeg[i] == 0 )
+			order.append( i );
+	for( int k = 0; k < order.size(); k++ )
+	{
+		const int i = order[k];
+		for( int e = outStart[i]; e < outStart[i + 1]; e++ )
+			if( --inDeg[ links[ out[e] ].d_succ ] == 0 )
+				order.append( links[ out[e] ].d_succ );
+	}
+	res.d_cyclic = n - order.size();
+
+	// Forward Pass
+	QHash<int,qint32>::const_iterator m;
+	for( m = minStart.begin(); m != minStart.end(); ++m )
+		res.d_es[ m.key() ] = qMax( qint32(0), m.value() );
+	for( int k = 0; k < order.size(); k++ )
+	{
+		const int i = order[k];
+		res.d_ef[i] = res.d_es[i] + dur[i];
+		res.d_finish = qMax( res.d_finish, res.d_ef[i] );
+		for( int e = outStart[i]; e < outStart[i + 1]; e++ )
+		{
+			const Link& l = links[ out[e] ];
+			qint32 c = 0;
+			switch( l.d_type )
+			{
+			case LinkType_SS:
+				c = shift( res.d_es[i], l, false );
+				break;
+			case LinkType_FF:
+				c = shift( res.d_ef[i], l, false ) - dur[l.d_succ];
+				break;
+			case LinkType_SF:
+				c = shift( res.d_es[i], l, false ) - dur[l.d_succ];
+				break;
+			default: // LinkType_FS
+				c = shift( res.d_ef[i], l, false );
+				break;
+			}
+			res.d_es[l.d_succ] = qMax( res.d_es[l.d_succ], c );
+		}
+	}
+
+	// Backward Pass
+	res.d_lf.fill( res.d_finish, n );
+	for( int k = order.size() - 1; k >= 0; k-- )
+	{
+		const int i = order[k];
+		for( int e = outStart[i]; e < outStart[i + 1]; e++ )
+		{
+			const Link& l = links[ out[e] ];
+			qint32 c = 0;
+			switch( l.d_type )
+			{
+			case LinkType_SS:
+				c = shift( res.d_ls[l.d_succ], l, true ) + dur[i];
+				break;
+			case LinkType_FF:
+				c = shift( res.d_lf[l.d_succ], l, true );
+				break;
+			case LinkType_SF:
+				c = shift( res.d_lf[l.d_succ], l, true ) + dur[i];
+				break;
+			default: // LinkType_FS
+				c = shift( res.d_ls[l.d_succ], l, true );
+				break;
+			}
+			res.d_lf[i] = qMin( res.d_lf[i], c );
+		}
+		res.d_ls[i] = res.d_lf[i] - dur[i];
+	}
+	if( res.d_cyclic )
+	{
+		// Knoten in Zyklen bleiben ungeplant, erhalten aber konsistente Werte
+		QVector<bool> done( n, false );
+		for( int k = 0; k < order.size(); k++ )
+			done[ order[k] ] = true;
+		for( int i = 0; i < n; i++ )
+		{
+			if( done[i] )
+				continue;
+			res.d_ef[i] = res.d_es[i] + dur[i];
+			res.d_ls[i] = res.d_lf[i] - dur[i];
+		}
+	}
+	rollup( res );
+}
+
+Scenario::Scenario(ScheduleNet * base, const QString &name):d_base(base),d_name(name),d_hasRun(false)
+{
+	Q_ASSERT( base != 0 );
+	d_res = base->d_committed;
+}
+
+bool Scenario::setDuration(Udb::OID oid, quint16 workdays)
+{
+	const int i = d_base->indexOf( oid );
+	if( i == -1 || ( d_base->d_flags[i] & ScheduleNet::FlagMilestone ) )
+		return false;
+	if( d_base->d_dur[i] == workdays )
+		d_durations.remove( i );
+	else
+		d_durations[i] = workdays;
+	return true;
+}
+
+bool Scenario::slip(Udb::OID oid, int workdays)
+{
+	const int i = d_base->indexOf( oid );
+	if( i == -1 )
+		return false;
+	d_minStart[i] = d_base->d_committed.d_es[i] + workdays;
+	return true;
+}
+
+bool Scenario::setStartNoEarlierThan(Udb::OID oid, const QDate & d)
+{
+	const int i = d_base->indexOf( oid );
+	if( i == -1 || !d.isValid() )
+		return false;
+	d_minStart[i] = d_base->workdayOf( d_base->d_cal.nextWorkday( d ) );
+	return true;
+}
+
+bool Scenario::addLink(Udb::OID pred, Udb::OID succ, quint8 type, qint32 lag, bool elapsed)
+{
+	ScheduleNet::Link l;
+	l.d_pred = d_base->indexOf( pred );
+	l.d_succ = d_base->indexOf( succ );
+	if( l.d_pred == -1 || l.d_succ == -1 || l.d_pred == l.d_succ )
+		return false;
+	l.d_type = type;
+	l.d_lag = lag;
+	l.d_elapsed = elapsed;
+	l.d_oid = 0;
+	d_addedLinks.append( l );
+	return true;
+}
+
+bool Scenario::removeLink(Udb::OID link)
+{
+	for( int i = 0; i < d_base->d_links.size(); i++ )
+	{
+		if( d_base->d_links[i].d_oid == link )
+		{
+			d_removedLinks.insert( link );
+			return true;
+		}
+	}
+	return false;
+}
+
+void Scenario::reset()
+{
+	d_durations.clear();
+	d_minStart.clear();
+	d_removedLinks.clear();
+	d_addedLinks.clear();
+	d_res = d_base->d_committed;
+	d_hasRun = false;
+}
+
+bool Scenario::isModified() const
+{
+	return !d_durations.isEmpty() || !d_minStart.isEmpty() ||
+			!d_removedLinks.isEmpty() || !d_addedLinks.isEmpty();
+}
+
+void Scenario::run()
+{
+	// Copy-on-write: die Vektoren der Basis werden nur kopiert, wenn es Overrides gibt
+	QVector<quint16> dur = d_base->d_dur;
+	QHash<int,quint16>::const_iterator i;
+	for( i = d_durations.begin(); i != d_durations.end(); ++i )
+		dur[ i.key() ] = i.value();
+	QVector<ScheduleNet::Link> links = d_base->d_links;
+	if( !d_removedLinks.isEmpty() )
+	{
+		QVector<ScheduleNet::Link> tmp;
+		tmp.reserve( links.size() + d_addedLinks.size() );
+		for( int l = 0; l < links.size(); l++ )
+			if( !d_removedLinks.contains( links[l].d_oid ) )
+				tmp.append( links[l] );
+		links = tmp;
+	}
+	links += d_addedLinks;
+	d_base->schedule( dur, links, d_minStart, d_res );
+	d_hasRun = true;
+}
+
+static SchedSnapshot _toSnapshot( const ScheduleNet* net, const QHash<int,quint16>& durations,
+								  const ScheduleNet::Result& res )
+{
+	SchedSnapshot s;
+	const int n = net->d_oids.size();
+	s.reserve( n );
+	for( int i = 0; i < n; i++ )
+	{
+		const quint16 dur = durations.value( i, net->d_dur[i] );
+		const qint32 last = ( dur > 0 ) ? 1 : 0; // EF/LF sind exklusiv
+		s.d_oids.append( net->d_oids[i] );
+		s.d_es.append( net->dateOf( res.d_es[i] ).toJulianDay() );
+		s.d_ef.append( net->dateOf( res.d_ef[i] - last ).toJulianDay() );
+		s.d_ls.append( net->dateOf( res.d_ls[i] ).toJulianDay() );
+		s.d_lf.append( net->dateOf( res.d_lf[i] - last ).toJulianDay() );
+		s.d_dur.append( dur );
+		s.d_pv.append( 0 );
+		s.d_ev.append( 0 );
+		s.d_ac.append( 0 );
+		quint8 f = 0;
+		if( res.getFloat( i ) <= 0 )
+			f |= SchedSnapshot::FlagCritical;
+		if( net->d_flags[i] & ScheduleNet::FlagMilestone )
+			f |= SchedSnapshot::FlagMilestone;
+		s.d_flags.append( f );
+	}
+	return s;
+}
+
+SchedSnapshot Scenario::toSnapshot() const
+{
+	return _toSnapshot( d_base.constData(), d_durations, d_res );
+}
+
+ScheduleVariance Scenario::compare() const
+{
+	return ScheduleVariance::compute( toSnapshot(),
+		_toSnapshot( d_base.constData(), QHash<int,quint16>(), d_base->d_committed ) );
+}
+
+static void _setDate( Udb::Obj& o, quint32 atom, qint32 jd )
+{
+	const QDate d = QDate::fromJulianDay( jd );
+	if( o.getValue( atom ).getDate() != d )
+		o.setValue( atom, Stream::DataCell().setDate( d ) );
+}
+
+bool Scenario::promote(Udb::Transaction * txn) const
+{
+	Q_ASSERT( txn != 0 );
+	if( !d_minStart.isEmpty() )
+		return false;
+	QHash<int,quint16>::const_iterator i;
+	for( i = d_durations.begin(); i != d_durations.end(); ++i )
+	{
+		Udb::Obj o = txn->getObject( d_base->d_oids[ i.key() ] );
+		if( !o.isNull() )
+			o.setValue( AttrDuration, Stream::DataCell().setUInt16( i.value() ) );
+	}
+	foreach( Udb::OID oid, d_removedLinks )
+	{
+		Udb::Obj link = txn->getObject( oid );
+		ObjectHelper::erase( link );
+	}
+	foreach( const ScheduleNet::Link& l, d_addedLinks )
+	{
+		Udb::Obj pred = txn->getObject( d_base->d_oids[ l.d_pred ] );
+		Udb::Obj succ = txn->getObject( d_base->d_oids[ l.d_succ ] );
+		if( pred.isNull() || succ.isNull() )
+			continue;
+		Udb::Obj link = ObjectHelper::createObject( TypeLink, pred );
+		link.setValueAsObj( AttrPred, pred );
+		link.setValueAsObj( AttrSucc, succ );
+		link.setValue( AttrLinkType, Stream::DataCell().setUInt8( l.d_type ) );
+		if( l.d_lag != 0 )
+			link.setValue( AttrLag, Stream::DataCell().setInt32( l.d_lag ) );
+		if( l.d_elapsed )
+			link.setValue( AttrLagElapsed, Stream::DataCell().setBool( true ) );
+	}
+	if( !d_hasRun )
+		return true;
+	const SchedSnapshot s = toSnapshot();
+	for( int k = 0; k < s.size(); k++ )
+	{
+		Udb::Obj o = txn->getObject( s.d_oids[k] );
+		if( o.isNull() )
+			continue;
+		_setDate( o, AttrEarlyStart, s.d_es[k] );
+		_setDate( o, AttrEarlyFinish, s.d_ef[k] );
+		_setDate( o, AttrLateStart, s.d_ls[k] );
+		_setDate( o, AttrLateFinish, s.d_lf[k] );
+		const bool crit = s.d_flags[k] & SchedSnapshot::FlagCritical;
+		if( o.getValue( AttrCriticalPath ).getBool() != crit )
+			o.setValue( AttrCriticalPath, Stream::DataCell().setBool( crit ) );
+	}
+	return true;
+}
+
+static void _run( Scenario*& s )
+{
+	s->run();
+}
+
+void Scenario::runConcurrently(const QList<Scenario *> & l)
+{
+	QList<Scenario*> tmp = l;
+	QtConcurrent::blockingMap( tmp, _run );
+}
@@ -0,0 +1,127 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QSharedData>
+#include <QHash>
+#include <QSet>
+#include "Baseline.h"
+#include "WorkCalendar.h"
+#include "WtTypeDefs.h"
+
+namespace Wt
+{
+	// Unveränderliches In-Memory-Abbild des Terminnetzes (alle SchedObj und Links) zu einem
+	// Zeitpunkt. Zeiten werden als Workday-Index ab d_origin geführt; EF/LF sind exklusiv.
+	// Nach create() wird nichts mehr verändert, deshalb können beliebig viele Scenarios
+	// auf verschiedenen Threads gleichzeitig darauf zugreifen.
+	class ScheduleNet : public QSharedData
+	{
+	public:
+		enum Flag { FlagMilestone = 0x01, FlagSummary = 0x02 };
+		struct Link
+		{
+			int d_pred; // Index in d_oids
+			int d_succ;
+			quint8 d_type; // EnumDef_LinkType
+			qint32 d_lag; // Workdays bzw. Kalendertage wenn d_elapsed, negativ für Lead
+			bool d_elapsed;
+			Udb::OID d_oid; // 0 für Links, die nur im Scenario existieren
+		};
+		struct Result
+		{
+			QVector<qint32> d_es, d_ef, d_ls, d_lf;
+			int d_finish; // Projektende
+			int d_cyclic; // Anzahl Knoten, die wegen Zyklen nicht terminiert werden konnten
+			Result():d_finish(0),d_cyclic(0){}
+			qint32 getFloat( int i ) const { return d_lf[i] - d_ef[i]; }
+		};
+
+		QVector<Udb::OID> d_oids; // aufsteigend sortiert
+		QVector<quint16> d_dur;
+		QVector<quint8> d_flags;
+		QVector<Link> d_links;
+		QVector<int> d_parent; // Index des nächsten Summary-Vorfahren oder -1
+		QVector<int> d_rollup; // Knoten mit Summary-Vorfahren, tiefste zuerst
+		WorkCalendar d_cal;
+		QDate d_origin; // Workday-Index 0
+		Result d_committed; // Ergebnis ohne Overrides
+		// Adjazenz im CSR-Format: die ausgehenden Links von Knoten i sind
+		// d_links[ d_out[k] ] mit k in [ d_outStart[i], d_outStart[i+1] ); analog d_in
+		QVector<int> d_outStart, d_out, d_inStart, d_in;
+
+		static ScheduleNet* create( Udb::Transaction* );
+		int indexOf( Udb::OID ) const;
+		QDate dateOf( qint32 workday ) const;
+		qint32 workdayOf( const QDate& ) const;
+		void schedule( const QVector<quint16>& dur, const QVector<Link>& links,
+					   const QHash<int,qint32>& minStart, Result& ) const;
+	private:
+		ScheduleNet(){}
+		qint32 shift( qint32 workday, const Link& l, bool backward ) const;
+		void fillCache( int len );
+		void buildAdjacency();
+		void buildRollup( const QList<Udb::Obj>& );
+		void rollup( Result& ) const;
+		QVector<qint32> d_jd; // Cache Workday-Index -> Julian Day
+	};
+
+	// Copy-on-write Overlay über einem ScheduleNet: nur die Abweichungen werden gespeichert,
+	// das Repository bleibt unberührt bis promote() aufgerufen wird.
+	class Scenario
+	{
+	public:
+		explicit Scenario( ScheduleNet* base, const QString& name = QString() );
+		const QString& getName() const { return d_name; }
+		const ScheduleNet* getBase() const { return d_base.constData(); }
+
+		bool setDuration( Udb::OID, quint16 workdays );
+		bool slip( Udb::OID, int workdays ); // Start nicht vor committed ES + workdays
+		bool setStartNoEarlierThan( Udb::OID, const QDate& );
+		bool addLink( Udb::OID pred, Udb::OID succ, quint8 type = LinkType_FS, qint32 lag = 0, bool elapsed = false );
+		bool removeLink( Udb::OID link );
+		void reset();
+		bool isModified() const;
+
+		void run(); // Forward und Backward Pass; greift nur lesend auf die Basis zu
+		const ScheduleNet::Result& getResult() const { return d_res; }
+		SchedSnapshot toSnapshot() const;
+		// Vergleich gegen den mit derselben Logik terminierten committed Zustand
+		ScheduleVariance compare() const;
+		// Schreibt die Overrides und die berechneten Termine in die Transaktion; kein commit.
+		// Das Repository kennt keine Start-Constraints; mit slip() oder setStartNoEarlierThan()
+		// gesetzte Werte gingen verloren, deshalb wird dann nichts geschrieben und false geliefert.
+		bool promote( Udb::Transaction* ) const;
+
+		static void runConcurrently( const QList<Scenario*>& );
+	private:
+		QExplicitlySharedDataPointer<ScheduleNet> d_base;
+		QString d_name;
+		QHash<int,quint16> d_durations; // Knotenindex -> Workdays
+		QHash<int,qint32> d_minStart; // Knotenindex -> Workday-Index
+		QSet<Udb::OID> d_removedLinks;
+		QVector<ScheduleNet::Link> d_addedLinks;
+		ScheduleNet::Result d_res;
+		bool d_hasRun;
+	};
+}
+
+#endif // SCENARIO_H
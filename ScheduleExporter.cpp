@@ -0,0 +1,386 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "ScheduleExporter.h"
+#include "WtTypeDefs.h"
+#include "WorkTreeApp.h"
+#include <Udb/Transaction.h>
+#include <Udb/Idx.h>
+#include <QXmlStreamWriter>
+#include <QTextStream>
+#include <QFile>
+#include <QFileInfo>
+using namespace Wt;
+
+static const int s_minutesPerDay = 480;
+
+ScheduleExporter::ScheduleExporter(QObject *parent) :
+	QObject(parent),d_count(0)
+{
+}
+
+bool ScheduleExporter::exportFile(const Udb::Obj &root, const QString &path)
+{
+	QFile f( path );
+	if( !f.open( QIODevice::WriteOnly ) )
+	{
+		d_error = tr("Cannot open file for writing: %1").arg( path );
+		return false;
+	}
+	if( QFileInfo( path ).suffix().toLower() == QLatin1String("csv") )
+		return exportCsv( root, &f );
+	else
+		return exportMspdi( root, &f );
+}
+
+static void _collectScope( const Udb::Obj& parent, QSet<Udb::OID>& scope )
+{
+	Udb::Obj sub = parent.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		const quint32 type = sub.getType();
+		if( WtTypeDefs::isSchedObj( type ) )
+			scope.insert( sub.getOid() );
+		if( WtTypeDefs::isImpType( type ) )
+			_collectScope( sub, scope );
+	}while( sub.next() );
+}
+
+void ScheduleExporter::prepare(const Udb::Obj &root)
+{
+	d_error.clear();
+	d_count = 0;
+	d_scope.clear();
+	// Nur bei Teilexporten muss bekannt sein, welche Vorgänger mit exportiert werden
+	if( root.getType() != TypeIMP )
+		_collectScope( root, d_scope );
+}
+
+bool ScheduleExporter::isExported(Udb::OID oid) const
+{
+	return d_scope.isEmpty() || d_scope.contains( oid );
+}
+
+static inline QString _start( const QDate& d )
+{
+	return d.toString( Qt::ISODate ) + QLatin1String("T08:00:00");
+}
+
+static inline QString _finish( const QDate& d )
+{
+	return d.toString( Qt::ISODate ) + QLatin1String("T17:00:00");
+}
+
+static inline bool _isSummary( const Udb::Obj& o )
+{
+	// Events, Accomplishments und Criteria werden als Summary Tasks exportiert
+	if( o.getType() == TypeMilestone )
+		return false;
+	return o.getType() != TypeTask || o.getValue( AttrSubTMSCount ).getUInt32() > 0;
+}
+
+bool ScheduleExporter::exportMspdi(const Udb::Obj &root, QIODevice * out)
+{
+	Q_ASSERT( !root.isNull() && out != 0 );
+	prepare( root );
+	QXmlStreamWriter xml( out );
+	xml.setAutoFormatting( true );
+	xml.writeStartDocument();
+	xml.writeDefaultNamespace( QLatin1String("http://schemas.microsoft.com/project") );
+	xml.writeStartElement( QLatin1String("Project") );
+	xml.writeTextElement( QLatin1String("SaveVersion"), QLatin1String("12") );
+	xml.writeTextElement( QLatin1String("Name"), WtTypeDefs::formatObjectTitle( root ) );
+	xml.writeTextElement( QLatin1String("Title"), root.getString( AttrText ) );
+	const QDate start = WtTypeDefs::getProject( root.getTxn() ).getValue( AttrProjStartDate ).getDate();
+	if( start.isValid() )
+		xml.writeTextElement( QLatin1String("StartDate"), _start( start ) );
+	xml.writeTextElement( QLatin1String("MinutesPerDay"), QString::number( s_minutesPerDay ) );
+	xml.writeTextElement( QLatin1String("MinutesPerWeek"), QString::number( s_minutesPerDay * 5 ) );
+	xml.writeTextElement( QLatin1String("DaysPerMonth"), QLatin1String("20") );
+	const Udb::Obj defCal = WtTypeDefs::getCalendars( root.getTxn() ).getValueAsObj( AttrDefaultCal );
+	if( !defCal.isNull() )
+		xml.writeTextElement( QLatin1String("CalendarUID"), QString::number( defCal.getOid() ) );
+	writeCalendars( xml, root.getTxn() );
+
+	xml.writeStartElement( QLatin1String("Tasks") );
+	// Project Summary Task
+	xml.writeStartElement( QLatin1String("Task") );
+	xml.writeTextElement( QLatin1String("UID"), QLatin1String("0") );
+	xml.writeTextElement( QLatin1String("ID"), QLatin1String("0") );
+	xml.writeTextElement( QLatin1String("Name"), root.getString( AttrText ) );
+	xml.writeTextElement( QLatin1String("OutlineLevel"), QLatin1String("0") );
+	xml.writeTextElement( QLatin1String("Summary"), QLatin1String("1") );
+	xml.writeEndElement();
+	writeTasks( xml, root, 1 );
+	xml.writeEndElement(); // Tasks
+
+	xml.writeEndElement(); // Project
+	xml.writeEndDocument();
+	if( xml.hasError() )
+		d_error = tr("Error writing to device");
+	return !xml.hasError();
+}
+
+void ScheduleExporter::writeCalendars(QXmlStreamWriter & xml, Udb::Transaction* txn)
+{
+	xml.writeStartElement( QLatin1String("Calendars") );
+	Udb::Obj cal = WtTypeDefs::getCalendars( txn ).getFirstObj();
+	if( !cal.isNull() ) do
+	{
+		if( cal.getType() != TypeCalendar )
+			continue;
+		xml.writeStartElement( QLatin1String("Calendar") );
+		xml.writeTextElement( QLatin1String("UID"), QString::number( cal.getOid() ) );
+		xml.writeTextElement( QLatin1String("Name"), cal.getString( AttrText ) );
+		xml.writeTextElement( QLatin1String("IsBaseCalendar"), QLatin1String("1") );
+		const Udb::Obj parent = cal.getValueAsObj( AttrParentCalendar );
+		xml.writeTextElement( QLatin1String("BaseCalendarUID"),
+							  ( parent.isNull() )? QString("-1") : QString::number( parent.getOid() ) );
+		const QByteArray nwd = cal.getValue( AttrNonWorkingDays ).getArr();
+		xml.writeStartElement( QLatin1String("WeekDays") );
+		for( int i = 0; i < 7; i++ )
+		{
+			// Ohne Parent gilt für undefinierte Tage die Five-day Week
+			char c = ( i < nwd.size() )? nwd[i] : ' ';
+			if( c == ' ' && parent.isNull() )
+				c = ( i >= 5 )? '1' : '0';
+			if( c == ' ' )
+				continue;
+			xml.writeStartElement( QLatin1String("WeekDay") );
+			xml.writeTextElement( QLatin1String("DayType"), QString::number( ( i + 1 ) % 7 + 1 ) ); // 1=Sonntag
+			xml.writeTextElement( QLatin1String("DayWorking"), ( c == '0' )? QLatin1String("1") : QLatin1String("0") );
+			if( c == '0' )
+			{
+				xml.writeStartElement( QLatin1String("WorkingTimes") );
+				xml.writeStartElement( QLatin1String("WorkingTime") );
+				xml.writeTextElement( QLatin1String("FromTime"), QLatin1String("08:00:00") );
+				xml.writeTextElement( QLatin1String("ToTime"), QLatin1String("12:00:00") );
+				xml.writeEndElement();
+				xml.writeStartElement( QLatin1String("WorkingTime") );
+				xml.writeTextElement( QLatin1String("FromTime"), QLatin1String("13:00:00") );
+				xml.writeTextElement( QLatin1String("ToTime"), QLatin1String("17:00:00") );
+				xml.writeEndElement();
+				xml.writeEndElement();
+			}
+			xml.writeEndElement();
+		}
+		xml.writeEndElement(); // WeekDays
+		bool hasExceptions = false;
+		Udb::Obj e = cal.getFirstObj();
+		if( !e.isNull() ) do
+		{
+			const QDate from = e.getValue( AttrCalDate ).getDate();
+			const Stream::DataCell nw = e.getValue( AttrNonWorking );
+			if( e.getType() != TypeCalEntry || !from.isValid() || nw.isNull() )
+				continue;
+			if( !hasExceptions )
+			{
+				xml.writeStartElement( QLatin1String("Exceptions") );
+				hasExceptions = true;
+			}
+			int dur = e.getValue( AttrCalDuration ).getUInt16();
+			if( dur == 0 )
+				dur = 1;
+			xml.writeStartElement( QLatin1String("Exception") );
+			xml.writeTextElement( QLatin1String("EnteredByOccurrences"), QLatin1String("0") );
+			xml.writeStartElement( QLatin1String("TimePeriod") );
+			xml.writeTextElement( QLatin1String("FromDate"), from.toString( Qt::ISODate ) + QLatin1String("T00:00:00") );
+			xml.writeTextElement( QLatin1String("ToDate"), from.addDays( dur - 1 ).toString( Qt::ISODate ) +
+								  QLatin1String("T23:59:00") );
+			xml.writeEndElement();
+			xml.writeTextElement( QLatin1String("Occurrences"), QLatin1String("1") );
+			xml.writeTextElement( QLatin1String("Name"), e.getString( AttrText ) );
+			xml.writeTextElement( QLatin1String("Type"), QLatin1String("1") );
+			xml.writeTextElement( QLatin1String("DayWorking"), ( nw.getBool() )? QLatin1String("0") : QLatin1String("1") );
+			xml.writeEndElement();
+		}while( e.next() );
+		if( hasExceptions )
+			xml.writeEndElement();
+		xml.writeEndElement(); // Calendar
+	}while( cal.next() );
+	xml.writeEndElement(); // Calendars
+}
+
+static inline QString _mspdiLinkType( quint8 t )
+{
+	switch( t )
+	{
+	case LinkType_FF:
+		return QLatin1String("0");
+	case LinkType_SF:
+		return QLatin1String("2");
+	case LinkType_SS:
+		return QLatin1String("3");
+	default:
+		return QLatin1String("1");
+	}
+}
+
+void ScheduleExporter::writeTasks(QXmlStreamWriter & xml, const Udb::Obj &parent, int level)
+{
+	Udb::Obj o = parent.getFirstObj();
+	if( !o.isNull() ) do
+	{
+		const quint32 type = o.getType();
+		if( !WtTypeDefs::isImpType( type ) )
+			continue;
+		const bool summary = _isSummary( o );
+		const bool ms = type == TypeMilestone;
+		d_count++;
+		xml.writeStartElement( QLatin1String("Task") );
+		xml.writeTextElement( QLatin1String("UID"), QString::number( o.getOid() ) );
+		xml.writeTextElement( QLatin1String("ID"), QString::number( d_count ) );
+		xml.writeTextElement( QLatin1String("Name"), o.getString( AttrText ) );
+		const QString id = WtTypeDefs::formatObjectId( o );
+		if( !id.isEmpty() )
+			xml.writeTextElement( QLatin1String("WBS"), id );
+		xml.writeTextElement( QLatin1String("OutlineLevel"), QString::number( level ) );
+		const QDate es = o.getValue( AttrEarlyStart ).getDate();
+		const QDate ef = ( ms )? es : o.getValue( AttrEarlyFinish ).getDate();
+		const QDate ls = o.getValue( AttrLateStart ).getDate();
+		const QDate lf = ( ms )? ls : o.getValue( AttrLateFinish ).getDate();
+		if( es.isValid() )
+			xml.writeTextElement( QLatin1String("Start"), _start( es ) );
+		if( ef.isValid() )
+			xml.writeTextElement( QLatin1String("Finish"), ( ms )? _start( ef ) : _finish( ef ) );
+		const int dur = ( ms )? 0 : o.getValue( AttrDuration ).getUInt16();
+		xml.writeTextElement( QLatin1String("Duration"), QString("PT%1H0M0S").arg( dur * s_minutesPerDay / 60 ) );
+		xml.writeTextElement( QLatin1String("DurationFormat"), QLatin1String("7") );
+		xml.writeTextElement( QLatin1String("Milestone"), ( ms )? QLatin1String("1") : QLatin1String("0") );
+		xml.writeTextElement( QLatin1String("Summary"), ( summary )? QLatin1String("1") : QLatin1String("0") );
+		xml.writeTextElement( QLatin1String("Critical"),
+							  ( o.getValue( AttrCriticalPath ).getBool() )? QLatin1String("1") : QLatin1String("0") );
+		if( es.isValid() )
+			xml.writeTextElement( QLatin1String("EarlyStart"), _start( es ) );
+		if( ef.isValid() )
+			xml.writeTextElement( QLatin1String("EarlyFinish"), ( ms )? _start( ef ) : _finish( ef ) );
+		if( ls.isValid() )
+			xml.writeTextElement( QLatin1String("LateStart"), _start( ls ) );
+		if( lf.isValid() )
+			xml.writeTextElement( QLatin1String("LateFinish"), ( ms )? _start( lf ) : _finish( lf ) );
+		const Udb::Obj cal = o.getValueAsObj( AttrCalendar );
+		xml.writeTextElement( QLatin1String("CalendarUID"),
+							  ( cal.isNull() )? QString("-1") : QString::number( cal.getOid() ) );
+		if( WtTypeDefs::isSchedObj( type ) )
+		{
+			Udb::Idx idx( o.getTxn(), IndexDefs::IdxSucc );
+			if( idx.seek( Stream::DataCell().setOid( o.getOid() ) ) ) do
+			{
+				const Udb::Obj link = o.getObject( idx.getOid() );
+				if( link.isNull() )
+					continue;
+				const Udb::OID pred = link.getValue( AttrPred ).getOid();
+				if( !isExported( pred ) )
+					continue;
+				const bool elapsed = link.getValue( AttrLagElapsed ).getBool();
+				xml.writeStartElement( QLatin1String("PredecessorLink") );
+				xml.writeTextElement( QLatin1String("PredecessorUID"), QString::number( pred ) );
+				xml.writeTextElement( QLatin1String("Type"), _mspdiLinkType( link.getValue( AttrLinkType ).getUInt8() ) );
+				xml.writeTextElement( QLatin1String("CrossProject"), QLatin1String("0") );
+				// LinkLag in Zehntelminuten
+				xml.writeTextElement( QLatin1String("LinkLag"), QString::number(
+										  qint64( link.getValue( AttrLag ).getInt32() ) * 10 *
+										  ( ( elapsed )? 24 * 60 : s_minutesPerDay ) ) );
+				xml.writeTextElement( QLatin1String("LagFormat"), ( elapsed )? QLatin1String("8") : QLatin1String("7") );
+				xml.writeEndElement();
+			}while( idx.nextKey() );
+		}
+		xml.writeEndElement(); // Task
+		// Subtasks folgen in MSPDI als flache Liste mit OutlineLevel
+		if( summary )
+			writeTasks( xml, o, level + 1 );
+	}while( o.next() );
+}
+
+static inline QString _csv( const QString& str )
+{
+	if( str.contains( QChar(',') ) || str.contains( QChar('"') ) || str.contains( QChar('\n') ) )
+	{
+		QString res = str;
+		res.replace( QChar('"'), QLatin1String("\"\"") );
+		return QChar('"') + res + QChar('"');
+	}else
+		return str;
+}
+
+static inline QString _csvDate( const QDate& d )
+{
+	return ( d.isValid() )? d.toString( Qt::ISODate ) : QString();
+}
+
+bool ScheduleExporter::exportCsv(const Udb::Obj &root, QIODevice * out)
+{
+	Q_ASSERT( !root.isNull() && out != 0 );
+	prepare( root );
+	QTextStream ts( out );
+	ts.setCodec( "UTF-8" );
+	ts << "OID,ID,Parent,Type,Level,Name,Duration,EarlyStart,EarlyFinish,LateStart,LateFinish,"
+		  "Critical,Calendar,Predecessors\n";
+	writeCsv( ts, root, 1 );
+	ts.flush();
+	if( ts.status() != QTextStream::Ok )
+		d_error = tr("Error writing to device");
+	return ts.status() == QTextStream::Ok;
+}
+
+void ScheduleExporter::writeCsv(QTextStream & ts, const Udb::Obj &parent, int level)
+{
+	Udb::Obj o = parent.getFirstObj();
+	if( !o.isNull() ) do
+	{
+		const quint32 type = o.getType();
+		if( !WtTypeDefs::isImpType( type ) )
+			continue;
+		d_count++;
+		const bool ms = type == TypeMilestone;
+		QString preds;
+		if( WtTypeDefs::isSchedObj( type ) )
+		{
+			// Vorgänger im Format ID:Typ[+Lag], z.B. T012:FS+3d;M004:SS
+			Udb::Idx idx( o.getTxn(), IndexDefs::IdxSucc );
+			if( idx.seek( Stream::DataCell().setOid( o.getOid() ) ) ) do
+			{
+				const Udb::Obj link = o.getObject( idx.getOid() );
+				if( link.isNull() )
+					continue;
+				const Udb::Obj pred = link.getValueAsObj( AttrPred );
+				if( pred.isNull() || !isExported( pred.getOid() ) )
+					continue;
+				if( !preds.isEmpty() )
+					preds += QChar(';');
+				preds += WtTypeDefs::formatObjectId( pred, true ) + QChar(':') + WtTypeDefs::formatLinkCode( link );
+			}while( idx.nextKey() );
+		}
+		ts << o.getOid() << ',' << _csv( WtTypeDefs::formatObjectId( o ) ) << ',' <<
+			  ( ( parent.getType() == TypeIMP )? Udb::OID(0) : parent.getOid() ) << ',' <<
+			  _csv( WtTypeDefs::prettyName( type ) ) << ',' << level << ',' <<
+			  _csv( o.getString( AttrText ) ) << ',';
+		if( !ms && type == TypeTask )
+			ts << o.getValue( AttrDuration ).getUInt16();
+		ts << ',' << _csvDate( o.getValue( AttrEarlyStart ).getDate() ) << ',' <<
+			  _csvDate( o.getValue( ( ms )? AttrEarlyStart : AttrEarlyFinish ).getDate() ) << ',' <<
+			  _csvDate( o.getValue( AttrLateStart ).getDate() ) << ',' <<
+			  _csvDate( o.getValue( ( ms )? AttrLateStart : AttrLateFinish ).getDate() ) << ',' <<
+			  ( ( o.getValue( AttrCriticalPath ).getBool() )? "1" : "0" ) << ',' <<
+			  _csv( o.getValueAsObj( AttrCalendar ).getString( AttrText ) ) << ',' <<
+			  _csv( preds ) << '\n';
+		if( _isSummary( o ) )
+			writeCsv( ts, o, level + 1 );
+	}while( o.next() );
+}
@@ -0,0 +1,60 @@
+#ifndef SCHEDULEEXPORTER_H
+#define SCHEDULEEXPORTER_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QSet>
+#include <Udb/Obj.h>
+
+class QIODevice;
+class QXmlStreamWriter;
+class QTextStream;
+
+namespace Wt
+{
+	// Schreibt IMP-Hierarchie, Links, Kalender und Termine als MSPDI (MS Project XML) oder CSV.
+	// Die Datenbank wird in einem Durchgang gelesen und direkt in den Stream geschrieben;
+	// als UID wird die OID verwendet, damit keine Zuordnungstabelle nötig ist.
+	class ScheduleExporter : public QObject
+	{
+		Q_OBJECT
+	public:
+		explicit ScheduleExporter(QObject *parent = 0);
+		// root ist das IMP oder ein beliebiges Element darin
+		bool exportMspdi( const Udb::Obj& root, QIODevice* );
+		bool exportCsv( const Udb::Obj& root, QIODevice* );
+		// Format nach Dateiendung: .csv, sonst MSPDI
+		bool exportFile( const Udb::Obj& root, const QString& path );
+		const QString& getError() const { return d_error; }
+		quint32 getCount() const { return d_count; }
+	private:
+		void prepare( const Udb::Obj& root );
+		void writeCalendars( QXmlStreamWriter&, Udb::Transaction* );
+		void writeTasks( QXmlStreamWriter&, const Udb::Obj& parent, int level );
+		void writeCsv( QTextStream&, const Udb::Obj& parent, int level );
+		bool isExported( Udb::OID ) const;
+		QSet<Udb::OID> d_scope; // leer wenn das ganze IMP exportiert wird
+		QString d_error;
+		quint32 d_count;
+	};
+}
+
+#endif // SCHEDULEEXPORTER_H
@@ -0,0 +1,166 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "ScriptRunner.h"
+#include <Udb/LuaBinding.h>
+#include <Udb/Transaction.h>
+#include <Udb/DatabaseException.h>
+#include <Oln2/LuaBinding.h>
+#include <Script/Engine2.h>
+#include "WtTypeDefs.h"
+using namespace Wt;
+
+static const char* s_runner = "WtScriptRunner"; // Registry
+static const int s_hookCount = 1000; // Instruktionen zwischen zwei Abbruch-Checks
+
+namespace Wt
+{
+	struct _ScriptRunnerAccess
+	{
+		static ScriptRunner* get( lua_State *L )
+		{
+			lua_getfield( L, LUA_REGISTRYINDEX, s_runner );
+			ScriptRunner* r = (ScriptRunner*)lua_touserdata( L, -1 );
+			lua_pop( L, 1 );
+			return r;
+		}
+		static int print( lua_State *L )
+		{
+			QByteArray line;
+			const int n = lua_gettop( L );
+			lua_getglobal( L, "tostring" );
+			for( int i = 1; i <= n; i++ )
+			{
+				lua_pushvalue( L, -1 );
+				lua_pushvalue( L, i );
+				lua_call( L, 1, 1 );
+				const char* s = lua_tostring( L, -1 );
+				if( s == 0 )
+					return luaL_error( L, "'tostring' must return a string to 'print'" );
+				if( i > 1 )
+					line += '\t';
+				line += s;
+				lua_pop( L, 1 );
+			}
+			emit get( L )->output( QString::fromUtf8( line ) );
+			return 0;
+		}
+		static int progress( lua_State *L )
+		{
+			// progress( percent [, text] )
+			const int percent = qBound( 0, int( luaL_checkinteger( L, 1 ) ), 100 );
+			emit get( L )->progress( percent, QString::fromUtf8( luaL_optstring( L, 2, "" ) ) );
+			return 0;
+		}
+		static int isCanceled( lua_State *L )
+		{
+			lua_pushboolean( L, get( L )->isCanceled() );
+			return 1;
+		}
+		static void hook( lua_State *L, lua_Debug* )
+		{
+			if( get( L )->isCanceled() )
+				luaL_error( L, "script canceled" );
+		}
+	};
+}
+
+ScriptRunner::ScriptRunner(const QByteArray &source, const QByteArray &name, bool writeBack):
+	d_source( source ),d_name( name ),d_applied(0),d_conflicts(0),d_writeBack( writeBack )
+{
+}
+
+void ScriptRunner::compute(Udb::Transaction * snap)
+{
+	lua_State* L = luaL_newstate();
+	if( L == 0 )
+	{
+		setError( tr("cannot create Lua state") );
+		return;
+	}
+	try
+	{
+		luaL_openlibs( L );
+		Udb::LuaBinding::install( L );
+		Oln::LuaBinding::install( L );
+		LuaBinding::install( L );
+		lua_pushlightuserdata( L, this );
+		lua_setfield( L, LUA_REGISTRYINDEX, s_runner );
+		lua_pushcfunction( L, _ScriptRunnerAccess::print );
+		lua_setfield( L, LUA_GLOBALSINDEX, "print" );
+		lua_pushcfunction( L, _ScriptRunnerAccess::progress );
+		lua_setfield( L, LUA_GLOBALSINDEX, "progress" );
+		lua_pushcfunction( L, _ScriptRunnerAccess::isCanceled );
+		lua_setfield( L, LUA_GLOBALSINDEX, "isCanceled" );
+		LuaBinding::setRepository( L, snap );
+		LuaBinding::setWriteQueue( L, ( d_writeBack ) ? &d_queue : 0 );
+		LuaBinding::setReadOnly( L, true );
+		lua_sethook( L, _ScriptRunnerAccess::hook, LUA_MASKCOUNT, s_hookCount );
+
+		if( luaL_loadbuffer( L, d_source.constData(), d_source.size(), d_name.constData() ) != 0 ||
+				lua_pcall( L, 0, 0, 0 ) != 0 )
+		{
+			const char* msg = lua_tostring( L, -1 );
+			setError( QString::fromUtf8( ( msg ) ? msg : "unknown Lua error" ) );
+		}
+	}catch( ... )
+	{
+		lua_close( L );
+		throw;
+	}
+	// Auf dem Worker schliessen, damit die Obj der Worker-Transaktion hier freigegeben werden
+	lua_close( L );
+}
+
+bool ScriptRunner::apply(Udb::Transaction * txn)
+{
+	if( isStale() && !d_queue.isEmpty() )
+	{
+		// Das Script kann einen halb committeten Stand gelesen haben; auch Werte, die es
+		// nur zur Berechnung gelesen hat, sind nicht mehr gesichert. Nicht wiederholt, weil
+		// output schon gesendet wurde.
+		d_conflicts += d_queue.size();
+		emit output( tr("the repository was changed while the script was running; %1 changes not written").
+					 arg( d_queue.size() ) );
+		d_queue.clear();
+		return false;
+	}
+	foreach( const LuaBinding::QueuedWrite& w, d_queue )
+	{
+		Udb::Obj o = txn->getObject( w.d_oid );
+		if( o.isNull() )
+			continue; // inzwischen geloescht
+		if( !o.getValue( w.d_atom ).equals( w.d_old ) )
+		{
+			// Seit dem Lesen durch das Script geaendert; nicht ueberschreiben
+			d_conflicts++;
+			emit output( tr("conflict: %1 of %2 was changed while the script was running; not written").
+						 arg( WtTypeDefs::prettyName( w.d_atom ) ).arg( WtTypeDefs::formatObjectTitle( o ) ) );
+			continue;
+		}
+		if( w.d_value.isNull() )
+			o.clearValue( w.d_atom );
+		else
+			o.setValue( w.d_atom, w.d_value );
+		o.setTimeStamp( AttrModifiedOn );
+		d_applied++;
+	}
+	d_queue.clear();
+	return d_applied > 0;
+}
@@ -0,0 +1,66 @@
+#ifndef SCRIPTRUNNER_H
+#define SCRIPTRUNNER_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "WorkerPool.h"
+#include "WtLuaBinding.h"
+
+namespace Wt
+{
+	// Führt ein Lua-Script in einem eigenen lua_State auf einem Worker-Thread des WorkerPool
+	// aus; das GUI bleibt bedienbar. Das Script sieht den Stand der letzten Commits und kann
+	// nichts direkt ändern; schreibende Funktionen der Lua-Bindung lösen einen Fehler aus.
+	// Mit writeBack sammelt wt:queueSet Änderungen, die nach erfolgreichem Ende auf dem
+	// GUI-Thread mit der Schreib-Transaktion des Pools geschrieben werden. Eine Änderung, deren
+	// Attribut inzwischen einen anderen Wert hat als beim Lesen durch das Script, wird als
+	// Konflikt übersprungen und über output gemeldet.
+	// Im Script verfügbar: print (geht an output), progress( percent [, text] ) und
+	// isCanceled(). cancel() bricht das Script über einen Count-Hook beim nächsten Check ab.
+	// Objekte im Script gehören zur Worker-Transaktion; Qt-Objekte und Editor-Funktionen
+	// sind hier nicht installiert.
+	class ScriptRunner : public WorkerTask
+	{
+		Q_OBJECT
+	public:
+		ScriptRunner( const QByteArray& source, const QByteArray& name, bool writeBack = false );
+		const QByteArray& getName() const { return d_name; }
+		bool isWriteBack() const { return d_writeBack; }
+		int getWriteCount() const { return d_applied; }
+		int getConflictCount() const { return d_conflicts; }
+	signals:
+		// werden auf dem Worker-Thread emittiert und kommen queued beim Empfänger an
+		void output( const QString& );
+		void progress( int percent, const QString& );
+	protected:
+		void compute( Udb::Transaction* snap );
+		bool apply( Udb::Transaction* );
+	private:
+		friend struct _ScriptRunnerAccess;
+		QByteArray d_source;
+		QByteArray d_name;
+		LuaBinding::WriteQueue d_queue;
+		int d_applied;
+		int d_conflicts;
+		bool d_writeBack;
+	};
+}
+
+#endif // SCRIPTRUNNER_H
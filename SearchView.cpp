@@ -34,6 +34,7 @@
 #include <Oln2/OutlineUdbMdl.h>
 #include <Udb/Transaction.h>
 #include "Indexer.h"
+#include "QueryEngine.h"
 #include "Funcs.h"
 //#include "Funcs.h"
 using namespace Wt;
@@ -112,20 +113,19 @@ SearchView::~SearchView()
 {
 }
 
-void SearchView::onSearch()
+bool SearchView::ensureIndex()
 {
-	Indexer::ResultList res;
 	if( !d_idx->exists() )
 	{
 		if( QMessageBox::question( this, tr("WorkTree Search"),
 			tr("The index does not yet exist. Do you want to build it? This will take some minutes." ),
 			QMessageBox::Ok | QMessageBox::Cancel ) == QMessageBox::Cancel )
-			return;
+			return false;
 		if( !d_idx->indexRepository( this ) )
 		{
 			if( !d_idx->getError().isEmpty() )
 				QMessageBox::critical( this, tr("WorkTree Indexer"), d_idx->getError() );
-			return;
+			return false;
 		}
 	}else if( d_idx->hasPendingUpdates() )
 	{
@@ -138,10 +138,48 @@ void SearchView::onSearch()
 			{
 				if( !d_idx->getError().isEmpty() )
 					QMessageBox::critical( this, tr("WorkTree Indexer"), d_idx->getError() );
-				return;
+				return false;
 			}
 		}
 	}
+	return true;
+}
+
+void SearchView::onSearch()
+{
+	if( d_engine )
+		delete d_engine; // bricht die vorherige strukturierte Suche ab
+	if( QueryEngine::isStructured( d_query->text() ) )
+	{
+		// Strukturierte Query; der Lucene-Index wird nur fuer Volltext-Begriffe gebraucht.
+		// Die Kandidaten werden im Hintergrund gefiltert, das Resultat kommt in onQueryFinished.
+		QueryEngine* qe = new QueryEngine( d_idx, this );
+		if( !qe->parse( d_query->text() ) )
+		{
+			QMessageBox::critical( this, tr("WorkTree Search"), qe->getError() );
+			delete qe;
+			return;
+		}
+		if( qe->hasFullText() && !ensureIndex() )
+		{
+			delete qe;
+			return;
+		}
+		connect( qe, SIGNAL(finished(bool)), this, SLOT(onQueryFinished(bool)) );
+		if( !qe->start() )
+		{
+			QMessageBox::critical( this, tr("WorkTree Search"), qe->getError() );
+			delete qe;
+			return;
+		}
+		d_engine = qe;
+		d_result->clear();
+		d_query->setToolTip( tr("searching via %1...").arg( qe->getPlan() ) );
+		return;
+	}
+	if( !ensureIndex() )
+		return;
+	Indexer::ResultList res;
 	QApplication::setOverrideCursor( Qt::WaitCursor );
 	if( !d_idx->query( d_query->text(), res ) )
 	{
@@ -149,6 +187,28 @@ void SearchView::onSearch()
 		QMessageBox::critical( this, tr("WorkTree Search"), d_idx->getError() );
 		return;
 	}
+	QApplication::restoreOverrideCursor();
+	d_query->setToolTip( QString() );
+	showResult( res );
+}
+
+void SearchView::onQueryFinished(bool ok)
+{
+	QueryEngine* qe = static_cast<QueryEngine*>( sender() );
+	qe->deleteLater();
+	d_engine = 0;
+	if( !ok )
+	{
+		QMessageBox::critical( this, tr("WorkTree Search"), qe->getError() );
+		return;
+	}
+	d_query->setToolTip( tr("%1 hits via %2").arg( qe->getResult().size() ).arg( qe->getPlan() ) );
+	showResult( qe->getResult() );
+}
+
+void SearchView::showResult(const Indexer::ResultList & res)
+{
+	QApplication::setOverrideCursor( Qt::WaitCursor );
 	d_result->clear();
 	for( int i = 0; i < res.size(); i++ )
 	{
@@ -211,6 +271,11 @@ void SearchView::onOpen()
     emit signalOpenItem( d_idx->getTxn()->getObject( cur->data( s_objectCol,Qt::UserRole).toULongLong() ) );
 }
 
+void SearchView::flushIndex()
+{
+	d_idx->flushPendings();
+}
+
 void SearchView::onCopyRef()
 {
 	ENABLED_IF( d_result->currentItem() );
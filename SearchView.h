@@ -21,14 +21,16 @@
 */
 
 #include <QWidget>
+#include <QPointer>
 #include <Udb/Obj.h>
+#include "Indexer.h"
 class QTreeWidget;
 class QLineEdit;
 
 namespace Wt
 {
 	// Kopie von MasterPlan
-	class Indexer;
+	class QueryEngine;
 
 	class SearchView : public QWidget
 	{
@@ -37,6 +39,7 @@ namespace Wt
 		~SearchView();
 		SearchView( QWidget*, Udb::Transaction * );
 		Udb::Obj getItem() const;
+		void flushIndex(); // persistiert die Pendings des Indexers; vor dem Schliessen aufrufen
 	signals:
 		void signalShowItem( const Udb::Obj& );
         void signalOpenItem( const Udb::Obj& );
@@ -49,10 +52,15 @@ namespace Wt
 		void onUpdateIndex();
 		void onClearSearch();
 		void onCopyRef();
+	protected slots:
+		void onQueryFinished( bool );
 	private:
+		bool ensureIndex();
+		void showResult( const Indexer::ResultList& );
 		QLineEdit* d_query;
 		QTreeWidget* d_result;
 		Indexer* d_idx;
+		QPointer<QueryEngine> d_engine; // laufende strukturierte Suche
 	};
 }
 
@@ -0,0 +1,74 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "StartupProfile.h"
+#include <QStringList>
+#include <stdio.h>
+using namespace Wt;
+
+StartupProfile::StartupProfile():d_running(false),d_print(false)
+{
+}
+
+StartupProfile *StartupProfile::inst()
+{
+	static StartupProfile s_inst;
+	return &s_inst;
+}
+
+void StartupProfile::start(const QString &what)
+{
+	d_what = what;
+	d_stages.clear();
+	d_running = true;
+	d_total.start();
+	d_lap.start();
+}
+
+void StartupProfile::mark(const QString &stage)
+{
+	if( !d_running )
+		return; // Nach finish() werden z.B. später geöffnete Docks nicht mehr erfasst
+	Stage s;
+	s.d_name = stage;
+	s.d_ms = d_lap.restart();
+	s.d_total = d_total.elapsed();
+	d_stages.append( s );
+}
+
+void StartupProfile::finish()
+{
+	if( !d_running )
+		return;
+	mark( QLatin1String( "interactive" ) );
+	d_running = false;
+	if( d_print )
+		fprintf( stderr, "%s\n", toString().toLocal8Bit().constData() );
+}
+
+QString StartupProfile::toString() const
+{
+	QStringList lines;
+	lines << QString( "Startup profile %1" ).arg( d_what );
+	foreach( const Stage& s, d_stages )
+		lines << QString( "%1 ms %2 ms  %3" ).arg( s.d_ms, 7 ).arg( s.d_total, 7 ).arg( s.d_name );
+	if( d_running )
+		lines << QLatin1String( "(not finished)" );
+	return lines.join( QChar('\n') );
+}
@@ -0,0 +1,60 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QString>
+#include <QList>
+#include <QTime>
+
+namespace Wt
+{
+	// Misst die Phasen vom Programmstart bzw. Öffnen eines Repositories bis die Anwendung
+	// bedienbar ist. mark() schliesst die laufende Phase ab und beginnt die nächste.
+	class StartupProfile
+	{
+	public:
+		struct Stage
+		{
+			QString d_name;
+			int d_ms; // Dauer der Phase
+			int d_total; // seit start()
+		};
+		static StartupProfile* inst();
+
+		void start( const QString& what );
+		void mark( const QString& stage );
+		void finish(); // letzte Phase; gibt das Profil auf stderr aus, falls setPrint(true)
+		bool isRunning() const { return d_running; }
+		const QList<Stage>& getStages() const { return d_stages; }
+		QString toString() const;
+		void setPrint( bool on ) { d_print = on; }
+	private:
+		StartupProfile();
+		QString d_what;
+		QTime d_total;
+		QTime d_lap;
+		QList<Stage> d_stages;
+		bool d_running;
+		bool d_print;
+	};
+}
+
+#endif // STARTUPPROFILE_H
@@ -0,0 +1,284 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "StatusTrend.h"
+#include "WtTypeDefs.h"
+#include <Udb/Transaction.h>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDataStream>
+using namespace Wt;
+
+// Datei: "WTTR" version:uint8 { magic:uint32 status:int32(jd) recorded:uint32(time_t) size:uint32 block }*
+static const char* s_fileMagic = "WTTR";
+static const quint8 s_version = 1;
+static const quint32 s_cycleMagic = 0x57544359; // WTCY
+static const int s_headerSize = 5;
+
+StatusTrend::StatusTrend(const QString &dbPath):d_path( getTrendPath( dbPath ) )
+{
+}
+
+QString StatusTrend::getTrendPath(const QString &dbPath)
+{
+	QFileInfo info( dbPath );
+	return info.absoluteDir().absoluteFilePath( info.completeBaseName() + QLatin1String( ".trend" ) );
+}
+
+static bool _checkHeader( QFile& f )
+{
+	const QByteArray h = f.read( s_headerSize );
+	return h.size() == s_headerSize && h.startsWith( s_fileMagic ) && quint8( h[4] ) == s_version;
+}
+
+QList<StatusTrend::Cycle> StatusTrend::getCycles()
+{
+	// Liest nur die Blockköpfe und springt über die Daten
+	d_error.clear();
+	QList<Cycle> res;
+	QFile f( d_path );
+	if( !f.exists() )
+		return res;
+	if( !f.open( QIODevice::ReadOnly ) || !_checkHeader( f ) )
+	{
+		d_error = tr("cannot read trend file %1").arg( d_path );
+		return res;
+	}
+	QDataStream in( &f );
+	while( !in.atEnd() )
+	{
+		quint32 magic, recorded;
+		qint32 status;
+		Cycle c;
+		in >> magic >> status >> recorded >> c.d_size;
+		if( in.status() != QDataStream::Ok || magic != s_cycleMagic )
+		{
+			d_error = tr("trend file %1 is corrupt at position %2").arg( d_path ).arg( f.pos() );
+			break;
+		}
+		c.d_status = QDate::fromJulianDay( status );
+		c.d_recorded = QDateTime::fromTime_t( recorded );
+		c.d_pos = f.pos();
+		// seek gelingt auch hinter dem Dateiende; ein abgeschnittener Block darf nicht als
+		// Zyklus gelten, sonst schreibt append hinter das echte Ende
+		if( c.d_pos + c.d_size > f.size() || !f.seek( c.d_pos + c.d_size ) )
+		{
+			d_error = tr("trend file %1 is truncated at position %2").arg( d_path ).arg( c.d_pos );
+			break;
+		}
+		res.append( c );
+	}
+	return res;
+}
+
+bool StatusTrend::append(Udb::Transaction * txn, const QDate &s)
+{
+	Q_ASSERT( txn != 0 );
+	QDate status = s;
+	if( !status.isValid() )
+		status = WtTypeDefs::getProject( txn ).getValue( AttrDataDate ).getDate();
+	if( !status.isValid() )
+		status = QDate::currentDate();
+	QList<Cycle> cycles = getCycles();
+	if( !d_error.isEmpty() )
+		return false;
+	if( !cycles.isEmpty() && cycles.last().d_status >= status )
+	{
+		d_error = tr("status date %1 is not after the last recorded cycle %2").
+				arg( status.toString( Qt::ISODate ) ).arg( cycles.last().d_status.toString( Qt::ISODate ) );
+		return false;
+	}
+	const QByteArray block = SchedSnapshot::fetch( txn ).encode( true );
+
+	QFile f( d_path );
+	const bool isNew = !f.exists() || f.size() == 0;
+	if( !f.open( QIODevice::WriteOnly | QIODevice::Append ) )
+	{
+		d_error = tr("cannot write trend file %1").arg( d_path );
+		return false;
+	}
+	if( isNew )
+	{
+		f.write( s_fileMagic, 4 );
+		f.putChar( char( s_version ) );
+	}
+	QDataStream out( &f );
+	out << s_cycleMagic << qint32( status.toJulianDay() ) <<
+		   quint32( QDateTime::currentDateTime().toTime_t() ) << quint32( block.size() );
+	out.writeRawData( block.constData(), block.size() );
+	return out.status() == QDataStream::Ok;
+}
+
+bool StatusTrend::scan(StatusTrend::Visitor & v)
+{
+	QList<Cycle> cycles = getCycles();
+	if( !d_error.isEmpty() )
+		return false;
+	QFile f( d_path );
+	if( cycles.isEmpty() || !f.open( QIODevice::ReadOnly ) )
+		return cycles.isEmpty();
+	SchedSnapshot snap;
+	foreach( const Cycle& c, cycles )
+	{
+		f.seek( c.d_pos );
+		if( !snap.decode( f.read( c.d_size ) ) )
+		{
+			d_error = tr("invalid cycle %1 in trend file").arg( c.d_status.toString( Qt::ISODate ) );
+			return false;
+		}
+		if( !v.visit( c.d_status, snap ) )
+			break;
+	}
+	return true;
+}
+
+static inline bool _isOpen( const SchedSnapshot& s, int i, qint32 status )
+{
+	return s.d_ef[i] == 0 || s.d_ef[i] > status;
+}
+
+struct _MetricsVisitor : public StatusTrend::Visitor
+{
+	QList<StatusTrend::Point> d_res;
+	SchedSnapshot d_base;
+	SchedSnapshot d_prev;
+	QDate d_prevStatus;
+	qint32 d_baseFinish;
+	bool d_hasBase;
+
+	_MetricsVisitor( const SchedSnapshot* base ):d_baseFinish(0),d_hasBase(base != 0)
+	{
+		if( base )
+			setBase( *base );
+	}
+	void setBase( const SchedSnapshot& base )
+	{
+		d_base = base;
+		d_baseFinish = 0;
+		for( int i = 0; i < base.size(); i++ )
+			d_baseFinish = qMax( d_baseFinish, base.d_ef[i] );
+	}
+	bool visit( const QDate& status, const SchedSnapshot& cur )
+	{
+		if( !d_hasBase )
+		{
+			setBase( cur );
+			d_hasBase = true;
+		}
+		const qint32 s = status.toJulianDay();
+		StatusTrend::Point p;
+		p.d_status = status;
+		p.d_count = cur.size();
+		p.d_completed = 0;
+		p.d_negFloat = 0;
+		p.d_eroded = 0;
+		qint32 finish = 0;
+		qint64 floatSum = 0;
+		int floatCount = 0;
+		for( int i = 0; i < cur.size(); i++ )
+		{
+			finish = qMax( finish, cur.d_ef[i] );
+			if( !_isOpen( cur, i, s ) )
+				p.d_completed++;
+			else if( cur.d_lf[i] != 0 && cur.d_ef[i] != 0 )
+			{
+				const qint32 tf = cur.d_lf[i] - cur.d_ef[i];
+				floatSum += tf;
+				floatCount++;
+				if( tf < 0 )
+					p.d_negFloat++;
+			}
+		}
+		p.d_finish = ( finish ) ? QDate::fromJulianDay( finish ) : QDate();
+		p.d_finishSlip = ( finish && d_baseFinish ) ? finish - d_baseFinish : 0;
+		p.d_avgFloat = ( floatCount ) ? double( floatSum ) / double( floatCount ) : 0.0;
+
+		// BEI: abgeschlossene / gemäss Baseline bis zum Statusdatum fällige Aktivitäten
+		int due = 0;
+		for( int i = 0; i < d_base.size(); i++ )
+			if( d_base.d_ef[i] != 0 && d_base.d_ef[i] <= s )
+				due++;
+		p.d_bei = ( due ) ? double( p.d_completed ) / double( due ) : -1.0;
+
+		// CEI und Float-Erosion gegen den vorherigen Zyklus; Merge-Join über die sortierten OIDs
+		p.d_cei = -1.0;
+		if( d_prevStatus.isValid() )
+		{
+			const qint32 ps = d_prevStatus.toJulianDay();
+			int forecast = 0, done = 0;
+			int i = 0, j = 0;
+			while( i < d_prev.size() && j < cur.size() )
+			{
+				if( d_prev.d_oids[i] < cur.d_oids[j] )
+					i++;
+				else if( cur.d_oids[j] < d_prev.d_oids[i] )
+					j++;
+				else
+				{
+					if( d_prev.d_ef[i] > ps && d_prev.d_ef[i] <= s )
+					{
+						forecast++;
+						if( !_isOpen( cur, j, s ) )
+							done++;
+					}
+					if( d_prev.d_lf[i] && d_prev.d_ef[i] && cur.d_lf[j] && cur.d_ef[j] &&
+							( cur.d_lf[j] - cur.d_ef[j] ) < ( d_prev.d_lf[i] - d_prev.d_ef[i] ) )
+						p.d_eroded++;
+					i++;
+					j++;
+				}
+			}
+			if( forecast )
+				p.d_cei = double( done ) / double( forecast );
+		}
+		d_res.append( p );
+		d_prev = cur;
+		d_prevStatus = status;
+		return true;
+	}
+};
+
+QList<StatusTrend::Point> StatusTrend::computeMetrics(const SchedSnapshot *base)
+{
+	_MetricsVisitor v( base );
+	scan( v );
+	return v.d_res;
+}
+
+struct _FloatVisitor : public StatusTrend::Visitor
+{
+	Udb::OID d_oid;
+	QList<QPair<QDate,qint32> > d_res;
+	_FloatVisitor( Udb::OID oid ):d_oid(oid){}
+	bool visit( const QDate& status, const SchedSnapshot& s )
+	{
+		const int i = s.find( d_oid );
+		if( i != -1 && s.d_lf[i] != 0 && s.d_ef[i] != 0 )
+			d_res.append( qMakePair( status, s.d_lf[i] - s.d_ef[i] ) );
+		return true;
+	}
+};
+
+QList<QPair<QDate, qint32> > StatusTrend::getFloatHistory(Udb::OID oid)
+{
+	_FloatVisitor v( oid );
+	scan( v );
+	return v.d_res;
+}
@@ -0,0 +1,80 @@
+#ifndef STATUSTREND_H
+#define STATUSTREND_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QDateTime>
+#include "Baseline.h"
+
+namespace Wt
+{
+	// Append-only Zeitreihe der Statuszyklen in einer Datei neben dem Repository (*.trend).
+	// Jeder Zyklus ist ein mit SchedSnapshot::encode kodierter Block; beim Lesen wird immer
+	// nur ein Zyklus aufs Mal dekodiert.
+	class StatusTrend : public QObject // wegen tr
+	{
+		Q_OBJECT
+	public:
+		struct Cycle
+		{
+			QDate d_status;
+			QDateTime d_recorded;
+			qint64 d_pos; // Dateiposition des Blocks
+			quint32 d_size;
+		};
+		struct Point
+		{
+			QDate d_status;
+			int d_count;
+			int d_completed; // EF <= Statusdatum
+			double d_bei; // Baseline Execution Index, -1 falls nicht definiert
+			double d_cei; // Current Execution Index gegen den vorherigen Zyklus, -1 falls nicht definiert
+			QDate d_finish; // Maximum EF
+			qint32 d_finishSlip; // Tage gegen ersten Zyklus bzw. Baseline
+			double d_avgFloat; // Total Float (LF - EF) in Tagen, Mittel über offene Aktivitäten
+			int d_negFloat; // Anzahl offener Aktivitäten mit negativem Float
+			int d_eroded; // Anzahl Aktivitäten, deren Float seit vorherigem Zyklus gesunken ist
+		};
+		class Visitor
+		{
+		public:
+			virtual ~Visitor() {}
+			virtual bool visit( const QDate& status, const SchedSnapshot& ) = 0; // false: Abbruch
+		};
+
+		explicit StatusTrend( const QString& dbPath );
+		static QString getTrendPath( const QString& dbPath );
+		const QString& getPath() const { return d_path; }
+		const QString& getError() const { return d_error; }
+
+		bool append( Udb::Transaction*, const QDate& status = QDate() ); // Default: AttrDataDate
+		QList<Cycle> getCycles();
+		bool scan( Visitor& );
+		// Falls base == 0, dient der erste Zyklus als Baseline
+		QList<Point> computeMetrics( const SchedSnapshot* base = 0 );
+		QList<QPair<QDate,qint32> > getFloatHistory( Udb::OID );
+	private:
+		QString d_path;
+		QString d_error;
+	};
+}
+
+#endif // STATUSTREND_H
@@ -73,7 +73,7 @@ TextViewCtrl *TextViewCtrl::create(QWidget *parent, Udb::Transaction *txn)
 	ctrl->d_oln->getTree()->setIndentation( 20 );
 	vbox->addWidget( ctrl->d_oln->getTree() );
 
-    txn->getDb()->addObserver( ctrl, SLOT( onDbUpdate( Udb::UpdateInfo ) ) );
+    UpdateDispatcher::inst( txn )->subscribe( ctrl, SLOT( onDbUpdates( Wt::UpdateBatch ) ), ObjChange::Erased );
 
     connect( ctrl->d_title, SIGNAL(signalClicked()), ctrl, SLOT(onTitleClick()) );
     connect( ctrl->d_oln->getTree(), SIGNAL( identDoubleClicked() ), ctrl, SLOT( onFollowAlias() ) );
@@ -122,17 +122,16 @@ Gui2::AutoMenu *TextViewCtrl::createPopup()
     return pop;
 }
 
-void TextViewCtrl::onDbUpdate(Udb::UpdateInfo info)
+void TextViewCtrl::onDbUpdates(const Wt::UpdateBatch & batch)
 {
-    switch( info.d_kind )
-	{
-    case Udb::UpdateInfo::ObjectErased:
-        if( info.d_id == d_title->getObj().getOid() )
+    foreach( const ObjChange& c, batch )
+    {
+        if( c.d_id == d_title->getObj().getOid() )
         {
             d_pin->setChecked( false );
             setObj( Udb::Obj() );
+            break;
         }
-        break;
     }
 }
 
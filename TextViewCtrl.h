@@ -23,7 +23,7 @@
 #include <QObject>
 #include <Udb/Obj.h>
 #include <Gui2/AutoMenu.h>
-#include <Udb/UpdateInfo.h>
+#include "UpdateDispatcher.h"
 #include <QtGui/QLabel>
 
 namespace Oln
@@ -49,7 +49,7 @@ namespace Wt
 		void signalFollowObject( const Udb::Obj& );  // Alias oder Link wurden aktiviert
 		void signalItemActivated( const Udb::Obj& ); // Anderes Outline Item wurde angewhlt
 	protected slots:
-        void onDbUpdate( Udb::UpdateInfo info );
+        void onDbUpdates( const Wt::UpdateBatch& );
         void onFollowAlias();
         void onTitleClick();
         void onAnchorActivated(QByteArray data, bool url);
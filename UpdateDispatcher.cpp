@@ -0,0 +1,387 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include "UpdateDispatcher.h"
+#include <Udb/Transaction.h>
+#include <Udb/Database.h>
+using namespace Wt;
+
+UpdateDispatcher::UpdateDispatcher(Udb::Transaction * txn):QObject(txn)
+{
+	Q_ASSERT( txn != 0 );
+	txn->addObserver( this, SLOT(onDbUpdate( Udb::UpdateInfo ) ), false );
+	txn->getDb()->addObserver( this, SLOT(onDbCommitted( Udb::UpdateInfo ) ), false );
+}
+
+UpdateDispatcher::~UpdateDispatcher()
+{
+	foreach( Sub* s, d_subs )
+		delete s;
+}
+
+UpdateDispatcher *UpdateDispatcher::inst(Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	UpdateDispatcher* d = txn->findChild<UpdateDispatcher*>();
+	if( d == 0 )
+		d = new UpdateDispatcher( txn );
+	return d;
+}
+
+Udb::Transaction *UpdateDispatcher::getTxn() const
+{
+	return static_cast<Udb::Transaction*>( parent() );
+}
+
+UpdateDispatcher::Sub *UpdateDispatcher::getSub(QObject * obs) const
+{
+	Sub* s = d_subs.value( obs );
+	Q_ASSERT_X( s != 0, "UpdateDispatcher", "observer not subscribed" );
+	return s;
+}
+
+void UpdateDispatcher::subscribe(QObject * obs, const char *slot, quint8 kinds)
+{
+	Q_ASSERT( obs != 0 && slot != 0 );
+	Sub* s = d_subs.value( obs );
+	if( s == 0 )
+	{
+		s = new Sub();
+		s->d_obs = obs;
+		d_subs[obs] = s;
+		connect( obs, SIGNAL(destroyed(QObject*)), this, SLOT(onDestroyed(QObject*)) );
+	}
+	// slot kommt von SLOT() und beginnt deshalb mit dem Code '1'
+	const int i = obs->metaObject()->indexOfSlot( QMetaObject::normalizedSignature( slot + 1 ) );
+	Q_ASSERT_X( i != -1, "UpdateDispatcher::subscribe", slot );
+	s->d_slot = obs->metaObject()->method( i );
+	s->d_kinds = kinds;
+	d_byKind.removeAll( s );
+	if( kinds != 0 )
+		d_byKind.append( s );
+}
+
+void UpdateDispatcher::unsubscribe(QObject * obs)
+{
+	Sub* s = d_subs.take( obs );
+	if( s == 0 )
+		return;
+	if( !s->d_obs.isNull() )
+		disconnect( obs, SIGNAL(destroyed(QObject*)), this, SLOT(onDestroyed(QObject*)) );
+	clearObjects( s );
+	foreach( quint32 atom, s->d_atoms )
+		d_byAtom.remove( atom, s );
+	d_byKind.removeAll( s );
+	delete s;
+}
+
+void UpdateDispatcher::onDestroyed(QObject * obs)
+{
+	// obs ist hier bereits teilweise abgebaut; nur noch als Schlüssel verwendet
+	unsubscribe( obs );
+}
+
+void UpdateDispatcher::observeObject(QObject * obs, Udb::OID oid, bool on)
+{
+	Sub* s = getSub( obs );
+	if( s == 0 || oid == 0 )
+		return;
+	if( on && !s->d_oids.contains( oid ) )
+	{
+		s->d_oids.insert( oid );
+		d_byOid.insert( oid, s );
+	}else if( !on && s->d_oids.remove( oid ) )
+		d_byOid.remove( oid, s );
+}
+
+void UpdateDispatcher::observeChildren(QObject * obs, Udb::OID parent, bool on)
+{
+	Sub* s = getSub( obs );
+	if( s == 0 || parent == 0 )
+		return;
+	if( on && !s->d_parents.contains( parent ) )
+	{
+		s->d_parents.insert( parent );
+		d_byParent.insert( parent, s );
+	}else if( !on && s->d_parents.remove( parent ) )
+		d_byParent.remove( parent, s );
+}
+
+void UpdateDispatcher::observeAtom(QObject * obs, quint32 atom, bool on)
+{
+	Sub* s = getSub( obs );
+	if( s == 0 )
+		return;
+	if( on && !s->d_atoms.contains( atom ) )
+	{
+		s->d_atoms.insert( atom );
+		d_byAtom.insert( atom, s );
+	}else if( !on && s->d_atoms.remove( atom ) )
+		d_byAtom.remove( atom, s );
+}
+
+void UpdateDispatcher::clearObjects(QObject * obs)
+{
+	Sub* s = getSub( obs );
+	if( s != 0 )
+		clearObjects( s );
+}
+
+void UpdateDispatcher::clearObjects(UpdateDispatcher::Sub * s)
+{
+	foreach( Udb::OID oid, s->d_oids )
+		d_byOid.remove( oid, s );
+	s->d_oids.clear();
+	foreach( Udb::OID oid, s->d_parents )
+		d_byParent.remove( oid, s );
+	s->d_parents.clear();
+}
+
+void UpdateDispatcher::onDbUpdate(Udb::UpdateInfo info)
+{
+	// Wie beim Indexer: in PreCommit liegen alle Notifikationen des Commits vor. Sie werden
+	// nur vorgemerkt, bis die Database sie bestätigt. Der Commit läuft synchron; was danach
+	// noch vorgemerkt ist, gehört zu einem gescheiterten Commit und darf nicht gegen die
+	// Meldungen eines späteren fremden Commits abgeglichen werden.
+	switch( info.d_kind )
+	{
+	case Udb::UpdateInfo::PreCommit:
+		d_staged = getTxn()->getPendingNotifications();
+		QMetaObject::invokeMethod( this, "onCommitEnd", Qt::QueuedConnection );
+		break;
+	case Udb::UpdateInfo::Rollback:
+		d_staged.clear();
+		break;
+	default:
+		break;
+	}
+}
+
+void UpdateDispatcher::onCommitEnd()
+{
+	d_staged.clear();
+}
+
+static bool _isChange( const Udb::UpdateInfo& info )
+{
+	switch( info.d_kind )
+	{
+	case Udb::UpdateInfo::ObjectErased:
+	case Udb::UpdateInfo::Aggregated:
+	case Udb::UpdateInfo::Deaggregated:
+	case Udb::UpdateInfo::TypeChanged:
+	case Udb::UpdateInfo::ValueChanged:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void UpdateDispatcher::onDbCommitted(Udb::UpdateInfo info)
+{
+	if( !_isChange( info ) )
+		return;
+	if( !d_staged.isEmpty() )
+	{
+		// Die erste Meldung der Database nach PreCommit bestätigt den eigenen Commit; der
+		// Rest dieses Commits ist in d_staged bereits enthalten
+		bool own = false;
+		foreach( const Udb::UpdateInfo& s, d_staged )
+		{
+			if( s.d_id == info.d_id && s.d_kind == info.d_kind )
+			{
+				own = true;
+				break;
+			}
+		}
+		if( own )
+		{
+			const QList<Udb::UpdateInfo> staged = d_staged;
+			d_staged.clear();
+			d_own.clear();
+			foreach( const Udb::UpdateInfo& s, staged )
+				d_own.insert( qMakePair( s.d_id, int( s.d_kind ) ) );
+			// Der Commit meldet synchron; nach seinem Ende gehört nichts mehr zu ihm
+			QMetaObject::invokeMethod( this, "onForeign", Qt::QueuedConnection );
+			if( !d_subs.isEmpty() )
+				dispatch( staged );
+			return;
+		}
+	}
+	if( d_own.contains( qMakePair( info.d_id, int( info.d_kind ) ) ) )
+		return; // weitere Meldungen des eben ausgelieferten Commits
+	if( d_foreign.isEmpty() && d_own.isEmpty() )
+		QMetaObject::invokeMethod( this, "onForeign", Qt::QueuedConnection );
+	d_foreign.append( info );
+}
+
+void UpdateDispatcher::onForeign()
+{
+	d_own.clear();
+	const QList<Udb::UpdateInfo> infos = d_foreign;
+	d_foreign.clear();
+	if( infos.isEmpty() )
+		return;
+	if( !d_subs.isEmpty() )
+		dispatch( infos );
+}
+
+void UpdateDispatcher::coalesce(const QList<Udb::UpdateInfo> & infos, UpdateBatch & res)
+{
+	QHash<Udb::OID,int> pos;
+	foreach( const Udb::UpdateInfo& info, infos )
+	{
+		quint8 kind;
+		switch( info.d_kind )
+		{
+		case Udb::UpdateInfo::ObjectErased:
+			kind = ObjChange::Erased;
+			break;
+		case Udb::UpdateInfo::Aggregated:
+			kind = ObjChange::Aggregated;
+			break;
+		case Udb::UpdateInfo::Deaggregated:
+			kind = ObjChange::Deaggregated;
+			break;
+		case Udb::UpdateInfo::TypeChanged:
+			kind = ObjChange::TypeChanged;
+			break;
+		case Udb::UpdateInfo::ValueChanged:
+			kind = ObjChange::ValueChanged;
+			break;
+		default:
+			continue;
+		}
+		int i = pos.value( info.d_id, -1 );
+		if( i == -1 )
+		{
+			i = res.size();
+			pos.insert( info.d_id, i );
+			res.append( ObjChange() );
+			res.last().d_id = info.d_id;
+		}
+		ObjChange& c = res[i];
+		switch( kind )
+		{
+		case ObjChange::Erased:
+		case ObjChange::TypeChanged:
+			c.d_type = info.d_name;
+			break;
+		case ObjChange::Aggregated:
+			c.d_parent = info.d_parent;
+			c.d_before = info.d_before;
+			break;
+		case ObjChange::Deaggregated:
+			if( !c.is( ObjChange::Deaggregated ) )
+				c.d_oldParent = info.d_parent;
+			break;
+		case ObjChange::ValueChanged:
+			if( !c.d_atoms.contains( info.d_name ) )
+				c.d_atoms.append( info.d_name );
+			break;
+		}
+		c.d_kinds |= kind;
+	}
+	for( int i = 0; i < res.size(); i++ )
+	{
+		// Ein im selben Commit gelöschtes Objekt wird nirgends mehr eingefügt
+		if( res[i].is( ObjChange::Erased ) )
+		{
+			res[i].d_kinds &= ~ObjChange::Aggregated;
+			res[i].d_parent = 0;
+			res[i].d_before = 0;
+		}
+	}
+}
+
+inline void UpdateDispatcher::assign(UpdateDispatcher::Sub * s, const UpdateBatch & all, int i)
+{
+	if( s->d_last != i )
+	{
+		s->d_last = i;
+		s->d_batch.append( all[i] );
+	}
+}
+
+void UpdateDispatcher::dispatch(const QList<Udb::UpdateInfo> & infos)
+{
+	UpdateBatch all;
+	coalesce( infos, all );
+	if( all.isEmpty() )
+		return;
+	foreach( Sub* s, d_subs )
+	{
+		s->d_last = -1;
+		s->d_batch.clear();
+	}
+	for( int i = 0; i < all.size(); i++ )
+	{
+		const ObjChange& c = all[i];
+		foreach( Sub* s, d_byKind )
+		{
+			if( s->d_kinds & c.d_kinds )
+				assign( s, all, i );
+		}
+		QMultiHash<Udb::OID,Sub*>::const_iterator j;
+		for( j = d_byOid.constFind( c.d_id ); j != d_byOid.constEnd() && j.key() == c.d_id; ++j )
+			assign( j.value(), all, i );
+		if( !d_byParent.isEmpty() )
+		{
+			Udb::OID parents[3] = { c.d_parent, c.d_oldParent, 0 };
+			if( !c.is( ObjChange::Aggregated ) && !c.is( ObjChange::Erased ) )
+				// Reine Wertänderung; der Parent muss nachgeschlagen werden
+				parents[2] = getTxn()->getObject( c.d_id ).getParent().getOid();
+			for( int k = 0; k < 3; k++ )
+			{
+				if( parents[k] == 0 )
+					continue;
+				for( j = d_byParent.constFind( parents[k] ); j != d_byParent.constEnd() && j.key() == parents[k]; ++j )
+					assign( j.value(), all, i );
+			}
+		}
+		if( !d_byAtom.isEmpty() )
+		{
+			foreach( quint32 atom, c.d_atoms )
+			{
+				QMultiHash<quint32,Sub*>::const_iterator k;
+				for( k = d_byAtom.constFind( atom ); k != d_byAtom.constEnd() && k.key() == atom; ++k )
+					assign( k.value(), all, i );
+			}
+		}
+	}
+	// Zuerst alles einsammeln, da Subscriber während der Auslieferung (un)subscriben können
+	QList< QPair<QPointer<QObject>,QMetaMethod> > targets;
+	QList<UpdateBatch> batches;
+	foreach( Sub* s, d_subs )
+	{
+		if( !s->d_batch.isEmpty() )
+		{
+			targets.append( qMakePair( s->d_obs, s->d_slot ) );
+			batches.append( s->d_batch );
+			s->d_batch.clear();
+		}
+	}
+	for( int i = 0; i < targets.size(); i++ )
+	{
+		if( !targets[i].first.isNull() )
+			targets[i].second.invoke( targets[i].first, Qt::DirectConnection,
+									  Q_ARG( Wt::UpdateBatch, batches[i] ) );
+	}
+}
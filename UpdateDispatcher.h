@@ -0,0 +1,116 @@
+#ifndef UPDATEDISPATCHER_H
+#define UPDATEDISPATCHER_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+
+#include <QObject>
+#include <QPointer>
+#include <QMetaMethod>
+#include <QHash>
+#include <QSet>
+#include <Udb/UpdateInfo.h>
+
+namespace Udb
+{
+	class Transaction;
+}
+
+namespace Wt
+{
+	// Alle Notifikationen eines Objekts innerhalb eines Commits zusammengefasst
+	struct ObjChange
+	{
+		enum Kind { Erased = 0x01, Aggregated = 0x02, Deaggregated = 0x04, TypeChanged = 0x08,
+					ValueChanged = 0x10, AllKinds = 0x1f };
+		Udb::OID d_id;
+		Udb::OID d_parent; // letzter neuer Parent falls Aggregated
+		Udb::OID d_before; // zu d_parent
+		Udb::OID d_oldParent; // erster alter Parent falls Deaggregated
+		quint32 d_type; // neuer Typ falls TypeChanged, letzter Typ falls Erased
+		quint8 d_kinds;
+		QList<quint32> d_atoms; // geänderte Attribute ohne Duplikate, falls ValueChanged
+		ObjChange():d_id(0),d_parent(0),d_before(0),d_oldParent(0),d_type(0),d_kinds(0){}
+		bool is( Kind k ) const { return d_kinds & k; }
+		bool hasAtom( quint32 a ) const { return d_atoms.contains( a ); }
+	};
+	typedef QList<ObjChange> UpdateBatch; // in der Reihenfolge des ersten Auftretens
+
+	// Zentraler Observer einer Transaktion: merkt sich in PreCommit die ausstehenden Notifikationen,
+	// fasst sie pro Objekt zusammen und liefert jedem Subscriber genau einen Batch pro Commit,
+	// der nur die ihn betreffenden Änderungen enthält. Der Slot hat die Signatur
+	// name(const Wt::UpdateBatch&). Ausgeliefert wird erst, wenn die Database die Änderungen
+	// meldet, also nach erfolgreichem Schreiben, aber noch synchron innerhalb von commit();
+	// Änderungen an der Transaktion sind dort nicht erlaubt. Scheitert der Commit, sieht
+	// kein Subscriber etwas. Commits anderer Transaktionen auf derselben Database (z.B.
+	// WorkerPool) werden gesammelt und queued als eigener Batch ausgeliefert.
+	// Eine Änderung betrifft einen Subscriber, wenn das Objekt, dessen Parent (alt oder neu),
+	// eines der geänderten Attribute oder eine der Änderungsarten abonniert ist.
+	class UpdateDispatcher : public QObject
+	{
+		Q_OBJECT
+	public:
+		static UpdateDispatcher* inst( Udb::Transaction* ); // eine Instanz pro Transaktion
+
+		void subscribe( QObject*, const char* slot, quint8 kinds = 0 ); // kinds: ObjChange::Kind
+		void unsubscribe( QObject* ); // geschieht auch automatisch bei destroyed()
+		void observeObject( QObject*, Udb::OID, bool on = true );
+		void observeChildren( QObject*, Udb::OID parent, bool on = true );
+		void observeAtom( QObject*, quint32 atom, bool on = true );
+		void clearObjects( QObject* ); // entfernt alle observeObject und observeChildren
+		Udb::Transaction* getTxn() const;
+	protected slots:
+		void onDbUpdate( Udb::UpdateInfo ); // Transaktion, PreCommit und Rollback
+		void onCommitEnd();
+		void onDbCommitted( Udb::UpdateInfo ); // Database, nach dem Schreiben
+		void onForeign();
+		void onDestroyed( QObject* );
+	private:
+		struct Sub
+		{
+			QPointer<QObject> d_obs;
+			QMetaMethod d_slot;
+			QSet<Udb::OID> d_oids;
+			QSet<Udb::OID> d_parents;
+			QSet<quint32> d_atoms;
+			quint8 d_kinds;
+			int d_last; // Index der letzten zugeteilten Änderung im laufenden Dispatch
+			UpdateBatch d_batch;
+			Sub():d_kinds(0),d_last(-1){}
+		};
+		explicit UpdateDispatcher( Udb::Transaction* );
+		~UpdateDispatcher();
+		void dispatch( const QList<Udb::UpdateInfo>& );
+		static void coalesce( const QList<Udb::UpdateInfo>&, UpdateBatch& );
+		void assign( Sub*, const UpdateBatch&, int i );
+		void clearObjects( Sub* );
+		Sub* getSub( QObject* ) const;
+		QHash<QObject*,Sub*> d_subs;
+		QMultiHash<Udb::OID,Sub*> d_byOid;
+		QMultiHash<Udb::OID,Sub*> d_byParent;
+		QMultiHash<quint32,Sub*> d_byAtom;
+		QList<Sub*> d_byKind;
+		QList<Udb::UpdateInfo> d_staged; // vom laufenden Commit der eigenen Transaktion
+		QList<Udb::UpdateInfo> d_foreign; // von anderen Transaktionen, bis onForeign
+		QSet< QPair<Udb::OID,int> > d_own; // Meldungen des ausgelieferten Commits, bis onForeign
+	};
+}
+
+#endif // UPDATEDISPATCHER_H
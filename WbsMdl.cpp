@@ -24,6 +24,7 @@ using namespace Wt;
 WbsMdl::WbsMdl(QObject *parent) :
     GenericMdl(parent)
 {
+    setLazy( true );
 }
 
 bool WbsMdl::isSupportedType(quint32 type)
@@ -0,0 +1,141 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "WorkCalendar.h"
+#include "WtTypeDefs.h"
+#include <Udb/Transaction.h>
+using namespace Wt;
+
+WorkCalendar::WorkCalendar()
+{
+	for( int i = 0; i < 7; i++ )
+		d_nonWorking[i] = ( i >= 5 );
+}
+
+WorkCalendar WorkCalendar::load(const Udb::Obj &cal)
+{
+	WorkCalendar res;
+	if( !cal.isNull() && cal.getType() == TypeCalendar )
+		res.loadImp( cal, 0 );
+	return res;
+}
+
+void WorkCalendar::loadImp(const Udb::Obj &cal, int depth)
+{
+	if( depth > 8 )
+		return; // Schutz gegen zyklische Parent-Kalender
+	// Zuerst Parent, damit die eigenen Angaben übersteuern
+	const Udb::Obj parent = cal.getValueAsObj( AttrParentCalendar );
+	if( !parent.isNull() && parent.getType() == TypeCalendar )
+		loadImp( parent, depth + 1 );
+	const QByteArray nwd = cal.getValue( AttrNonWorkingDays ).getArr();
+	for( int i = 0; i < 7 && i < nwd.size(); i++ )
+	{
+		if( nwd[i] == '0' )
+			d_nonWorking[i] = false;
+		else if( nwd[i] == '1' )
+			d_nonWorking[i] = true;
+		// ' ' undefined: Parent bzw. Default gilt
+	}
+	Udb::Obj e = cal.getFirstObj();
+	if( !e.isNull() ) do
+	{
+		if( e.getType() == TypeCalEntry )
+		{
+			const QDate start = e.getValue( AttrCalDate ).getDate();
+			const Stream::DataCell nw = e.getValue( AttrNonWorking );
+			if( start.isValid() && !nw.isNull() )
+			{
+				int dur = e.getValue( AttrCalDuration ).getUInt16();
+				if( dur == 0 )
+					dur = 1;
+				const qint32 jd = start.toJulianDay();
+				for( int i = 0; i < dur; i++ )
+				{
+					if( nw.getBool() )
+					{
+						d_nonWorkingDates.insert( jd + i );
+						d_workingDates.remove( jd + i );
+					}else
+					{
+						d_workingDates.insert( jd + i );
+						d_nonWorkingDates.remove( jd + i );
+					}
+				}
+			}
+		}
+	}while( e.next() );
+}
+
+WorkCalendar WorkCalendar::loadDefault(Udb::Transaction * txn)
+{
+	return load( WtTypeDefs::getCalendars( txn ).getValueAsObj( AttrDefaultCal ) );
+}
+
+WorkCalendar WorkCalendar::elapsed()
+{
+	WorkCalendar res;
+	for( int i = 0; i < 7; i++ )
+		res.d_nonWorking[i] = false;
+	return res;
+}
+
+bool WorkCalendar::isWorkday(const QDate & d) const
+{
+	const qint32 jd = d.toJulianDay();
+	if( !d_workingDates.isEmpty() && d_workingDates.contains( jd ) )
+		return true;
+	if( !d_nonWorkingDates.isEmpty() && d_nonWorkingDates.contains( jd ) )
+		return false;
+	return !d_nonWorking[ d.dayOfWeek() - 1 ];
+}
+
+QDate WorkCalendar::nextWorkday(const QDate & d) const
+{
+	QDate res = d;
+	for( int i = 0; i < 3660 && !isWorkday( res ); i++ )
+		res = res.addDays( 1 );
+	return res;
+}
+
+QDate WorkCalendar::addWorkdays(const QDate &start, int days) const
+{
+	QDate res = start;
+	const int step = ( days < 0 ) ? -1 : 1;
+	int n = qAbs( days );
+	int guard = 0;
+	while( n > 0 && guard++ < 36600 )
+	{
+		res = res.addDays( step );
+		if( isWorkday( res ) )
+			n--;
+	}
+	return res;
+}
+
+int WorkCalendar::workdaysBetween(const QDate &from, const QDate &to) const
+{
+	if( to < from )
+		return -workdaysBetween( to, from );
+	int res = 0;
+	for( QDate d = from; d < to; d = d.addDays( 1 ) )
+		if( isWorkday( d ) )
+			res++;
+	return res;
+}
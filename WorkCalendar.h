@@ -0,0 +1,51 @@
+#ifndef WORKCALENDAR_H
+#define WORKCALENDAR_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <Udb/Obj.h>
+#include <QDate>
+#include <QSet>
+
+namespace Wt
+{
+	// In-Memory-Abbild eines TypeCalendar inkl. Parent-Kalender; nach dem Laden unabhängig
+	// von der Datenbank und deshalb auch auf Worker-Threads verwendbar.
+	class WorkCalendar
+	{
+	public:
+		WorkCalendar(); // Standard Five-day Week ohne Ausnahmen
+		static WorkCalendar load( const Udb::Obj& cal );
+		static WorkCalendar loadDefault( Udb::Transaction* );
+		static WorkCalendar elapsed(); // 7x24
+
+		bool isWorkday( const QDate& ) const;
+		QDate nextWorkday( const QDate& ) const; // inklusive des übergebenen Datums
+		QDate addWorkdays( const QDate& start, int days ) const; // days kann negativ sein
+		int workdaysBetween( const QDate& from, const QDate& to ) const; // Workdays in [from,to), negativ falls to < from
+	private:
+		void loadImp( const Udb::Obj& cal, int depth );
+		bool d_nonWorking[7]; // [0]..Montag bis [6] Sonntag
+		QSet<qint32> d_nonWorkingDates; // Julian Days
+		QSet<qint32> d_workingDates; // Julian Days, übersteuern d_nonWorking
+	};
+}
+
+#endif // WORKCALENDAR_H
@@ -95,7 +95,25 @@ SOURCES += main.cpp\
     CalendarEditor.cpp \
     Funcs.cpp \
     RefByViewCtrl.cpp \
-    WtLuaBinding.cpp
+    WtLuaBinding.cpp \
+    Baseline.cpp \
+    StatusTrend.cpp \
+    WorkCalendar.cpp \
+    Scenario.cpp \
+    NetCondenser.cpp \
+    MspdiImporter.cpp \
+    ScheduleExporter.cpp \
+    BatchRunner.cpp \
+    UpdateDispatcher.cpp \
+    StartupProfile.cpp \
+    CachePolicy.cpp \
+    WorkerPool.cpp \
+    GarbageCollector.cpp \
+    ScriptRunner.cpp \
+    LuaProfiler.cpp \
+    QueryEngine.cpp \
+    QuickOpenIndex.cpp \
+    QuickOpenDlg.cpp
 
 
 HEADERS  += MainWindow.h \
@@ -135,7 +153,25 @@ HEADERS  += MainWindow.h \
     CalendarEditor.h \
     Funcs.h \
     RefByViewCtrl.h \
-    WtLuaBinding.h
+    WtLuaBinding.h \
+    Baseline.h \
+    StatusTrend.h \
+    WorkCalendar.h \
+    Scenario.h \
+    NetCondenser.h \
+    MspdiImporter.h \
+    ScheduleExporter.h \
+    BatchRunner.h \
+    UpdateDispatcher.h \
+    StartupProfile.h \
+    CachePolicy.h \
+    WorkerPool.h \
+    GarbageCollector.h \
+    ScriptRunner.h \
+    LuaProfiler.h \
+    QueryEngine.h \
+    QuickOpenIndex.h \
+    QuickOpenDlg.h
 
 UseIcs {
 	SOURCES += ../Herald/IcsDocument.cpp
@@ -29,6 +29,10 @@
 #include <Oln2/OutlineItem.h>
 #include "MainWindow.h"
 #include "WtTypeDefs.h"
+#include "StartupProfile.h"
+#include "CachePolicy.h"
+#include "WorkerPool.h"
+#include "GarbageCollector.h"
 #include <Script2/QtObject.h>
 #include <Script/Engine2.h>
 #include <Oln2/LuaBinding.h>
@@ -49,6 +53,7 @@ const char* WorkTreeApp::s_wbs = "{FA5EC2A6-F3B8-42d7-A02C-710DF6F14F1B}";
 const char* WorkTreeApp::s_folders = "{8EB5894A-CC36-458f-9137-A6681F423CAB}";
 const QUuid WorkTreeApp::s_calendars( "{26D78124-1623-4fbb-901C-A93BFB0C6619}" );
 const QUuid WorkTreeApp::s_project( "{4CBED7F2-0DEC-4a14-8765-8545F4C625A3}" );
+const QUuid WorkTreeApp::s_baselines( "{7A3E0C51-94B2-4d6f-8C1A-2F5D6B9E0A47}" );
 
 static WorkTreeApp* s_inst = 0;
 
@@ -87,6 +92,11 @@ WorkTreeApp::WorkTreeApp()
 //		QFont f = d_set->value( "Outliner/Font" ).value<QFont>();
 //		d_styles->setFontStyle( f.family(), f.pointSize() );
 //	}
+	// initLua() erst durch MainWindow nach dem ersten Paint bzw. beim ersten Gebrauch
+}
+
+void WorkTreeApp::initLua()
+{
 	Lua::Engine2::setInst( new Lua::Engine2() );
 	Lua::Engine2::getInst()->addStdLibs();
 	Lua::Engine2::getInst()->addLibrary( Lua::Engine2::PACKAGE );
@@ -138,15 +148,19 @@ bool WorkTreeApp::open(const QString & path)
             return true;
         }
     }
+    StartupProfile* prof = StartupProfile::inst();
+	prof->start( path );
     Udb::Transaction* txn = 0;
 	try
 	{
         Udb::Database* db = new Udb::Database( this );
 		db->open( path );
-		db->setCacheSize( 10000 ); // RISK
+		CachePolicy::inst( db ); // Grsse abhngig von Repository und Budget
         txn = new Udb::Transaction( db, this );
+		prof->mark( "open database" );
 		WtTypeDefs::init( *db );
 		txn->commit();
+		prof->mark( "type definitions" );
 	}catch( Udb::DatabaseException& e )
 	{
 		QMessageBox::critical( 0, tr("Create/Open Repository"),
@@ -156,7 +170,9 @@ bool WorkTreeApp::open(const QString & path)
 		return d_docs.isEmpty();
 	}
     Q_ASSERT( txn != 0 );
-	Wt::LuaBinding::setRepository( Lua::Engine2::getInst()->getCtx(), txn );
+	WorkerPool::inst( txn ); // Worker-Threads fr lesende Analysen, endet mit der Transaktion
+	if( d_set->value( "GC/Enabled", false ).toBool() ) // sonst nur auf Anforderung
+		GarbageCollector::inst( txn )->start( true );
 	MainWindow* w = new MainWindow( txn );
     connect( w, SIGNAL(closing()), this, SLOT(onClose()) );
     if( d_docs.isEmpty() )
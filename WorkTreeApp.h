@@ -46,12 +46,14 @@ namespace Wt
         static const char* s_folders;
         static const QUuid s_calendars;
         static const QUuid s_project;
+        static const QUuid s_baselines;
 
         explicit WorkTreeApp();
         ~WorkTreeApp();
 
         bool open(const QString&);
         static WorkTreeApp* inst();
+        static void initLua(); // auch im Batch-Modus ohne WorkTreeApp
         QSettings* getSet() const { return d_set; }
         const QList<MainWindow*>& getDocs() const { return d_docs; }
         void setAppFont( const QFont& f );
@@ -0,0 +1,224 @@
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include "WorkerPool.h"
+#include <Udb/Database.h>
+#include <Udb/Transaction.h>
+#include <Udb/DatabaseException.h>
+#include <QRunnable>
+#include <QThread>
+#include <exception>
+using namespace Wt;
+
+struct WorkerPool::Connection
+{
+	Udb::Database* d_db;
+	Udb::Transaction* d_txn;
+	quint32 d_generation;
+	Connection():d_db(0),d_txn(0),d_generation(0){}
+	~Connection()
+	{
+		if( d_txn )
+			delete d_txn;
+		if( d_db )
+			delete d_db;
+	}
+};
+
+namespace Wt
+{
+	class _WorkerRunner : public QRunnable
+	{
+	public:
+		WorkerPool* d_pool;
+		WorkerTask* d_task;
+		_WorkerRunner( WorkerPool* p, WorkerTask* t ):d_pool(p),d_task(t){}
+		void run()
+		{
+			if( !d_task->isCanceled() )
+			{
+				// Vor dem Öffnen der Verbindung, damit ein gleichzeitig laufender Commit in
+				// onComputed als stale erkannt wird
+				d_task->d_generation = quint32( int( d_pool->d_generation ) );
+				WorkerPool::Connection* s = 0;
+				try
+				{
+					s = d_pool->getConnection( d_task->d_generation );
+					d_task->compute( s->d_txn );
+					s->d_txn->rollback(); // die Verbindung bleibt unverändert
+				}catch( Udb::DatabaseException& e )
+				{
+					d_task->d_error = QString( "Error <%1>: %2" ).arg( e.getCodeString() ).arg( e.getMsg() );
+					rollback( s );
+				}catch( std::exception& e )
+				{
+					d_task->d_error = QString( "Error: %1" ).arg( e.what() );
+					rollback( s );
+				}catch( ... )
+				{
+					d_task->d_error = QString( "Unknown error in worker" );
+					rollback( s );
+				}
+			}
+			// Der Task lebt auf dem GUI-Thread, also läuft onComputed dort
+			QMetaObject::invokeMethod( d_task, "onComputed", Qt::QueuedConnection );
+		}
+		static void rollback( WorkerPool::Connection* s )
+		{
+			if( s == 0 )
+				return;
+			try
+			{
+				s->d_txn->rollback();
+			}catch( ... )
+			{
+				// Die Verbindung wird beim nächsten Commit ohnehin ersetzt
+			}
+		}
+	};
+}
+
+WorkerTask::WorkerTask():d_canceled(0),d_generation(0),d_runs(1),d_stale(false)
+{
+}
+
+void WorkerTask::onComputed()
+{
+	WorkerPool* pool = static_cast<WorkerPool*>( parent() );
+	bool ok = d_error.isEmpty() && !isCanceled();
+	d_stale = d_generation != quint32( int( pool->d_generation ) );
+	if( ok && d_stale && d_runs < WorkerPool::s_maxRuns && restart() )
+	{
+		d_runs++;
+		pool->d_threads.start( new _WorkerRunner( pool, this ) );
+		return;
+	}
+	if( ok )
+	{
+		Udb::Transaction* txn = pool->getWriter();
+		try
+		{
+			if( apply( txn ) )
+			{
+				txn->commit();
+				// Die Meldung des Dispatchers kommt queued; laufende Tasks sollen den Commit
+				// sofort sehen
+				pool->d_generation.ref();
+			}else
+				txn->rollback(); // falls apply doch etwas angefasst hat
+		}catch( Udb::DatabaseException& e )
+		{
+			txn->rollback();
+			d_error = QString( "Error <%1>: %2" ).arg( e.getCodeString() ).arg( e.getMsg() );
+			ok = false;
+		}catch( std::exception& e )
+		{
+			txn->rollback();
+			d_error = QString( "Error: %1" ).arg( e.what() );
+			ok = false;
+		}
+	}
+	emit finished( ok );
+	deleteLater();
+}
+
+WorkerPool::WorkerPool(Udb::Transaction * txn):QObject( txn ),d_writer(0)
+{
+	d_path = txn->getDb()->getFilePath();
+	d_threads.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() - 1 ) ); // einer bleibt der GUI
+	UpdateDispatcher* disp = UpdateDispatcher::inst( txn );
+	disp->subscribe( this, SLOT( onDbUpdates( Wt::UpdateBatch ) ), ObjChange::AllKinds );
+}
+
+WorkerPool *WorkerPool::inst(Udb::Transaction * txn)
+{
+	Q_ASSERT( txn != 0 );
+	WorkerPool* p = txn->findChild<WorkerPool*>();
+	if( p == 0 )
+		p = new WorkerPool( txn );
+	return p;
+}
+
+WorkerPool::~WorkerPool()
+{
+	cancelAll();
+	d_threads.waitForDone();
+	if( d_writer )
+		delete d_writer;
+}
+
+Udb::Transaction *WorkerPool::getTxn() const
+{
+	return static_cast<Udb::Transaction*>( parent() );
+}
+
+Udb::Transaction *WorkerPool::getWriter()
+{
+	if( d_writer == 0 )
+		d_writer = new Udb::Transaction( getTxn()->getDb() );
+	return d_writer;
+}
+
+void WorkerPool::start(WorkerTask * t)
+{
+	Q_ASSERT( t != 0 );
+	t->setParent( this );
+	d_threads.start( new _WorkerRunner( this, t ) );
+}
+
+void WorkerPool::cancelAll()
+{
+	foreach( WorkerTask* t, findChildren<WorkerTask*>() )
+		t->cancel();
+}
+
+int WorkerPool::getActiveCount() const
+{
+	return findChildren<WorkerTask*>().size();
+}
+
+void WorkerPool::onDbUpdates(const UpdateBatch &)
+{
+	// Nach jedem Commit auf der Database, auch dem von getWriter(); neue Tasks übernehmen
+	// den Stand in start()
+	d_generation.ref();
+}
+
+WorkerPool::Connection *WorkerPool::getConnection(quint32 generation)
+{
+	if( d_conns.hasLocalData() && d_conns.localData()->d_generation < generation )
+		d_conns.setLocalData( 0 ); // löscht die veraltete Verbindung
+	if( !d_conns.hasLocalData() || d_conns.localData() == 0 )
+	{
+		Connection* s = new Connection();
+		s->d_generation = generation;
+		try
+		{
+			s->d_db = new Udb::Database();
+			s->d_db->open( d_path );
+			s->d_txn = new Udb::Transaction( s->d_db );
+		}catch( ... )
+		{
+			delete s;
+			throw;
+		}
+		d_conns.setLocalData( s );
+	}
+	return d_conns.localData();
+}
@@ -0,0 +1,116 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+/*
+* Copyright 2012-2018 Rochus Keller <mailto:me@rochus-keller.info>
+*
+* This file is part of the WorkTree application.
+*
+* The following is the license that applies to this copy of the
+* application. For a license to use the application under conditions
+* other than those described here, please email to me@rochus-keller.info.
+*
+* GNU General Public License Usage
+* This file may be used under the terms of the GNU General Public
+* License (GPL) versions 2.0 or 3.0 as published by the Free Software
+* Foundation and appearing in the file LICENSE.GPL included in
+* the packaging of this file. Please review the following information
+* to ensure GNU General Public Licensing requirements will be met:
+* http://www.fsf.org/licensing/licenses/info/GPLv2.html and
+* http://www.gnu.org/copyleft/gpl.html.
+*/
+
+#include <QObject>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QAtomicInt>
+#include "UpdateDispatcher.h"
+
+namespace Udb
+{
+	class Transaction;
+	class Database;
+}
+
+namespace Wt
+{
+	// Eine Berechnung, die auf einem Worker-Thread über eine eigene, nur lesende Verbindung zur
+	// Repository-Datei läuft (compute) und ihr Ergebnis danach kurz auf dem GUI-Thread über die
+	// Schreib-Transaktion des Pools schreibt (apply). Die Haupttransaktion mit den noch nicht
+	// committeten Änderungen des Users wird dabei nie angefasst. Die Instanz lebt auf dem
+	// GUI-Thread; compute darf nur Member anfassen, die apply erst nach finished() liest.
+	class WorkerTask : public QObject
+	{
+		Q_OBJECT
+	public:
+		WorkerTask();
+		void cancel() { d_canceled = 1; }
+		bool isCanceled() const { return d_canceled != 0; }
+		const QString& getError() const { return d_error; }
+	signals:
+		void finished( bool ok );
+	protected:
+		// Worker-Thread; Änderungen an conn sind nicht erlaubt und werden verworfen
+		virtual void compute( Udb::Transaction* conn ) = 0;
+		// GUI-Thread; die Transaktion gehört dem Pool und liest den committeten Stand. Gibt true
+		// zurück, wenn etwas geschrieben wurde; nur dann wird committed, bei Exception rollback.
+		// Jede Implementierung muss ihre Funde gegen diesen Stand prüfen, siehe WorkerPool.
+		virtual bool apply( Udb::Transaction* ) { return false; }
+		// GUI-Thread; wird aufgerufen, wenn während compute committed wurde. Gibt true zurück,
+		// wenn die Ergebnisse verworfen wurden und compute wiederholt werden soll.
+		virtual bool restart() { return false; }
+		// true, wenn während des letzten compute committed wurde; in apply gültig
+		bool isStale() const { return d_stale; }
+		void setError( const QString& e ) { d_error = e; }
+	protected slots:
+		void onComputed();
+	private:
+		friend class WorkerPool;
+		friend class _WorkerRunner;
+		QString d_error;
+		QAtomicInt d_canceled;
+		quint32 d_generation; // Commit-Zähler des Pools beim Beginn von compute
+		int d_runs;
+		bool d_stale;
+	};
+
+	// Pool von Worker-Threads mit je einer eigenen Verbindung zur Repository-Datei. Die
+	// Verbindung eines Threads wird wiederverwendet, solange seit ihrer Erzeugung nichts
+	// committed wurde; andernfalls wird sie neu geöffnet, damit der Udb-Cache keine veralteten
+	// Objekte liefert. Unbenutzte Threads samt Verbindung enden nach 30s.
+	// Udb kennt weder Lesesperren noch Snapshot-Transaktionen; Commits während einer laufenden
+	// Berechnung können deshalb teilweise sichtbar werden. Der Pool validiert stattdessen
+	// optimistisch: endet während compute ein Commit, gilt das Ergebnis als stale. Tasks, die
+	// restart() unterstützen, rechnen dann erneut (höchstens s_maxRuns mal); alle anderen und
+	// der letzte Versuch kommen mit isStale() in apply und müssen ihre Funde dort prüfen.
+	class WorkerPool : public QObject
+	{
+		Q_OBJECT
+	public:
+		static WorkerPool* inst( Udb::Transaction* ); // eine Instanz pro Haupttransaktion
+		static const int s_maxRuns = 3;
+		~WorkerPool();
+
+		void start( WorkerTask* ); // übernimmt Ownership; der Task löscht sich nach finished()
+		void cancelAll();
+		int getActiveCount() const;
+		Udb::Transaction* getTxn() const; // die Haupttransaktion
+		Udb::Transaction* getWriter(); // eigene Transaktion für apply
+	protected slots:
+		void onDbUpdates( const Wt::UpdateBatch& );
+	protected:
+		WorkerPool( Udb::Transaction* );
+	private:
+		friend class _WorkerRunner;
+		friend class WorkerTask;
+		struct Connection;
+		Connection* getConnection( quint32 generation ); // Worker-Thread
+		QString d_path;
+		Udb::Transaction* d_writer;
+		QAtomicInt d_generation;
+		QThreadStorage<Connection*> d_conns; // vor d_threads, damit die Threads zuerst enden
+		QThreadPool d_threads;
+	};
+}
+
+#endif // WORKERPOOL_H
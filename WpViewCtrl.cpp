@@ -79,7 +79,7 @@ public:
 };
 
 WpViewCtrl::WpViewCtrl(QWidget *parent) :
-    QObject(parent)
+    QObject(parent),d_deferred(false)
 {
 }
 
@@ -106,7 +106,7 @@ WpViewCtrl *WpViewCtrl::create(QWidget *parent, Udb::Transaction *txn)
     connect( ctrl->d_list, SIGNAL(itemPressed(QListWidgetItem*)), ctrl,SLOT(onClicked(QListWidgetItem*)) );
     connect( ctrl->d_title, SIGNAL(signalClicked()), ctrl, SLOT(onTitleClick()) );
 
-    txn->getDb()->addObserver( ctrl, SLOT( onDbUpdate( Udb::UpdateInfo ) ) );
+    UpdateDispatcher::inst( txn )->subscribe( ctrl, SLOT( onDbUpdates( Wt::UpdateBatch ) ), ObjChange::Erased );
 
     return ctrl;
 }
@@ -123,6 +123,11 @@ void WpViewCtrl::setObj(const Udb::Obj & o)
 {
     if( !WtTypeDefs::isWbsType( o.getType() ) )
         return;
+    if( d_deferred )
+    {
+        d_pending = o;
+        return;
+    }
 
     d_title->setObj( o );
     d_list->clear();
@@ -140,6 +145,15 @@ void WpViewCtrl::setObj(const Udb::Obj & o)
     d_list->sortItems();
 }
 
+void WpViewCtrl::populate()
+{
+    if( !d_deferred )
+        return;
+    d_deferred = false;
+    setObj( d_pending );
+    d_pending = Udb::Obj();
+}
+
 QWidget *WpViewCtrl::getWidget() const
 {
     return static_cast<QWidget*>( parent() );
@@ -155,23 +169,23 @@ void WpViewCtrl::clear()
     d_list->clear();
 }
 
-void WpViewCtrl::onDbUpdate(Udb::UpdateInfo info)
+void WpViewCtrl::onDbUpdates(const Wt::UpdateBatch & batch)
 {
-    switch( info.d_kind )
-	{
-    case Udb::UpdateInfo::ObjectErased:
-        if( info.d_id == d_title->getObj().getOid() )
+    foreach( const ObjChange& c, batch )
+    {
+        if( c.d_id == d_title->getObj().getOid() )
+        {
             clear();
-        else if( WtTypeDefs::isImpType( info.d_name ) )
+            return;
+        }else if( WtTypeDefs::isImpType( c.d_type ) )
         {
             for( int i = 0; i < d_list->count(); i++ )
-                if( d_list->item(i)->data(Qt::UserRole).toULongLong() == info.d_id )
+                if( d_list->item(i)->data(Qt::UserRole).toULongLong() == c.d_id )
                 {
                     delete d_list->item(i);
-                    return;
+                    break;
                 }
         }
-        break;
     }
 }
 
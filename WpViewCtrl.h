@@ -22,7 +22,7 @@
 
 #include <QObject>
 #include <Udb/Obj.h>
-#include <Udb/UpdateInfo.h>
+#include "UpdateDispatcher.h"
 #include <Gui2/AutoMenu.h>
 
 class QListWidget;
@@ -40,14 +40,18 @@ namespace Wt
 
         static WpViewCtrl* create(QWidget* parent,Udb::Transaction *txn );
         void setObj( const Udb::Obj& );
+        // deferred: setObj merkt sich das Objekt nur, populate() zeigt es an
+        void setDeferred( bool on ) { d_deferred = on; }
         QWidget* getWidget() const;
         void addCommands( Gui2::AutoMenu* );
         void focusOn( const Udb::Obj& );
         void clear();
     signals:
         void signalSelect( const Udb::Obj& );
+    public slots:
+        void populate();
     protected slots:
-        void onDbUpdate(Udb::UpdateInfo info);
+        void onDbUpdates( const Wt::UpdateBatch& );
         void onTitleClick();
         void onCopy();
         void onPaste();
@@ -56,6 +60,8 @@ namespace Wt
     private:
         ObjectTitleFrame* d_title;
         QListWidget* d_list;
+        Udb::Obj d_pending;
+        bool d_deferred;
     };
 }
 
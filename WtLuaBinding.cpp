@@ -21,6 +21,11 @@
 #include "WorkTreeApp.h"
 #include "ObjectHelper.h"
 #include "WtTypeDefs.h"
+#include "Baseline.h"
+#include "StatusTrend.h"
+#include "ScheduleExporter.h"
+#include "WorkCalendar.h"
+#include "Scenario.h"
 #include <Udb/LuaBinding.h>
 #include <Udb/ContentObject.h>
 #include <Oln2/OutlineItem.h>
@@ -28,6 +33,8 @@
 #include <Script/Engine2.h>
 #include <Udb/Idx.h>
 #include <Udb/Transaction.h>
+#include <Udb/Database.h>
+#include <QBitArray>
 using namespace Wt;
 
 typedef bool (*TypeFilter)( quint32 type );
@@ -52,6 +59,652 @@ static int getSubsOfType(lua_State *L, TypeFilter filter )
 	return 1;
 }
 
+// Spaltenweises Lesen: statt pro Objekt und Attribut eine Methode aufzurufen, werden alle
+// verlangten Attribute aller Objekte in einem Durchgang in Lua-Arrays (eines pro Attribut)
+// geschrieben. Daten als Julian Day, OIDs als Zahl, fehlende Werte als false, damit #col
+// immer der Anzahl Objekte entspricht.
+enum ColKind { ColDate, ColUInt8, ColUInt16, ColUInt32, ColInt32, ColBool, ColOid, ColString,
+			   ColObject, ColSelfOid, ColType };
+struct _Column
+{
+	const char* d_name;
+	quint32 d_atom;
+	quint8 d_kind;
+};
+static const _Column s_columns[] =
+{
+	{ "object", 0, ColObject },
+	{ "oid", 0, ColSelfOid },
+	{ "type", 0, ColType },
+	{ "Text", AttrText, ColString },
+	{ "InternalId", AttrInternalId, ColString },
+	{ "CustomId", AttrCustomId, ColString },
+	{ "EarlyStart", AttrEarlyStart, ColDate },
+	{ "EarlyFinish", AttrEarlyFinish, ColDate },
+	{ "LateStart", AttrLateStart, ColDate },
+	{ "LateFinish", AttrLateFinish, ColDate },
+	{ "Duration", AttrDuration, ColUInt16 },
+	{ "OptimisticDur", AttrOptimisticDur, ColUInt16 },
+	{ "PessimisticDur", AttrPessimisticDur, ColUInt16 },
+	{ "MostLikelyDur", AttrMostLikelyDur, ColUInt16 },
+	{ "PlannedValue", AttrPlannedValue, ColUInt32 },
+	{ "EarnedValue", AttrEarnedValue, ColUInt32 },
+	{ "ActualCost", AttrActualCost, ColUInt32 },
+	{ "TaskType", AttrTaskType, ColUInt8 },
+	{ "SubTMSCount", AttrSubTMSCount, ColUInt32 },
+	{ "WbsRef", AttrWbsRef, ColOid },
+	{ "CriticalPath", AttrCriticalPath, ColBool },
+	{ "Calendar", AttrCalendar, ColOid },
+	{ "MsType", AttrMsType, ColUInt8 },
+	{ "Pred", AttrPred, ColOid },
+	{ "Succ", AttrSucc, ColOid },
+	{ "LinkType", AttrLinkType, ColUInt8 },
+	{ "Lag", AttrLag, ColInt32 },
+	{ "LagElapsed", AttrLagElapsed, ColBool },
+	{ 0, 0, 0 }
+};
+
+static void _collectSchedObjs( const Udb::Obj& parent, bool links, QList<Udb::Obj>& res )
+{
+	Udb::Obj sub = parent.getFirstObj();
+	if( !sub.isNull() ) do
+	{
+		const quint32 type = sub.getType();
+		if( ( links && type == TypeLink ) || ( !links && WtTypeDefs::isSchedObj( type ) ) )
+			res.append( sub );
+		if( WtTypeDefs::isImpType( type ) )
+			_collectSchedObjs( sub, links, res );
+	}while( sub.next() );
+}
+
+static void _pushCell( lua_State *L, const Udb::Obj& o, const _Column& c )
+{
+	switch( c.d_kind )
+	{
+	case ColObject:
+		Udb::LuaBinding::pushObject( L, o );
+		return;
+	case ColSelfOid:
+		lua_pushnumber( L, o.getOid() );
+		return;
+	case ColType:
+		lua_pushnumber( L, o.getType() );
+		return;
+	default:
+		break;
+	}
+	const Stream::DataCell v = o.getValue( c.d_atom );
+	if( v.isNull() )
+	{
+		lua_pushboolean( L, false );
+		return;
+	}
+	switch( c.d_kind )
+	{
+	case ColDate:
+		if( v.getDate().isValid() )
+			lua_pushinteger( L, v.getDate().toJulianDay() );
+		else
+			lua_pushboolean( L, false );
+		break;
+	case ColUInt8:
+		lua_pushinteger( L, v.getUInt8() );
+		break;
+	case ColUInt16:
+		lua_pushinteger( L, v.getUInt16() );
+		break;
+	case ColUInt32:
+		lua_pushnumber( L, v.getUInt32() );
+		break;
+	case ColInt32:
+		lua_pushinteger( L, v.getInt32() );
+		break;
+	case ColBool:
+		lua_pushboolean( L, v.getBool() );
+		break;
+	case ColOid:
+		lua_pushnumber( L, v.getOid() );
+		break;
+	case ColString:
+		lua_pushstring( L, o.getString( c.d_atom ).toUtf8().constData() );
+		break;
+	}
+}
+
+static const _Column* _findColumn( const char* name )
+{
+	for( int j = 0; name != 0 && s_columns[j].d_name != 0; j++ )
+	{
+		if( qstrcmp( s_columns[j].d_name, name ) == 0 )
+			return &s_columns[j];
+	}
+	return 0;
+}
+
+// Erwartet die Objekte in objs und die Liste der Spaltennamen an Stackposition names;
+// gibt eine Tabelle { n = Anzahl, <name> = { Werte } } zurueck
+static int _pushColumns( lua_State *L, const QList<Udb::Obj>& objs, int names )
+{
+	luaL_checktype( L, names, LUA_TTABLE );
+	QList<const _Column*> cols;
+	const int count = lua_objlen( L, names );
+	for( int i = 1; i <= count; i++ )
+	{
+		lua_rawgeti( L, names, i );
+		const char* name = lua_tostring( L, -1 );
+		const _Column* c = _findColumn( name );
+		if( c == 0 )
+			luaL_error( L, "unknown column '%s'", ( name ) ? name : "?" );
+		cols.append( c );
+		lua_pop( L, 1 );
+	}
+
+	// Alle Spaltentabellen liegen gleichzeitig auf dem Stack, dazu die Resultat-Tabelle und
+	// was _pushCell temporaer braucht; LUA_MINSTACK reicht ab etwa 20 Spalten nicht mehr
+	luaL_checkstack( L, cols.size() + 3, "too many columns" );
+	lua_createtable( L, 0, cols.size() + 1 );
+	const int res = lua_gettop( L );
+	lua_pushinteger( L, objs.size() );
+	lua_setfield( L, res, "n" );
+	const int first = res + 1;
+	for( int j = 0; j < cols.size(); j++ )
+		lua_createtable( L, objs.size(), 0 ); // liegen auf first + j
+	for( int i = 0; i < objs.size(); i++ )
+	{
+		for( int j = 0; j < cols.size(); j++ )
+		{
+			_pushCell( L, objs[i], *cols[j] );
+			lua_rawseti( L, first + j, i + 1 );
+		}
+	}
+	for( int j = cols.size() - 1; j >= 0; j-- )
+		lua_setfield( L, res, cols[j]->d_name ); // nimmt die oberste Tabelle = first + j
+	return 1;
+}
+
+// source ist ein IMP-Objekt (alle Tasks und Milestones darunter bzw. mit links=true alle Links)
+// oder ein Array von Objekten
+static int _getColumns( lua_State *L, int source, int names, int links )
+{
+	QList<Udb::Obj> objs;
+	if( lua_istable( L, source ) )
+	{
+		const int count = lua_objlen( L, source );
+		objs.reserve( count );
+		for( int i = 1; i <= count; i++ )
+		{
+			lua_rawgeti( L, source, i );
+			Udb::ContentObject* o = Udb::CoBin<Udb::ContentObject>::check( L, -1 );
+			objs.append( *o );
+			lua_pop( L, 1 );
+		}
+	}else
+	{
+		Udb::ContentObject* root = Udb::CoBin<Udb::ContentObject>::check( L, source );
+		_collectSchedObjs( *root, lua_toboolean( L, links ), objs );
+	}
+	return _pushColumns( L, objs, names );
+}
+
+// Lazy Iteratoren fuer for-Schleifen: for o in wt:getAssignments( x ) do ... end
+// Ein _Walker liefert pro Aufruf die naechsten Werte; es wird nie eine Trefferliste oder
+// Lua-Tabelle aufgebaut. Die Closure haelt den Walker als Userdata, __gc loescht ihn.
+static const char* s_walker = "WtWalker";
+static const char* s_writeQueue = "WtWriteQueue"; // Registry, siehe LuaBinding::setWriteQueue
+static const char* s_readOnly = "WtReadOnly"; // Registry, siehe LuaBinding::setReadOnly
+
+static void _checkWritable( lua_State *L )
+{
+	lua_getfield( L, LUA_REGISTRYINDEX, s_readOnly );
+	const bool readOnly = lua_toboolean( L, -1 );
+	lua_pop( L, 1 );
+	if( readOnly )
+		luaL_error( L, "the repository cannot be modified from a background script; use wt:queueSet" );
+}
+
+struct _Walker
+{
+	virtual ~_Walker() {}
+	virtual int next( lua_State *L ) = 0; // Anzahl gepushter Werte, 0 am Ende
+};
+
+static int _walkerGc(lua_State *L)
+{
+	_Walker** w = (_Walker**)luaL_checkudata( L, 1, s_walker );
+	delete *w;
+	*w = 0;
+	return 0;
+}
+
+static int _walkerNext(lua_State *L)
+{
+	_Walker** w = (_Walker**)lua_touserdata( L, lua_upvalueindex( 1 ) );
+	const int n = ( *w != 0 ) ? (*w)->next( L ) : 0;
+	if( n > 0 )
+		return n;
+	delete *w; // Ressourcen nicht erst beim naechsten GC freigeben
+	*w = 0;
+	lua_pushnil( L );
+	return 1;
+}
+
+static int _pushWalker( lua_State *L, _Walker* walker )
+{
+	_Walker** w = (_Walker**)lua_newuserdata( L, sizeof(_Walker*) );
+	*w = 0;
+	luaL_getmetatable( L, s_walker );
+	lua_setmetatable( L, -2 );
+	*w = walker;
+	lua_pushcclosure( L, _walkerNext, 1 );
+	return 1;
+}
+
+// Pusht o und gibt true zurueck; Typen ohne Binding werden nicht gepusht, damit sie die
+// for-Schleife nicht vorzeitig beenden
+static bool _pushBound( lua_State *L, const Udb::Obj& o )
+{
+	if( o.isNull() )
+		return false;
+	Udb::LuaBinding::pushObject( L, o );
+	if( !lua_isnil( L, -1 ) )
+		return true;
+	lua_pop( L, 1 );
+	return false;
+}
+
+// Exakte Suche auf den Schluessel (OID bzw. ganzer String). Bei IdxCalDate begrenzen
+// d_from/d_to (Julian Days, 0 = offen) die Eintraege innerhalb des Kalenders. Mit d_follow
+// wird statt des indizierten Objekts das von ihm referenzierte geliefert (z.B. AttrSucc eines Links).
+struct _IdxCursor : public _Walker
+{
+	Udb::Transaction* d_txn;
+	Udb::Idx d_idx;
+	qint32 d_from;
+	qint32 d_to;
+	quint32 d_follow;
+	bool d_first;
+	bool d_done;
+	_IdxCursor( Udb::Transaction* txn, const char* index, const Stream::DataCell& key,
+				qint32 from, qint32 to, quint32 follow ):
+		d_txn(txn),d_idx(txn,index),d_from(from),d_to(to),d_follow(follow),d_first(true)
+	{
+		d_done = !d_idx.seek( key );
+	}
+	int next( lua_State *L )
+	{
+		while( !d_done )
+		{
+			if( d_first )
+				d_first = false;
+			else if( !d_idx.nextKey() )
+				break;
+			Udb::Obj o = d_txn->getObject( d_idx.getOid() );
+			if( o.isNull() )
+				continue;
+			if( d_from != 0 || d_to != 0 )
+			{
+				const QDate d = o.getValue( AttrCalDate ).getDate();
+				if( !d.isValid() )
+					continue;
+				const qint32 jd = d.toJulianDay();
+				if( d_to != 0 && jd > d_to )
+					break; // innerhalb des Kalenders nach Datum sortiert
+				if( d_from != 0 && jd < d_from )
+					continue;
+			}
+			if( d_follow != 0 )
+				o = o.getValueAsObj( d_follow );
+			if( _pushBound( L, o ) )
+				return 1;
+		}
+		d_done = true;
+		return 0;
+	}
+};
+
+static int _pushCursor( lua_State *L, Udb::Transaction* txn, const char* index,
+						const Stream::DataCell& key, qint32 from = 0, qint32 to = 0, quint32 follow = 0 )
+{
+	return _pushWalker( L, new _IdxCursor( txn, index, key, from, to, follow ) );
+}
+
+// Pre-order ueber den Teilbaum unterhalb von d_root (ohne d_root); liefert Objekt und Tiefe
+struct _TreeWalker : public _Walker
+{
+	Udb::Obj d_root;
+	Udb::Obj d_cur;
+	int d_depth;
+	_TreeWalker( const Udb::Obj& root ):d_root(root),d_depth(-1) {}
+	bool advance()
+	{
+		if( d_depth < 0 )
+		{
+			d_cur = d_root.getFirstObj();
+			d_depth = 1;
+			return !d_cur.isNull();
+		}
+		if( d_cur.isNull() )
+			return false;
+		const Udb::Obj sub = d_cur.getFirstObj();
+		if( !sub.isNull() )
+		{
+			d_cur = sub;
+			d_depth++;
+			return true;
+		}
+		while( d_depth > 0 )
+		{
+			Udb::Obj n = d_cur;
+			if( n.next() )
+			{
+				d_cur = n;
+				return true;
+			}
+			d_cur = d_cur.getParent();
+			d_depth--;
+		}
+		d_cur = Udb::Obj();
+		return false;
+	}
+	int next( lua_State *L )
+	{
+		while( advance() )
+		{
+			if( _pushBound( L, d_cur ) )
+			{
+				lua_pushinteger( L, d_depth );
+				return 2;
+			}
+		}
+		return 0;
+	}
+};
+
+// Unveraenderliche Adjazenz des Terminnetzes fuer Traversierungen in Lua; die Walker
+// halten eine eigene Referenz, der Snapshot lebt also so lange wie der laengste Iterator.
+// Aenderungen am Repository nach wt:getNetwork() sind im Snapshot nicht sichtbar.
+static const char* s_network = "WtNetwork";
+
+struct _Network
+{
+	QExplicitlySharedDataPointer<ScheduleNet> d_net;
+	Udb::Transaction* d_txn;
+};
+
+struct _NetWalker : public _Walker
+{
+	QExplicitlySharedDataPointer<ScheduleNet> d_net;
+	Udb::Transaction* d_txn;
+	bool d_backward;
+	_NetWalker( const _Network* n, bool backward ):d_net(n->d_net),d_txn(n->d_txn),d_backward(backward) {}
+	int begin( int node ) const
+	{
+		return ( d_backward ) ? d_net->d_inStart[node] : d_net->d_outStart[node];
+	}
+	int end( int node ) const
+	{
+		return ( d_backward ) ? d_net->d_inStart[node + 1] : d_net->d_outStart[node + 1];
+	}
+	const ScheduleNet::Link& link( int k ) const
+	{
+		return d_net->d_links[ ( d_backward ) ? d_net->d_in[k] : d_net->d_out[k] ];
+	}
+	int neighbour( int k ) const
+	{
+		return ( d_backward ) ? link( k ).d_pred : link( k ).d_succ;
+	}
+	bool pushNode( lua_State *L, int node ) const
+	{
+		return _pushBound( L, d_txn->getObject( d_net->d_oids[node] ) );
+	}
+};
+
+// Direkte Nachfolger bzw. Vorgaenger; liefert Objekt, Link-Typ und Lag
+struct _AdjWalker : public _NetWalker
+{
+	int d_pos;
+	int d_end;
+	_AdjWalker( const _Network* n, int node, bool backward ):_NetWalker(n,backward)
+	{
+		d_pos = begin( node );
+		d_end = end( node );
+	}
+	int next( lua_State *L )
+	{
+		while( d_pos < d_end )
+		{
+			const int k = d_pos++;
+			if( pushNode( L, neighbour( k ) ) )
+			{
+				lua_pushinteger( L, link( k ).d_type );
+				lua_pushinteger( L, link( k ).d_lag );
+				return 3;
+			}
+		}
+		return 0;
+	}
+};
+
+// Breiten- bzw. Tiefensuche ab einem Knoten; liefert Objekt und Tiefe, Start mit Tiefe 0
+struct _SearchWalker : public _NetWalker
+{
+	QVector<int> d_nodes; // Queue bzw. Stack
+	QVector<int> d_depths;
+	QBitArray d_seen;
+	int d_head; // nur Breitensuche
+	bool d_depthFirst;
+	_SearchWalker( const _Network* n, int start, bool backward, bool depthFirst ):
+		_NetWalker(n,backward),d_seen(n->d_net->d_oids.size()),d_head(0),d_depthFirst(depthFirst)
+	{
+		d_nodes.append( start );
+		d_depths.append( 0 );
+		if( !d_depthFirst )
+			d_seen.setBit( start );
+	}
+	int next( lua_State *L )
+	{
+		while( d_head < d_nodes.size() )
+		{
+			int node, depth;
+			if( d_depthFirst )
+			{
+				node = d_nodes.last();
+				depth = d_depths.last();
+				d_nodes.pop_back();
+				d_depths.pop_back();
+				if( d_seen.testBit( node ) )
+					continue;
+				d_seen.setBit( node );
+				// rueckwaerts auf den Stack, damit die Nachfolger in Link-Reihenfolge kommen
+				for( int k = end( node ) - 1; k >= begin( node ); k-- )
+				{
+					if( !d_seen.testBit( neighbour( k ) ) )
+					{
+						d_nodes.append( neighbour( k ) );
+						d_depths.append( depth + 1 );
+					}
+				}
+			}else
+			{
+				node = d_nodes[d_head];
+				depth = d_depths[d_head];
+				d_head++;
+				for( int k = begin( node ); k < end( node ); k++ )
+				{
+					const int m = neighbour( k );
+					if( !d_seen.testBit( m ) )
+					{
+						d_seen.setBit( m );
+						d_nodes.append( m );
+						d_depths.append( depth + 1 );
+					}
+				}
+			}
+			if( pushNode( L, node ) )
+			{
+				lua_pushinteger( L, depth );
+				return 2;
+			}
+		}
+		return 0;
+	}
+};
+
+// Topologische Ordnung nach Kahn; Knoten auf Zyklen werden nie geliefert
+struct _TopoWalker : public _NetWalker
+{
+	QVector<int> d_indeg;
+	QVector<int> d_queue;
+	int d_head;
+	_TopoWalker( const _Network* n ):_NetWalker(n,false),d_head(0)
+	{
+		const int count = d_net->d_oids.size();
+		d_indeg.resize( count );
+		d_queue.reserve( count );
+		for( int i = 0; i < count; i++ )
+		{
+			d_indeg[i] = d_net->d_inStart[i + 1] - d_net->d_inStart[i];
+			if( d_indeg[i] == 0 )
+				d_queue.append( i );
+		}
+	}
+	int next( lua_State *L )
+	{
+		while( d_head < d_queue.size() )
+		{
+			const int node = d_queue[d_head++];
+			for( int k = begin( node ); k < end( node ); k++ )
+			{
+				const int m = neighbour( k );
+				if( --d_indeg[m] == 0 )
+					d_queue.append( m );
+			}
+			if( pushNode( L, node ) )
+				return 1;
+		}
+		return 0;
+	}
+};
+
+static _Network* _checkNetwork( lua_State *L, int n )
+{
+	_Network** net = (_Network**)luaL_checkudata( L, n, s_network );
+	if( *net == 0 )
+		luaL_argerror( L, n, "network already released" );
+	return *net;
+}
+
+// Knoten als Objekt oder OID
+static int _checkNode( lua_State *L, int n, const _Network* net )
+{
+	Udb::OID oid;
+	if( lua_type( L, n ) == LUA_TNUMBER )
+		oid = lua_tonumber( L, n );
+	else
+		oid = Udb::CoBin<Udb::ContentObject>::check( L, n )->getOid();
+	const int i = net->d_net->indexOf( oid );
+	if( i == -1 )
+		luaL_argerror( L, n, "not a task or milestone of the network" );
+	return i;
+}
+
+static int _networkGc(lua_State *L)
+{
+	_Network** net = (_Network**)luaL_checkudata( L, 1, s_network );
+	delete *net;
+	*net = 0;
+	return 0;
+}
+
+static int _networkGetCount(lua_State *L)
+{
+	lua_pushinteger( L, _checkNetwork( L, 1 )->d_net->d_oids.size() );
+	return 1;
+}
+
+static int _networkGetLinkCount(lua_State *L)
+{
+	lua_pushinteger( L, _checkNetwork( L, 1 )->d_net->d_links.size() );
+	return 1;
+}
+
+static int _networkSuccessors(lua_State *L)
+{
+	// successors( node ): for succ, type, lag in net:successors( t ) do ... end
+	_Network* net = _checkNetwork( L, 1 );
+	return _pushWalker( L, new _AdjWalker( net, _checkNode( L, 2, net ), false ) );
+}
+
+static int _networkPredecessors(lua_State *L)
+{
+	_Network* net = _checkNetwork( L, 1 );
+	return _pushWalker( L, new _AdjWalker( net, _checkNode( L, 2, net ), true ) );
+}
+
+static int _networkBfs(lua_State *L)
+{
+	// bfs( start [, backward] ): for obj, depth in net:bfs( t ) do ... end
+	_Network* net = _checkNetwork( L, 1 );
+	return _pushWalker( L, new _SearchWalker( net, _checkNode( L, 2, net ), lua_toboolean( L, 3 ), false ) );
+}
+
+static int _networkDfs(lua_State *L)
+{
+	// dfs( start [, backward] ): Pre-order
+	_Network* net = _checkNetwork( L, 1 );
+	return _pushWalker( L, new _SearchWalker( net, _checkNode( L, 2, net ), lua_toboolean( L, 3 ), true ) );
+}
+
+static int _networkTopological(lua_State *L)
+{
+	return _pushWalker( L, new _TopoWalker( _checkNetwork( L, 1 ) ) );
+}
+
+static const luaL_reg _Network_reg[] =
+{
+	{ "getCount", _networkGetCount },
+	{ "getLinkCount", _networkGetLinkCount },
+	{ "successors", _networkSuccessors },
+	{ "predecessors", _networkPredecessors },
+	{ "bfs", _networkBfs },
+	{ "dfs", _networkDfs },
+	{ "topological", _networkTopological },
+	{ 0, 0 }
+};
+
+static int _pushNetwork( lua_State *L, Udb::Transaction* txn )
+{
+	_Network** net = (_Network**)lua_newuserdata( L, sizeof(_Network*) );
+	*net = 0;
+	luaL_getmetatable( L, s_network );
+	lua_setmetatable( L, -2 );
+	*net = new _Network();
+	(*net)->d_net = ScheduleNet::create( txn );
+	(*net)->d_txn = txn;
+	return 1;
+}
+
+// Datum als Julian Day (Zahl) oder ISO-String; nil ergibt 0
+static qint32 _toJulianDay( lua_State *L, int n )
+{
+	if( lua_isnoneornil( L, n ) )
+		return 0;
+	if( lua_type( L, n ) == LUA_TNUMBER )
+		return lua_tointeger( L, n );
+	const QDate d = QDate::fromString( QString::fromUtf8( luaL_checkstring( L, n ) ), Qt::ISODate );
+	if( !d.isValid() )
+		luaL_argerror( L, n, "invalid date" );
+	return d.toJulianDay();
+}
+
+static Stream::DataCell _toKey( lua_State *L, int n )
+{
+	if( lua_type( L, n ) == LUA_TSTRING )
+		return Stream::DataCell().setString( QString::fromUtf8( lua_tostring( L, n ) ) );
+	Udb::ContentObject* o = Udb::CoBin<Udb::ContentObject>::check( L, n );
+	return Stream::DataCell().setOid( o->getOid() );
+}
+
 
 struct _Imp : public Udb::ContentObject
 {
@@ -63,6 +716,7 @@ struct _Imp : public Udb::ContentObject
 	static int addType( lua_State *L, quint32 type )
 	{
 		_Imp* obj = Udb::CoBin<_Imp>::check( L, 1 );
+		_checkWritable( L );
 		if( !WtTypeDefs::isValidAggregate( obj->getType(), type ) )
 			luaL_argerror( L, 2, "invalid aggregate type in this context" );
 
@@ -74,6 +728,31 @@ struct _Imp : public Udb::ContentObject
 	static int addEvent(lua_State *L) { return addType( L, TypeImpEvent ); }
 	static int addAccomplishment(lua_State *L) { return addType( L, TypeAccomplishment ); }
 	static int addCriterion(lua_State *L) { return addType( L, TypeCriterion ); }
+	static int addTypes( lua_State *L, quint32 type )
+	{
+		// addTasks( count ): Tabelle mit count neuen Objekten; ein Counter-Update pro Typ und Parent
+		_Imp* obj = Udb::CoBin<_Imp>::check( L, 1 );
+		const int count = luaL_checkinteger( L, 2 );
+		_checkWritable( L );
+		if( !WtTypeDefs::isValidAggregate( obj->getType(), type ) )
+			luaL_argerror( L, 1, "invalid aggregate type in this context" );
+		if( count < 0 )
+			luaL_argerror( L, 2, "expecting non-negative count" );
+		lua_createtable( L, count, 0 );
+		const int table = lua_gettop( L );
+		ObjectHelper::BulkCreator bulk( obj->getTxn(), count );
+		for( int i = 1; i <= count; i++ )
+		{
+			Udb::LuaBinding::pushObject( L, bulk.createObject( type, *obj ) );
+			lua_rawseti( L, table, i );
+		}
+		bulk.flush();
+		return 1;
+	}
+	static int addTasks(lua_State *L) { return addTypes( L, TypeTask ); }
+	static int addMilestones(lua_State *L) { return addTypes( L, TypeMilestone ); }
+	// getColumns( names [, links] )
+	static int getColumns(lua_State *L) { return _getColumns( L, 1, 2, 3 ); }
 };
 
 static const luaL_reg _Imp_reg[] =
@@ -85,6 +764,9 @@ static const luaL_reg _Imp_reg[] =
 	{ "addEvent", _Imp::addEvent },
 	{ "addAccomplishment", _Imp::addAccomplishment },
 	{ "addCriterion", _Imp::addCriterion },
+	{ "addTasks", _Imp::addTasks },
+	{ "addMilestones", _Imp::addMilestones },
+	{ "getColumns", _Imp::getColumns },
 	{ 0, 0 }
 };
 
@@ -98,6 +780,7 @@ static int _getPrettyTitle(lua_State *L)
 static int _erase(lua_State *L)
 {
 	Udb::ContentObject* obj = Udb::CoBin<Udb::ContentObject>::check( L, 1 );
+	_checkWritable( L );
 	ObjectHelper::erase( *obj );
 	// *obj = Udb::Obj(); // Nein, es koennte ja danach Rollback stattfinden
 	return 1;
@@ -108,6 +791,7 @@ static int _moveTo(lua_State *L)
 	Udb::ContentObject* obj = Udb::CoBin<Udb::ContentObject>::check( L, 1 );
 	Udb::ContentObject* parent = Udb::CoBin<Udb::ContentObject>::check( L, 2 );
 	Udb::ContentObject* before = Udb::CoBin<Udb::ContentObject>::cast( L, 3 );
+	_checkWritable( L );
 	if( before && !before->getParent().equals( *parent ) )
 		luaL_argerror( L, 3, "'before' must be a child of 'parent'" );
 	if( !WtTypeDefs::isValidAggregate( parent->getType(), obj->getType() ) )
@@ -119,11 +803,19 @@ static int _moveTo(lua_State *L)
 	return 0;
 }
 
+static int _walk(lua_State *L)
+{
+	// walk(): for o, depth in imp:walk() do ... end ueber den ganzen Teilbaum
+	Udb::ContentObject* obj = Udb::CoBin<Udb::ContentObject>::check( L, 1 );
+	return _pushWalker( L, new _TreeWalker( *obj ) );
+}
+
 static const luaL_reg _ContentObject_reg[] =
 {
 	{ "getPrettyTitle", _getPrettyTitle },
 	{ "delete", _erase },
 	{ "moveTo", _moveTo },
+	{ "walk", _walk },
 	{ 0, 0 }
 };
 
@@ -177,10 +869,24 @@ struct _SchedObj : public _Imp
 		}
 		return 1;
 	}
+	static int successors(lua_State *L)
+	{
+		// Lazy Variante von getSuccessors: for s in t:successors() do ... end
+		_SchedObj* obj = Udb::CoBin<_SchedObj>::check( L, 1 );
+		return _pushCursor( L, obj->getTxn(), IndexDefs::IdxPred,
+							Stream::DataCell().setOid( obj->getOid() ), 0, 0, AttrSucc );
+	}
+	static int predecessors(lua_State *L)
+	{
+		_SchedObj* obj = Udb::CoBin<_SchedObj>::check( L, 1 );
+		return _pushCursor( L, obj->getTxn(), IndexDefs::IdxSucc,
+							Stream::DataCell().setOid( obj->getOid() ), 0, 0, AttrPred );
+	}
 	static int linkTo(lua_State *L)
 	{
 		_SchedObj* pred = Udb::CoBin<_SchedObj>::check( L, 1 );
 		_SchedObj* succ = Udb::CoBin<_SchedObj>::check( L, 2 );
+		_checkWritable( L );
 
 		Udb:Obj link = ObjectHelper::createObject( TypeLink, *pred );
 		link.setValue( AttrPred, *pred );
@@ -207,6 +913,8 @@ static const luaL_reg _SchedObj_reg[] =
 	{ "getActualCost", _SchedObj::getActualCost },
 	{ "getSuccessors", _SchedObj::getSuccessors },
 	{ "getPredecessors", _SchedObj::getPredecessors },
+	{ "successors", _SchedObj::successors },
+	{ "predecessors", _SchedObj::predecessors },
 	{ 0, 0 }
 };
 
@@ -258,6 +966,8 @@ struct _Link : public Udb::ContentObject
 	static int getPred(lua_State *L) { return _getValue<_Link,AttrPred>(L); }
 	static int getSucc(lua_State *L) { return _getValue<_Link,AttrSucc>(L); }
 	static int getLinkType(lua_State *L) { return _getValue<_Link,AttrLinkType>(L); }
+	static int getLag(lua_State *L) { return _getValue<_Link,AttrLag>(L); }
+	static int isLagElapsed(lua_State *L) { return _getValue<_Link,AttrLagElapsed>(L); }
 };
 
 static const luaL_reg _Link_reg[] =
@@ -265,6 +975,8 @@ static const luaL_reg _Link_reg[] =
 	{ "getPred", _Link::getPred },
 	{ "getSucc", _Link::getSucc },
 	{ "getLinkType", _Link::getLinkType },
+	{ "getLag", _Link::getLag },
+	{ "isLagElapsed", _Link::isLagElapsed },
 	{ 0, 0 }
 };
 
@@ -286,6 +998,278 @@ struct _Criterion : public _Imp
 	_Criterion(){}
 };
 
+struct _Baseline : public Udb::ContentObject
+{
+	_Baseline( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_Baseline(){}
+
+	static int getCount(lua_State *L) { return _getValue<_Baseline,AttrBaselineCount>(L); }
+	static int getDataDate(lua_State *L) { return _getValue<_Baseline,AttrBaselineDate>(L); }
+	static int getVariance(lua_State *L)
+	{
+		// Gibt nur die veraenderten, hinzugefuegten oder entfernten SchedObj zurueck
+		_Baseline* obj = Udb::CoBin<_Baseline>::check( L, 1 );
+		const ScheduleVariance v = Baseline::variance( *obj );
+		lua_createtable(L, 0, 0 );
+		const int table = lua_gettop(L);
+		int n = 0;
+		for( int i = 0; i < v.size(); i++ )
+		{
+			if( v.d_state[i] == ScheduleVariance::Unchanged )
+				continue;
+			lua_createtable(L, 0, 8 );
+			const int row = lua_gettop(L);
+			Udb::LuaBinding::pushObject( L, obj->getObject( v.d_oids[i] ) );
+			lua_setfield( L, row, "object" );
+			lua_pushinteger( L, v.d_state[i] );
+			lua_setfield( L, row, "state" );
+			lua_pushinteger( L, v.d_startVar[i] );
+			lua_setfield( L, row, "start" );
+			lua_pushinteger( L, v.d_finishVar[i] );
+			lua_setfield( L, row, "finish" );
+			lua_pushinteger( L, v.d_durVar[i] );
+			lua_setfield( L, row, "duration" );
+			lua_pushnumber( L, v.d_pvVar[i] );
+			lua_setfield( L, row, "pv" );
+			lua_pushnumber( L, v.d_evVar[i] );
+			lua_setfield( L, row, "ev" );
+			lua_pushnumber( L, v.d_acVar[i] );
+			lua_setfield( L, row, "ac" );
+			lua_rawseti( L, table, ++n );
+		}
+		return 1;
+	}
+};
+
+static const luaL_reg _Baseline_reg[] =
+{
+	{ "getCount", _Baseline::getCount },
+	{ "getDataDate", _Baseline::getDataDate },
+	{ "getVariance", _Baseline::getVariance },
+	{ 0, 0 }
+};
+
+struct _Wbs : public Udb::ContentObject
+{
+	_Wbs( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_Wbs(){}
+};
+
+struct _Deliverable : public Udb::ContentObject
+{
+	_Deliverable( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_Deliverable(){}
+};
+
+struct _Work : public Udb::ContentObject
+{
+	_Work( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_Work(){}
+};
+
+struct _Obs : public Udb::ContentObject
+{
+	_Obs( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_Obs(){}
+};
+
+struct _Principal : public Udb::ContentObject
+{
+	_Principal( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_Principal(){}
+
+	static int getPrincipalName(lua_State *L) { return _getValue<_Principal,AttrPrincipalName>(L); }
+};
+
+static const luaL_reg _Principal_reg[] =
+{
+	{ "getPrincipalName", _Principal::getPrincipalName },
+	{ 0, 0 }
+};
+
+struct _OrgUnit : public _Principal
+{
+	_OrgUnit( const Udb::Obj& o ):_Principal(o){}
+	_OrgUnit(){}
+};
+
+struct _Resource : public _Principal
+{
+	_Resource( const Udb::Obj& o ):_Principal(o){}
+	_Resource(){}
+};
+
+struct _Role : public _Principal
+{
+	_Role( const Udb::Obj& o ):_Principal(o){}
+	_Role(){}
+
+	static int getRoleAssig(lua_State *L) { return _getValue<_Role,AttrRoleAssig>(L); }
+	static int getRoleDeputy(lua_State *L) { return _getValue<_Role,AttrRoleDeputy>(L); }
+};
+
+static const luaL_reg _Role_reg[] =
+{
+	{ "getRoleAssig", _Role::getRoleAssig },
+	{ "getRoleDeputy", _Role::getRoleDeputy },
+	{ 0, 0 }
+};
+
+struct _Human : public _Principal
+{
+	_Human( const Udb::Obj& o ):_Principal(o){}
+	_Human(){}
+
+	static int getFirstName(lua_State *L) { return _getValue<_Human,AttrFirstName>(L); }
+	static int getQualiTitle(lua_State *L) { return _getValue<_Human,AttrQualiTitle>(L); }
+	static int getOrganization(lua_State *L) { return _getValue<_Human,AttrOrganization>(L); }
+	static int getDepartment(lua_State *L) { return _getValue<_Human,AttrDepartment>(L); }
+	static int getJobTitle(lua_State *L) { return _getValue<_Human,AttrJobTitle>(L); }
+	static int getEmail(lua_State *L) { return _getValue<_Human,AttrEmail>(L); }
+	static int getPhoneDesk(lua_State *L) { return _getValue<_Human,AttrPhoneDesk>(L); }
+	static int getPhoneMobile(lua_State *L) { return _getValue<_Human,AttrPhoneMobile>(L); }
+};
+
+static const luaL_reg _Human_reg[] =
+{
+	{ "getFirstName", _Human::getFirstName },
+	{ "getQualiTitle", _Human::getQualiTitle },
+	{ "getOrganization", _Human::getOrganization },
+	{ "getDepartment", _Human::getDepartment },
+	{ "getJobTitle", _Human::getJobTitle },
+	{ "getEmail", _Human::getEmail },
+	{ "getPhoneDesk", _Human::getPhoneDesk },
+	{ "getPhoneMobile", _Human::getPhoneMobile },
+	{ 0, 0 }
+};
+
+struct _UnitAssig : public Udb::ContentObject
+{
+	_UnitAssig( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_UnitAssig(){}
+
+	static int getMember(lua_State *L) { return _getValue<_UnitAssig,AttrItemLink>(L); }
+};
+
+static const luaL_reg _UnitAssig_reg[] =
+{
+	{ "getMember", _UnitAssig::getMember },
+	{ 0, 0 }
+};
+
+struct _RasciAssig : public Udb::ContentObject
+{
+	_RasciAssig( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_RasciAssig(){}
+
+	static int getAssigObject(lua_State *L) { return _getValue<_RasciAssig,AttrAssigObject>(L); }
+	static int getPrincipal(lua_State *L) { return _getValue<_RasciAssig,AttrAssigPrincipal>(L); }
+	static int getRole(lua_State *L) { return _getValue<_RasciAssig,AttrRasciRole>(L); }
+};
+
+static const luaL_reg _RasciAssig_reg[] =
+{
+	{ "getAssigObject", _RasciAssig::getAssigObject },
+	{ "getPrincipal", _RasciAssig::getPrincipal },
+	{ "getRole", _RasciAssig::getRole },
+	{ 0, 0 }
+};
+
+struct _Calendar : public Udb::ContentObject
+{
+	_Calendar( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_Calendar(){}
+
+	static int getParentCalendar(lua_State *L) { return _getValue<_Calendar,AttrParentCalendar>(L); }
+	static int getNonWorkingDays(lua_State *L) { return _getValue<_Calendar,AttrNonWorkingDays>(L); }
+	static int getEntryCount(lua_State *L) { return _getValue<_Calendar,AttrCalEntryCount>(L); }
+	static int isWorkday(lua_State *L)
+	{
+		// isWorkday( date ): beruecksichtigt Parent-Kalender und Eintraege
+		_Calendar* obj = Udb::CoBin<_Calendar>::check( L, 1 );
+		const qint32 jd = _toJulianDay( L, 2 );
+		if( jd == 0 )
+			luaL_argerror( L, 2, "expecting date" );
+		lua_pushboolean( L, WorkCalendar::load( *obj ).isWorkday( QDate::fromJulianDay( jd ) ) );
+		return 1;
+	}
+	static int getEntries(lua_State *L)
+	{
+		// getEntries( [from [, to]] ): Iterator in Datumsreihenfolge ueber IdxCalDate
+		_Calendar* obj = Udb::CoBin<_Calendar>::check( L, 1 );
+		return _pushCursor( L, obj->getTxn(), IndexDefs::IdxCalDate,
+							Stream::DataCell().setOid( obj->getOid() ), _toJulianDay( L, 2 ), _toJulianDay( L, 3 ) );
+	}
+};
+
+static const luaL_reg _Calendar_reg[] =
+{
+	{ "getParentCalendar", _Calendar::getParentCalendar },
+	{ "getNonWorkingDays", _Calendar::getNonWorkingDays },
+	{ "getEntryCount", _Calendar::getEntryCount },
+	{ "isWorkday", _Calendar::isWorkday },
+	{ "getEntries", _Calendar::getEntries },
+	{ 0, 0 }
+};
+
+struct _CalEntry : public Udb::ContentObject
+{
+	_CalEntry( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_CalEntry(){}
+
+	static int getDate(lua_State *L) { return _getValue<_CalEntry,AttrCalDate>(L); }
+	static int getDuration(lua_State *L) { return _getValue<_CalEntry,AttrCalDuration>(L); }
+	static int isNonWorking(lua_State *L) { return _getValue<_CalEntry,AttrNonWorking>(L); }
+	static int getAvailability(lua_State *L) { return _getValue<_CalEntry,AttrAvaility>(L); }
+};
+
+static const luaL_reg _CalEntry_reg[] =
+{
+	{ "getDate", _CalEntry::getDate },
+	{ "getDuration", _CalEntry::getDuration },
+	{ "isNonWorking", _CalEntry::isNonWorking },
+	{ "getAvailability", _CalEntry::getAvailability },
+	{ 0, 0 }
+};
+
+struct _Diagram : public Udb::ContentObject
+{
+	_Diagram( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_Diagram(){}
+
+	static int getShowIds(lua_State *L) { return _getValue<_Diagram,AttrShowIds>(L); }
+	static int getMarkAlias(lua_State *L) { return _getValue<_Diagram,AttrMarkAlias>(L); }
+};
+
+static const luaL_reg _Diagram_reg[] =
+{
+	{ "getShowIds", _Diagram::getShowIds },
+	{ "getMarkAlias", _Diagram::getMarkAlias },
+	{ 0, 0 }
+};
+
+struct _DiagramItem : public Udb::ContentObject
+{
+	_DiagramItem( const Udb::Obj& o ):Udb::ContentObject(o){}
+	_DiagramItem(){}
+
+	static int getOrigObject(lua_State *L) { return _getValue<_DiagramItem,AttrOrigObject>(L); }
+	static int getPos(lua_State *L)
+	{
+		_DiagramItem* obj = Udb::CoBin<_DiagramItem>::check( L, 1 );
+		lua_pushnumber( L, obj->getValue( AttrPosX ).getFloat() );
+		lua_pushnumber( L, obj->getValue( AttrPosY ).getFloat() );
+		return 2;
+	}
+};
+
+static const luaL_reg _DiagramItem_reg[] =
+{
+	{ "getOrigObject", _DiagramItem::getOrigObject },
+	{ "getPos", _DiagramItem::getPos },
+	{ 0, 0 }
+};
+
 struct _Repository
 {
 	Udb::Transaction* d_txn;
@@ -297,15 +1281,220 @@ struct _Repository
 		Udb::LuaBinding::pushObject( L, obj->d_txn->getObject( QUuid(WorkTreeApp::s_imp) ) );
 		return 1;
 	}
+	static int getBaselines(lua_State *L)
+	{
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		QList<Udb::Obj> bls = Baseline::findAll( obj->d_txn );
+		lua_createtable(L, bls.size(), 0 );
+		const int table = lua_gettop(L);
+		for( int i = 0; i < bls.size(); i++ )
+		{
+			Udb::LuaBinding::pushObject( L, bls[i] );
+			lua_rawseti( L, table, i + 1 );
+		}
+		return 1;
+	}
+	static int createBaseline(lua_State *L)
+	{
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		_checkWritable( L );
+		Udb::LuaBinding::pushObject( L, Baseline::create( obj->d_txn, luaL_checkstring( L, 2 ) ) );
+		return 1;
+	}
+	static int recordStatusCycle(lua_State *L)
+	{
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		// Die .trend-Datei hat keine Sperre; ein Worker darf nicht gleichzeitig mit der GUI anhaengen
+		_checkWritable( L );
+		StatusTrend trend( obj->d_txn->getDb()->getFilePath() );
+		if( !trend.append( obj->d_txn ) )
+			luaL_error( L, "%s", trend.getError().toUtf8().constData() );
+		return 0;
+	}
+	static int getTrend(lua_State *L)
+	{
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		StatusTrend trend( obj->d_txn->getDb()->getFilePath() );
+		QList<StatusTrend::Point> points = trend.computeMetrics();
+		if( !trend.getError().isEmpty() )
+			luaL_error( L, "%s", trend.getError().toUtf8().constData() );
+		lua_createtable(L, points.size(), 0 );
+		const int table = lua_gettop(L);
+		for( int i = 0; i < points.size(); i++ )
+		{
+			const StatusTrend::Point& p = points[i];
+			lua_createtable(L, 0, 10 );
+			const int row = lua_gettop(L);
+			*Lua::QtValue<QString>::create(L) = p.d_status.toString( Qt::ISODate );
+			lua_setfield( L, row, "status" );
+			lua_pushinteger( L, p.d_count );
+			lua_setfield( L, row, "count" );
+			lua_pushinteger( L, p.d_completed );
+			lua_setfield( L, row, "completed" );
+			lua_pushnumber( L, p.d_bei );
+			lua_setfield( L, row, "bei" );
+			lua_pushnumber( L, p.d_cei );
+			lua_setfield( L, row, "cei" );
+			*Lua::QtValue<QString>::create(L) = p.d_finish.toString( Qt::ISODate );
+			lua_setfield( L, row, "finish" );
+			lua_pushinteger( L, p.d_finishSlip );
+			lua_setfield( L, row, "finishSlip" );
+			lua_pushnumber( L, p.d_avgFloat );
+			lua_setfield( L, row, "avgFloat" );
+			lua_pushinteger( L, p.d_negFloat );
+			lua_setfield( L, row, "negFloat" );
+			lua_pushinteger( L, p.d_eroded );
+			lua_setfield( L, row, "eroded" );
+			lua_rawseti( L, table, i + 1 );
+		}
+		return 1;
+	}
+	static int exportSchedule(lua_State *L)
+	{
+		// exportSchedule( path ): MSPDI oder CSV nach Dateiendung
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		ScheduleExporter exp;
+		if( !exp.exportFile( obj->d_txn->getObject( QUuid( WorkTreeApp::s_imp ) ),
+							 QString::fromUtf8( luaL_checkstring( L, 2 ) ) ) )
+			luaL_error( L, "%s", exp.getError().toUtf8().constData() );
+		lua_pushinteger( L, exp.getCount() );
+		return 1;
+	}
+	static int findObject(lua_State *L)
+	{
+		// findObject( id ): zuerst die Custom ID, dann die interne ID; nil wenn nicht gefunden
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		const Stream::DataCell key = Stream::DataCell().setString( QString::fromUtf8( luaL_checkstring( L, 2 ) ) );
+		Udb::Idx alt( obj->d_txn, IndexDefs::IdxAltIdent );
+		if( alt.seek( key ) )
+		{
+			Udb::LuaBinding::pushObject( L, obj->d_txn->getObject( alt.getOid() ) );
+			return 1;
+		}
+		Udb::Idx ident( obj->d_txn, IndexDefs::IdxIdent );
+		if( ident.seek( key ) )
+			Udb::LuaBinding::pushObject( L, obj->d_txn->getObject( ident.getOid() ) );
+		else
+			lua_pushnil( L );
+		return 1;
+	}
+	static int findByIdent(lua_State *L)
+	{
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		luaL_checkstring( L, 2 );
+		return _pushCursor( L, obj->d_txn, IndexDefs::IdxIdent, _toKey( L, 2 ) );
+	}
+	static int findByCustomId(lua_State *L)
+	{
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		luaL_checkstring( L, 2 );
+		return _pushCursor( L, obj->d_txn, IndexDefs::IdxAltIdent, _toKey( L, 2 ) );
+	}
+	static int getAssignments(lua_State *L)
+	{
+		// getAssignments( obj ): alle RasciAssig auf Deliverable, Work, Task etc.
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		return _pushCursor( L, obj->d_txn, IndexDefs::IdxAssigObject, _toKey( L, 2 ) );
+	}
+	static int getAssignmentsOf(lua_State *L)
+	{
+		// getAssignmentsOf( principal ): alle RasciAssig einer Person, Rolle oder OrgUnit
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		return _pushCursor( L, obj->d_txn, IndexDefs::IdxAssigPrincipal, _toKey( L, 2 ) );
+	}
+	static int getWbsReferences(lua_State *L)
+	{
+		// getWbsReferences( wbs ): alle Tasks mit AttrWbsRef auf das WBS-Element
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		return _pushCursor( L, obj->d_txn, IndexDefs::IdxWbsRef, _toKey( L, 2 ) );
+	}
+	static int getCalendarEntries(lua_State *L)
+	{
+		// getCalendarEntries( cal [, from [, to]] ); Datum als Julian Day oder ISO-String
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		return _pushCursor( L, obj->d_txn, IndexDefs::IdxCalDate, _toKey( L, 2 ),
+							_toJulianDay( L, 3 ), _toJulianDay( L, 4 ) );
+	}
+	static int queueSet(lua_State *L)
+	{
+		// queueSet( obj|oid, name, value ): nur in Hintergrund-Scripts mit Write-back;
+		// name wie bei getColumns, nil loescht das Attribut
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		lua_getfield( L, LUA_REGISTRYINDEX, s_writeQueue );
+		LuaBinding::WriteQueue* queue = (LuaBinding::WriteQueue*)lua_touserdata( L, -1 );
+		lua_pop( L, 1 );
+		if( queue == 0 )
+			luaL_error( L, "queueSet is only available in background scripts with write-back" );
+		LuaBinding::QueuedWrite w;
+		if( lua_type( L, 2 ) == LUA_TNUMBER )
+			w.d_oid = lua_tonumber( L, 2 );
+		else
+			w.d_oid = Udb::CoBin<Udb::ContentObject>::check( L, 2 )->getOid();
+		const _Column* c = _findColumn( luaL_checkstring( L, 3 ) );
+		if( c == 0 || c->d_atom == 0 )
+			luaL_argerror( L, 3, "unknown or read-only attribute" );
+		w.d_atom = c->d_atom;
+		// Fuer die Konfliktpruefung beim Zurueckschreiben, siehe ScriptRunner::apply
+		w.d_old = obj->d_txn->getObject( w.d_oid ).getValue( w.d_atom );
+		if( !lua_isnoneornil( L, 4 ) )
+		{
+			switch( c->d_kind )
+			{
+			case ColDate:
+				w.d_value.setDate( QDate::fromJulianDay( _toJulianDay( L, 4 ) ) );
+				break;
+			case ColUInt8:
+				w.d_value.setUInt8( luaL_checkinteger( L, 4 ) );
+				break;
+			case ColUInt16:
+				w.d_value.setUInt16( luaL_checkinteger( L, 4 ) );
+				break;
+			case ColUInt32:
+				w.d_value.setUInt32( luaL_checknumber( L, 4 ) );
+				break;
+			case ColInt32:
+				w.d_value.setInt32( luaL_checkinteger( L, 4 ) );
+				break;
+			case ColBool:
+				w.d_value.setBool( lua_toboolean( L, 4 ) );
+				break;
+			case ColOid:
+				if( lua_type( L, 4 ) == LUA_TNUMBER )
+					w.d_value.setOid( lua_tonumber( L, 4 ) );
+				else
+					w.d_value.setOid( Udb::CoBin<Udb::ContentObject>::check( L, 4 )->getOid() );
+				break;
+			case ColString:
+				w.d_value.setString( QString::fromUtf8( luaL_checkstring( L, 4 ) ) );
+				break;
+			}
+		}
+		queue->append( w );
+		return 0;
+	}
+	static int getNetwork(lua_State *L)
+	{
+		// getNetwork(): Snapshot des Terminnetzes fuer successors, bfs, dfs und topological
+		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		return _pushNetwork( L, obj->d_txn );
+	}
+	static int getColumns(lua_State *L)
+	{
+		// getColumns( source, names [, links] )
+		Lua::ValueBinding<_Repository>::check( L, 1 );
+		return _getColumns( L, 2, 3, 4 );
+	}
 	static int commit(lua_State *L)
 	{
 		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		_checkWritable( L );
 		obj->d_txn->commit();
 		return 0;
 	}
 	static int rollback(lua_State *L)
 	{
 		_Repository* obj = Lua::ValueBinding<_Repository>::check( L, 1 );
+		_checkWritable( L );
 		obj->d_txn->rollback();
 		return 0;
 	}
@@ -314,6 +1503,21 @@ struct _Repository
 static const luaL_reg _Repository_reg[] =
 {
 	{ "getImp", _Repository::getImp },
+	{ "getBaselines", _Repository::getBaselines },
+	{ "createBaseline", _Repository::createBaseline },
+	{ "recordStatusCycle", _Repository::recordStatusCycle },
+	{ "getTrend", _Repository::getTrend },
+	{ "exportSchedule", _Repository::exportSchedule },
+	{ "getColumns", _Repository::getColumns },
+	{ "getNetwork", _Repository::getNetwork },
+	{ "queueSet", _Repository::queueSet },
+	{ "findObject", _Repository::findObject },
+	{ "findByIdent", _Repository::findByIdent },
+	{ "findByCustomId", _Repository::findByCustomId },
+	{ "getAssignments", _Repository::getAssignments },
+	{ "getAssignmentsOf", _Repository::getAssignmentsOf },
+	{ "getWbsReferences", _Repository::getWbsReferences },
+	{ "getCalendarEntries", _Repository::getCalendarEntries },
 
 	//{ "getRootFolder", _Repository::getRootFolder },
 	//{ "getRootFunction", _Repository::getRootFunction },
@@ -335,6 +1539,21 @@ void Wt::LuaBinding::setRepository(lua_State *L, Udb::Transaction * txn)
 	lua_pop(L, 1); // table
 }
 
+void Wt::LuaBinding::setWriteQueue(lua_State *L, WriteQueue * queue)
+{
+	if( queue )
+		lua_pushlightuserdata( L, queue );
+	else
+		lua_pushnil( L );
+	lua_setfield( L, LUA_REGISTRYINDEX, s_writeQueue );
+}
+
+void Wt::LuaBinding::setReadOnly(lua_State *L, bool on)
+{
+	lua_pushboolean( L, on );
+	lua_setfield( L, LUA_REGISTRYINDEX, s_readOnly );
+}
+
 void Wt::LuaBinding::setCurrentObject(lua_State *L, const Udb::Obj & o)
 {
 	Lua::StackTester test(L, 0 );
@@ -369,6 +1588,36 @@ static void _pushObject(lua_State * L, const Udb::Obj& o )
 		Udb::CoBin<_Accomplishment>::create( L, o );
 	else if( t == TypeCriterion )
 		Udb::CoBin<_Criterion>::create( L, o );
+	else if( t == TypeBaseline )
+		Udb::CoBin<_Baseline>::create( L, o );
+	else if( t == TypeWBS )
+		Udb::CoBin<_Wbs>::create( L, o );
+	else if( t == TypeDeliverable )
+		Udb::CoBin<_Deliverable>::create( L, o );
+	else if( t == TypeWork )
+		Udb::CoBin<_Work>::create( L, o );
+	else if( t == TypeOBS )
+		Udb::CoBin<_Obs>::create( L, o );
+	else if( t == TypeOrgUnit )
+		Udb::CoBin<_OrgUnit>::create( L, o );
+	else if( t == TypeRole )
+		Udb::CoBin<_Role>::create( L, o );
+	else if( t == TypeHuman )
+		Udb::CoBin<_Human>::create( L, o );
+	else if( t == TypeResource )
+		Udb::CoBin<_Resource>::create( L, o );
+	else if( t == TypeUnitAssig )
+		Udb::CoBin<_UnitAssig>::create( L, o );
+	else if( t == TypeRasciAssig )
+		Udb::CoBin<_RasciAssig>::create( L, o );
+	else if( t == TypeCalendar )
+		Udb::CoBin<_Calendar>::create( L, o );
+	else if( t == TypeCalEntry )
+		Udb::CoBin<_CalEntry>::create( L, o );
+	else if( t == TypePdmDiagram )
+		Udb::CoBin<_Diagram>::create( L, o );
+	else if( t == TypePdmItem )
+		Udb::CoBin<_DiagramItem>::create( L, o );
 	else if( t == Oln::OutlineItem::TID )
 		Udb::CoBin<Oln::OutlineItem>::create( L, o );
 	else if( t == Oln::Outline::TID )
@@ -440,6 +1689,61 @@ void Wt::LuaBinding::install(lua_State *L)
 	lua_setfield( L, table, "SF" );
 	lua_pop(L, 1); // table
 
+	Udb::CoBin<_Baseline,Udb::ContentObject>::install( L, "Baseline", _Baseline_reg );
+	lua_getfield( L, LUA_GLOBALSINDEX, "Baseline" );
+	table = lua_gettop(L);
+	lua_pushinteger( L, ScheduleVariance::Changed );
+	lua_setfield( L, table, "Changed" );
+	lua_pushinteger( L, ScheduleVariance::Added );
+	lua_setfield( L, table, "Added" );
+	lua_pushinteger( L, ScheduleVariance::Removed );
+	lua_setfield( L, table, "Removed" );
+	lua_pop(L, 1); // table
+
+	Udb::CoBin<_Wbs,Udb::ContentObject>::install( L, "WBS" );
+	Udb::CoBin<_Deliverable,Udb::ContentObject>::install( L, "Deliverable" );
+	Udb::CoBin<_Work,Udb::ContentObject>::install( L, "Work" );
+	Udb::CoBin<_Obs,Udb::ContentObject>::install( L, "OBS" );
+	Udb::CoBin<_Principal,Udb::ContentObject>::install( L, "Principal", _Principal_reg );
+	Udb::CoBin<_OrgUnit,_Principal>::install( L, "OrgUnit" );
+	Udb::CoBin<_Role,_Principal>::install( L, "Role", _Role_reg );
+	Udb::CoBin<_Human,_Principal>::install( L, "Human", _Human_reg );
+	Udb::CoBin<_Resource,_Principal>::install( L, "Resource" );
+	Udb::CoBin<_UnitAssig,Udb::ContentObject>::install( L, "UnitAssig", _UnitAssig_reg );
+
+	Udb::CoBin<_RasciAssig,Udb::ContentObject>::install( L, "RasciAssig", _RasciAssig_reg );
+	lua_getfield( L, LUA_GLOBALSINDEX, "RasciAssig" );
+	table = lua_gettop(L);
+	lua_pushinteger( L, Rasci_Responsible );
+	lua_setfield( L, table, "Responsible" );
+	lua_pushinteger( L, Rasci_Accountable );
+	lua_setfield( L, table, "Accountable" );
+	lua_pushinteger( L, Rasci_Supportive );
+	lua_setfield( L, table, "Supportive" );
+	lua_pushinteger( L, Rasci_Consulted );
+	lua_setfield( L, table, "Consulted" );
+	lua_pushinteger( L, Rasci_Informed );
+	lua_setfield( L, table, "Informed" );
+	lua_pop(L, 1); // table
+
+	Udb::CoBin<_Calendar,Udb::ContentObject>::install( L, "Calendar", _Calendar_reg );
+	Udb::CoBin<_CalEntry,Udb::ContentObject>::install( L, "CalEntry", _CalEntry_reg );
+	Udb::CoBin<_Diagram,Udb::ContentObject>::install( L, "Diagram", _Diagram_reg );
+	Udb::CoBin<_DiagramItem,Udb::ContentObject>::install( L, "DiagramItem", _DiagramItem_reg );
+
+	luaL_newmetatable( L, s_walker );
+	lua_pushcfunction( L, _walkerGc );
+	lua_setfield( L, -2, "__gc" );
+	lua_pop(L, 1); // metatable
+
+	luaL_newmetatable( L, s_network );
+	table = lua_gettop(L);
+	lua_pushcfunction( L, _networkGc );
+	lua_setfield( L, table, "__gc" );
+	lua_newtable( L );
+	luaL_register( L, 0, _Network_reg );
+	lua_setfield( L, table, "__index" );
+	lua_pop(L, 1); // metatable
 }
 
 
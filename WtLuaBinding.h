@@ -21,6 +21,7 @@
 */
 
 #include <Udb/Obj.h>
+#include <QList>
 
 typedef struct lua_State lua_State;
 
@@ -29,8 +30,22 @@ namespace Wt
 	class LuaBinding
 	{
 	public:
+		// Von wt:queueSet gesammelte Aenderung, die erst nach dem Script angewendet wird
+		struct QueuedWrite
+		{
+			Udb::OID d_oid;
+			quint32 d_atom;
+			Stream::DataCell d_value; // null: Attribut loeschen
+			Stream::DataCell d_old; // Wert in der Transaktion des Scripts beim Aufruf von queueSet
+		};
+		typedef QList<QueuedWrite> WriteQueue;
+
 		static void install(lua_State * L);
 		static void setRepository(lua_State * L, Udb::Transaction* );
+		static void setWriteQueue( lua_State * L, WriteQueue* ); // 0: wt:queueSet nicht erlaubt
+		// true: Funktionen, die das Repository aendern (add*, linkTo, delete, moveTo, createBaseline,
+		// commit, rollback) loesen einen Lua-Fehler aus; fuer Scripts auf einem Worker-Thread
+		static void setReadOnly( lua_State * L, bool );
 		static void setCurrentObject( lua_State * L, const Udb::Obj& );
 		static void setCurrentObject( const Udb::Obj& );
 	private:
@@ -468,6 +468,24 @@ QString WtTypeDefs::prettyName(quint32 type)
         return tr("Availability");
     case AttrCalEntryCount:
         return tr("Calendar Entries");
+    case TypeBaseline:
+        return tr("Baseline");
+    case AttrBaselineData:
+        return tr("Baseline Data");
+    case AttrBaselineCount:
+        return tr("Baselined Items");
+    case AttrBaselineDate:
+        return tr("Baseline Data Date");
+    case AttrLag:
+        return tr("Lag");
+    case AttrLagElapsed:
+        return tr("Elapsed Lag");
+    case AttrLinkCondensed:
+        return tr("Condensed Links");
+    case AttrCondPred:
+        return tr("Condensed Predecessor");
+    case AttrCondSucc:
+        return tr("Condensed Successor");
 
         // TEST
     case TypePdmItem:
@@ -585,6 +603,10 @@ QString WtTypeDefs::formatValue(Udb::Atom name, const Udb::Obj & obj, bool useIc
         return QString("%1 workdays").arg( v.getUInt16() );
     else if( name == AttrMsType )
         return formatMsType( v.getUInt8() );
+    else if( name == AttrBaselineData )
+        return QString("%1 bytes").arg( v.getArr().size() );
+    else if( name == AttrLag )
+        return formatLag( v.getInt32(), obj.getValue( AttrLagElapsed ).getBool() );
 
     // TODO: Auflsung von weiteren EnumDefs
 
@@ -675,6 +697,24 @@ QString WtTypeDefs::formatLinkType(quint8 v, bool codeOnly)
         }
 }
 
+QString WtTypeDefs::formatLag(qint32 lag, bool elapsed)
+{
+    if( elapsed )
+        return tr("%1%2 elapsed days").arg( ( lag > 0 )?"+":"" ).arg( lag );
+    else
+        return tr("%1%2 workdays").arg( ( lag > 0 )?"+":"" ).arg( lag );
+}
+
+QString WtTypeDefs::formatLinkCode(const Udb::Obj & link)
+{
+    QString res = formatLinkType( link.getValue( AttrLinkType ).getUInt8(), true );
+    const qint32 lag = link.getValue( AttrLag ).getInt32();
+    if( lag != 0 )
+        res += QString("%1%2%3").arg( ( lag > 0 )?"+":"" ).arg( lag ).
+               arg( ( link.getValue( AttrLagElapsed ).getBool() )?tr("ed"):tr("d") );
+    return res;
+}
+
 QString WtTypeDefs::formatRasciRole(quint8 v, bool codeOnly)
 {
     if( codeOnly )
@@ -915,6 +955,12 @@ Obj WtTypeDefs::getProject(Transaction *txn)
     return txn->getOrCreateObject( WorkTreeApp::s_project );
 }
 
+Obj WtTypeDefs::getBaselines(Transaction *txn)
+{
+    Q_ASSERT( txn != 0 );
+    return txn->getOrCreateObject( WorkTreeApp::s_baselines );
+}
+
 Udb::Obj WtTypeDefs::getRoot(Udb::Transaction * txn)
 {
     Q_ASSERT( txn != 0 );
@@ -30,7 +30,7 @@ namespace Wt
     enum WtNumbers
 	{
 		WtStart = 0x20000,
-		WtMax = WtStart + 99,
+		WtMax = WtStart + 108,
 		WtEnd = WtStart + 1000 // Ab hier werden dynamische Atome angelegt
 	};
 
@@ -85,7 +85,8 @@ namespace Wt
         AttrEarnedValue = WtStart + 89, // uint32
         AttrActualCost = WtStart + 90, // uint32
 
-        // TODO: Baselines, Actuals
+        // NOTE: Baselines werden nicht als einzelne Attribute, sondern als TypeBaseline gespeichert
+        // TODO: Actuals
 	};
 
     enum EnumDef_TaskType
@@ -143,7 +144,8 @@ namespace Wt
 		AttrPred = WtStart + 16, // OID, Predecessor Task or Milestone
 		AttrSucc = WtStart + 17, // OID, Successor Task or Milestone
         AttrLinkType = WtStart + 18, // uint8, LinkType
-        // TODO: ev. summary Links, welche mehrere untergeordnete reprsentieren
+        AttrLag = WtStart + 104, // int32: Lag (positiv) bzw. Lead (negativ) in Workdays bzw. Kalendertagen
+        AttrLagElapsed = WtStart + 105, // bool: true wenn AttrLag in Kalendertagen (7x24) statt Workdays
 	};
 
     enum TypeDef_ImpEvent // inherits Object
@@ -341,6 +343,21 @@ namespace Wt
         AttrPosY = WtStart + 40, // float
         AttrPointList = WtStart + 41, // frame ( xFloat, yFloat )* end
         AttrOrigObject = WtStart + 42, // OID; zeigt auf Task, MS oder Link, die durch das PdmItem dargestellt werden
+        // Verdichteter Link, siehe NetCondenser; existiert nur auf dem Diagramm, hat kein AttrOrigObject
+        // und trgt AttrLinkType, AttrLag und AttrCriticalPath selber
+        AttrLinkCondensed = WtStart + 106, // uint32: reprsentiert soviele Links zwischen Subtasks
+        AttrCondPred = WtStart + 107, // OID, nicht indiziert: Vorgnger des verdichteten Links
+        AttrCondSucc = WtStart + 108, // OID, nicht indiziert: Nachfolger des verdichteten Links
+    };
+
+    enum TypeDef_Baseline // inherits Object
+    {
+        // Aggregat von WorkTreeApp::s_baselines; hlt die Terminattribute aller SchedObj eines
+        // Zeitpunkts spaltenweise in einem einzigen Blob statt in tausenden Einzelattributen.
+        TypeBaseline = WtStart + 100,
+        AttrBaselineData = WtStart + 101, // lob: SchedSnapshot::encode, siehe Baseline.h
+        AttrBaselineCount = WtStart + 102, // uint32: Anzahl erfasster SchedObj
+        AttrBaselineDate = WtStart + 103, // QDate: Data Date zum Zeitpunkt der Erfassung
     };
 
 	enum TypeDef_Root
@@ -359,6 +376,8 @@ namespace Wt
         static QString formatObjectId( const Udb::Obj&, bool useOid = false );
         static QString formatValue( Udb::Atom, const Udb::Obj&, bool useIcons = true );
         static QString formatLinkType( quint8 , bool codeOnly = false );
+        static QString formatLinkCode( const Udb::Obj& link ); // z.B. FS+3d, SS-2ed
+        static QString formatLag( qint32 lag, bool elapsed );
         static QString formatRasciRole( quint8 , bool codeOnly = false );
         static QString formatMsType( quint8 );
         static bool isRasciAssignable( quint32 type );
@@ -374,6 +393,7 @@ namespace Wt
         static bool canHaveText( quint32 type );
         static Udb::Obj getCalendars( Udb::Transaction* txn );
         static Udb::Obj getProject( Udb::Transaction* txn );
+        static Udb::Obj getBaselines( Udb::Transaction* txn );
         static Udb::Obj getRoot( Udb::Transaction * );
     };
 }
@@ -34,10 +34,47 @@
 #include "WorkTreeApp.h"
 #include "WtTypeDefs.h"
 #include "MainWindow.h"
+#include "BatchRunner.h"
+#include "StartupProfile.h"
+#include <stdio.h>
 using namespace Wt;
 
+static int runBatch(int argc, char *argv[])
+{
+	QApplication app( argc, argv, false ); // ohne GUI; es drfen keine Widgets erzeugt werden
+	app.setOrganizationName( WorkTreeApp::s_company );
+	app.setOrganizationDomain( WorkTreeApp::s_domain );
+	app.setApplicationName( WorkTreeApp::s_appName );
+#ifndef _DEBUG
+	try
+	{
+#endif
+		BatchRunner r;
+		return r.run( QCoreApplication::arguments() );
+#ifndef _DEBUG
+	}catch( Udb::DatabaseException& e )
+	{
+		fprintf( stderr, "%s\n", QString("Database Error: [%1] %2").arg( e.getCodeString() ).
+				 arg( e.getMsg() ).toLocal8Bit().constData() );
+	}catch( std::exception& e )
+	{
+		fprintf( stderr, "Generic Error: %s\n", e.what() );
+	}catch( ... )
+	{
+		fprintf( stderr, "Generic Error: unexpected internal exception\n" );
+	}
+	return BatchRunner::ErrInternal;
+#endif
+}
+
 int main(int argc, char *argv[])
 {
+	QStringList args;
+	for( int i = 0; i < argc; i++ )
+		args << QString::fromLocal8Bit( argv[i] );
+	if( BatchRunner::isBatch( args ) )
+		return runBatch( argc, argv );
+
     QtSingleApplication app( WorkTreeApp::s_appName, argc, argv);
 
     QIcon icon;
@@ -96,11 +133,10 @@ int main(int argc, char *argv[])
 		QStringList args = QCoreApplication::arguments();
 		for( int i = 1; i < args.size(); i++ ) // arg 0 enthlt Anwendungspfad
 		{
-			if( !args[ i ].startsWith( '-' ) )
-			{
+			if( args[ i ] == QLatin1String( "-profile-startup" ) )
+				StartupProfile::inst()->setPrint( true );
+			else if( !args[ i ].startsWith( '-' ) && path.isEmpty() )
 				path = args[ i ];
-				break;
-			}
 		}
 
 		if( path.isEmpty() )